@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import com.google.caliper.Param;
+import com.google.caliper.SimpleBenchmark;
+import java.util.Arrays;
+
+public class ArraysFillCopyBenchmark extends SimpleBenchmark {
+  @Param({"3", "8", "17", "64", "1000"}) int length;
+
+  private byte[] srcBytes;
+  private byte[] destBytes;
+  private int[] srcInts;
+  private int[] destInts;
+
+  @Override
+  protected void setUp() {
+    srcBytes = new byte[length];
+    destBytes = new byte[length];
+    srcInts = new int[length];
+    destInts = new int[length];
+    for (int i = 0; i < length; ++i) {
+      srcBytes[i] = (byte) i;
+      srcInts[i] = i;
+    }
+  }
+
+  public int timeArrayCopyByte(int reps) {
+    for (int i = 0; i < reps; ++i) {
+      System.arraycopy(srcBytes, 0, destBytes, 0, length);
+    }
+    return destBytes[length - 1];
+  }
+
+  public int timeArrayCopyInt(int reps) {
+    for (int i = 0; i < reps; ++i) {
+      System.arraycopy(srcInts, 0, destInts, 0, length);
+    }
+    return destInts[length - 1];
+  }
+
+  public int timeFillByte(int reps) {
+    for (int i = 0; i < reps; ++i) {
+      Arrays.fill(destBytes, (byte) i);
+    }
+    return destBytes[length - 1];
+  }
+
+  public int timeFillInt(int reps) {
+    for (int i = 0; i < reps; ++i) {
+      Arrays.fill(destInts, i);
+    }
+    return destInts[length - 1];
+  }
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import com.google.caliper.SimpleBenchmark;
+
+public class InterpreterCacheBenchmark extends SimpleBenchmark {
+  static class Base {
+    int intField = 1;
+    long longField = 2L;
+    byte byteField = 3;
+
+    int value() {
+      return intField;
+    }
+  }
+
+  static class Derived1 extends Base {
+    @Override
+    int value() {
+      return intField + 1;
+    }
+  }
+
+  static class Derived2 extends Base {
+    @Override
+    int value() {
+      return intField + 2;
+    }
+  }
+
+  static class Derived3 extends Base {
+    @Override
+    int value() {
+      return intField + 3;
+    }
+  }
+
+  private Base base;
+  private Base[] receivers;
+
+  @Override
+  protected void setUp() {
+    base = new Base();
+    receivers = new Base[] { new Base(), new Derived1(), new Derived2(), new Derived3() };
+  }
+
+  public long timeIGet(int reps) {
+    Base b = base;
+    long result = 0;
+    for (int i = 0; i < reps; ++i) {
+      result += b.intField;
+      result += b.byteField;
+      result += b.intField;
+      result += b.byteField;
+    }
+    return result;
+  }
+
+  public long timeIGetWide(int reps) {
+    Base b = base;
+    long result = 0;
+    for (int i = 0; i < reps; ++i) {
+      result += b.longField;
+      result += b.longField;
+      result += b.longField;
+      result += b.longField;
+    }
+    return result;
+  }
+
+  public int timeInvokeVirtualMonomorphic(int reps) {
+    Base b = base;
+    int result = 0;
+    for (int i = 0; i < reps; ++i) {
+      result += b.value();
+      result += b.value();
+      result += b.value();
+      result += b.value();
+    }
+    return result;
+  }
+
+  public int timeInvokeVirtualMegamorphic(int reps) {
+    Base[] r = receivers;
+    int result = 0;
+    for (int i = 0; i < reps; ++i) {
+      result += r[i & 3].value();
+      result += r[(i + 1) & 3].value();
+      result += r[(i + 2) & 3].value();
+      result += r[(i + 3) & 3].value();
+    }
+    return result;
+  }
+}
@@ -0,0 +1,81 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2016 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Compares JniTransitionsBenchmark results against a baseline.
+
+Both files are in the JSON format printed by the standalone mode of JniTransitionsBenchmark.
+Exits with status 1 if any benchmark is slower than the baseline by more than the threshold,
+so it can gate a runtime build. Use --update to replace the baseline with the results.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import shutil
+import sys
+
+
+def LoadResults(filename):
+  with open(filename) as f:
+    results = json.load(f)
+  return {(b['name'], b['threads']): b['ns_per_op'] for b in results['benchmarks']}
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__,
+                                   formatter_class=argparse.RawDescriptionHelpFormatter)
+  parser.add_argument('results', help='JSON results of the current build')
+  parser.add_argument('baseline', help='JSON results of the baseline build')
+  parser.add_argument('--threshold', type=float, default=10.0,
+                      help='allowed slowdown in percent (default: %(default)s)')
+  parser.add_argument('--update', action='store_true',
+                      help='overwrite the baseline with the results and exit')
+  args = parser.parse_args()
+
+  if args.update:
+    shutil.copyfile(args.results, args.baseline)
+    return 0
+
+  results = LoadResults(args.results)
+  baseline = LoadResults(args.baseline)
+  regressions = 0
+  print('%-36s %7s %12s %12s %8s' % ('benchmark', 'threads', 'baseline', 'current', 'delta'))
+  for key in sorted(results):
+    name, threads = key
+    current = results[key]
+    if key not in baseline:
+      print('%-36s %7d %12s %12.2f %8s' % (name, threads, '-', current, 'new'))
+      continue
+    base = baseline[key]
+    delta = (current - base) * 100.0 / base if base > 0 else 0.0
+    marker = ''
+    if delta > args.threshold:
+      marker = '  REGRESSION'
+      regressions += 1
+    print('%-36s %7d %12.2f %12.2f %+7.1f%%%s' % (name, threads, base, current, delta, marker))
+  for key in sorted(set(baseline) - set(results)):
+    print('%-36s %7d: missing from the results' % key)
+    regressions += 1
+
+  if regressions > 0:
+    print('%d benchmark(s) regressed by more than %.1f%%' % (regressions, args.threshold))
+    return 1
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
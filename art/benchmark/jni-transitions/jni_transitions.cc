@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jni.h"
+
+#include "base/logging.h"
+#include "base/macros.h"
+
+namespace art {
+
+namespace {
+
+// The benchmarks that measure a JNI function take the number of repetitions and call the function
+// in a native loop, so that the cost of the Java to native transition is not part of the result.
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_emptyStatic(JNIEnv*, jclass) {}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_emptyVirtual(JNIEnv*, jobject) {}
+
+static void FastEmptyStatic(JNIEnv*, jclass) {}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_registerFastNatives(
+    JNIEnv* env, jclass klass) {
+  // A '!' prefix in the signature registers the method as a fast JNI method.
+  static const JNINativeMethod kFastNatives[] = {
+    { "fastEmptyStatic", "!()V", reinterpret_cast<void*>(FastEmptyStatic) },
+  };
+  CHECK_EQ(env->RegisterNatives(klass, kFastNatives, arraysize(kFastNatives)), JNI_OK);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_callVoidMethod(
+    JNIEnv* env, jclass, jint reps, jobject obj) {
+  jclass klass = env->GetObjectClass(obj);
+  jmethodID mid = env->GetMethodID(klass, "javaEmptyVirtual", "()V");
+  CHECK(mid != nullptr);
+  for (jint i = 0; i < reps; ++i) {
+    env->CallVoidMethod(obj, mid);
+  }
+  env->DeleteLocalRef(klass);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_callStaticIntMethod(
+    JNIEnv* env, jclass klass, jint reps) {
+  jmethodID mid = env->GetStaticMethodID(klass, "javaStaticInt", "(I)I");
+  CHECK(mid != nullptr);
+  jint sum = 0;
+  for (jint i = 0; i < reps; ++i) {
+    sum += env->CallStaticIntMethod(klass, mid, i);
+  }
+  CHECK_GE(sum, 0);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_callNonvirtualVoidMethodA(
+    JNIEnv* env, jclass, jint reps, jobject obj) {
+  jclass klass = env->GetObjectClass(obj);
+  jmethodID mid = env->GetMethodID(klass, "javaEmptyVirtual", "()V");
+  CHECK(mid != nullptr);
+  for (jint i = 0; i < reps; ++i) {
+    env->CallNonvirtualVoidMethodA(obj, klass, mid, nullptr);
+  }
+  env->DeleteLocalRef(klass);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_getSetIntField(
+    JNIEnv* env, jclass, jint reps, jobject obj) {
+  jclass klass = env->GetObjectClass(obj);
+  jfieldID fid = env->GetFieldID(klass, "intField", "I");
+  CHECK(fid != nullptr);
+  for (jint i = 0; i < reps; ++i) {
+    env->SetIntField(obj, fid, env->GetIntField(obj, fid) + 1);
+  }
+  env->DeleteLocalRef(klass);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_getObjectField(
+    JNIEnv* env, jclass, jint reps, jobject obj) {
+  jclass klass = env->GetObjectClass(obj);
+  jfieldID fid = env->GetFieldID(klass, "objectField", "Ljava/lang/Object;");
+  CHECK(fid != nullptr);
+  for (jint i = 0; i < reps; ++i) {
+    env->DeleteLocalRef(env->GetObjectField(obj, fid));
+  }
+  env->DeleteLocalRef(klass);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_getStaticIntField(
+    JNIEnv* env, jclass klass, jint reps) {
+  jfieldID fid = env->GetStaticFieldID(klass, "staticIntField", "I");
+  CHECK(fid != nullptr);
+  jint sum = 0;
+  for (jint i = 0; i < reps; ++i) {
+    sum += env->GetStaticIntField(klass, fid);
+  }
+  CHECK_GE(sum, 0);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_newDeleteLocalRef(
+    JNIEnv* env, jclass, jint reps, jobject obj) {
+  for (jint i = 0; i < reps; ++i) {
+    env->DeleteLocalRef(env->NewLocalRef(obj));
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_pushPopLocalFrame(
+    JNIEnv* env, jclass, jint reps, jobject obj) {
+  for (jint i = 0; i < reps; ++i) {
+    CHECK_EQ(env->PushLocalFrame(4), JNI_OK);
+    env->NewLocalRef(obj);
+    env->NewLocalRef(obj);
+    env->PopLocalFrame(nullptr);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_newDeleteGlobalRef(
+    JNIEnv* env, jclass, jint reps, jobject obj) {
+  for (jint i = 0; i < reps; ++i) {
+    env->DeleteGlobalRef(env->NewGlobalRef(obj));
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_newDeleteWeakGlobalRef(
+    JNIEnv* env, jclass, jint reps, jobject obj) {
+  for (jint i = 0; i < reps; ++i) {
+    env->DeleteWeakGlobalRef(env->NewWeakGlobalRef(obj));
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_getObjectClass(
+    JNIEnv* env, jclass, jint reps, jobject obj) {
+  for (jint i = 0; i < reps; ++i) {
+    env->DeleteLocalRef(env->GetObjectClass(obj));
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_isInstanceOf(
+    JNIEnv* env, jclass klass, jint reps, jobject obj) {
+  for (jint i = 0; i < reps; ++i) {
+    CHECK(env->IsInstanceOf(obj, klass));
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_findClass(
+    JNIEnv* env, jclass, jint reps) {
+  for (jint i = 0; i < reps; ++i) {
+    env->DeleteLocalRef(env->FindClass("java/lang/String"));
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_getMethodID(
+    JNIEnv* env, jclass klass, jint reps) {
+  for (jint i = 0; i < reps; ++i) {
+    CHECK(env->GetMethodID(klass, "javaEmptyVirtual", "()V") != nullptr);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_getReleaseIntArrayElements(
+    JNIEnv* env, jclass, jint reps, jintArray array) {
+  for (jint i = 0; i < reps; ++i) {
+    jint* elements = env->GetIntArrayElements(array, nullptr);
+    env->ReleaseIntArrayElements(array, elements, JNI_ABORT);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_getReleasePrimitiveArrayCritical(
+    JNIEnv* env, jclass, jint reps, jintArray array) {
+  for (jint i = 0; i < reps; ++i) {
+    void* elements = env->GetPrimitiveArrayCritical(array, nullptr);
+    env->ReleasePrimitiveArrayCritical(array, elements, JNI_ABORT);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_getIntArrayRegion(
+    JNIEnv* env, jclass, jint reps, jintArray array) {
+  jint buffer[16];
+  for (jint i = 0; i < reps; ++i) {
+    env->GetIntArrayRegion(array, 0, arraysize(buffer), buffer);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_getArrayLength(
+    JNIEnv* env, jclass, jint reps, jintArray array) {
+  jsize sum = 0;
+  for (jint i = 0; i < reps; ++i) {
+    sum += env->GetArrayLength(array);
+  }
+  CHECK_GE(sum, 0);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_getReleaseStringUTFChars(
+    JNIEnv* env, jclass, jint reps, jstring str) {
+  for (jint i = 0; i < reps; ++i) {
+    const char* chars = env->GetStringUTFChars(str, nullptr);
+    env->ReleaseStringUTFChars(str, chars);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_getReleaseStringCritical(
+    JNIEnv* env, jclass, jint reps, jstring str) {
+  for (jint i = 0; i < reps; ++i) {
+    const jchar* chars = env->GetStringCritical(str, nullptr);
+    env->ReleaseStringCritical(str, chars);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_newStringUTF(
+    JNIEnv* env, jclass, jint reps) {
+  for (jint i = 0; i < reps; ++i) {
+    env->DeleteLocalRef(env->NewStringUTF("ABCDEFGHIJKLMNOP"));
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_monitorEnterExit(
+    JNIEnv* env, jclass, jint reps, jobject obj) {
+  for (jint i = 0; i < reps; ++i) {
+    env->MonitorEnter(obj);
+    env->MonitorExit(obj);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_JniTransitionsBenchmark_exceptionCheck(
+    JNIEnv* env, jclass, jint reps) {
+  for (jint i = 0; i < reps; ++i) {
+    CHECK(!env->ExceptionCheck());
+  }
+}
+
+}  // namespace
+
+}  // namespace art
@@ -0,0 +1,316 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import com.google.caliper.Param;
+import com.google.caliper.SimpleBenchmark;
+
+import java.util.Arrays;
+import java.util.concurrent.CyclicBarrier;
+
+/**
+ * Measures the JNI entrypoint families of the runtime, each run concurrently by 1 to N threads.
+ *
+ * Runs either as a caliper benchmark, or standalone with
+ *   dalvikvm -cp <jar> JniTransitionsBenchmark [max threads] > results.json
+ * which prints the median nanoseconds per operation of every benchmark and thread count as JSON,
+ * for use with compare_baseline.py.
+ */
+public class JniTransitionsBenchmark extends SimpleBenchmark {
+  @Param({"1", "2", "4"}) int threads;
+
+  // Java to native transitions.
+  static native void emptyStatic();
+  native void emptyVirtual();
+  static native void fastEmptyStatic();
+  static native void registerFastNatives();
+
+  // JNI functions, each called reps times from a native loop.
+  static native void callVoidMethod(int reps, Object obj);
+  static native void callStaticIntMethod(int reps);
+  static native void callNonvirtualVoidMethodA(int reps, Object obj);
+  static native void getSetIntField(int reps, Object obj);
+  static native void getObjectField(int reps, Object obj);
+  static native void getStaticIntField(int reps);
+  static native void newDeleteLocalRef(int reps, Object obj);
+  static native void pushPopLocalFrame(int reps, Object obj);
+  static native void newDeleteGlobalRef(int reps, Object obj);
+  static native void newDeleteWeakGlobalRef(int reps, Object obj);
+  static native void getObjectClass(int reps, Object obj);
+  static native void isInstanceOf(int reps, Object obj);
+  static native void findClass(int reps);
+  static native void getMethodID(int reps);
+  static native void getReleaseIntArrayElements(int reps, int[] array);
+  static native void getReleasePrimitiveArrayCritical(int reps, int[] array);
+  static native void getIntArrayRegion(int reps, int[] array);
+  static native void getArrayLength(int reps, int[] array);
+  static native void getReleaseStringUTFChars(int reps, String str);
+  static native void getReleaseStringCritical(int reps, String str);
+  static native void newStringUTF(int reps);
+  static native void monitorEnterExit(int reps, Object obj);
+  static native void exceptionCheck(int reps);
+
+  static int staticIntField = 1;
+  int intField;
+  Object objectField = new Object();
+
+  void javaEmptyVirtual() {}
+
+  static int javaStaticInt(int i) {
+    return i & 1;
+  }
+
+  static {
+    System.loadLibrary("artbenchmark");
+    registerFastNatives();
+  }
+
+  /** A benchmark body, run by every thread with its own receiver and arguments. */
+  abstract static class Body {
+    final String name;
+
+    Body(String name) {
+      this.name = name;
+    }
+
+    abstract void run(JniTransitionsBenchmark self, int reps);
+  }
+
+  // Per thread arguments, so that threads only contend inside the runtime.
+  final int[] intArray = new int[256];
+  final String string = "ABCDEFGHIJKLMNOP";
+  final Object lock = new Object();
+
+  static final Body[] BODIES = {
+    new Body("EmptyStatic") {
+      void run(JniTransitionsBenchmark self, int reps) {
+        for (int i = 0; i < reps; ++i) {
+          emptyStatic();
+        }
+      }
+    },
+    new Body("EmptyVirtual") {
+      void run(JniTransitionsBenchmark self, int reps) {
+        for (int i = 0; i < reps; ++i) {
+          self.emptyVirtual();
+        }
+      }
+    },
+    new Body("FastEmptyStatic") {
+      void run(JniTransitionsBenchmark self, int reps) {
+        for (int i = 0; i < reps; ++i) {
+          fastEmptyStatic();
+        }
+      }
+    },
+    new Body("CallVoidMethod") {
+      void run(JniTransitionsBenchmark self, int reps) { callVoidMethod(reps, self); }
+    },
+    new Body("CallStaticIntMethod") {
+      void run(JniTransitionsBenchmark self, int reps) { callStaticIntMethod(reps); }
+    },
+    new Body("CallNonvirtualVoidMethodA") {
+      void run(JniTransitionsBenchmark self, int reps) { callNonvirtualVoidMethodA(reps, self); }
+    },
+    new Body("GetSetIntField") {
+      void run(JniTransitionsBenchmark self, int reps) { getSetIntField(reps, self); }
+    },
+    new Body("GetObjectField") {
+      void run(JniTransitionsBenchmark self, int reps) { getObjectField(reps, self); }
+    },
+    new Body("GetStaticIntField") {
+      void run(JniTransitionsBenchmark self, int reps) { getStaticIntField(reps); }
+    },
+    new Body("NewDeleteLocalRef") {
+      void run(JniTransitionsBenchmark self, int reps) { newDeleteLocalRef(reps, self); }
+    },
+    new Body("PushPopLocalFrame") {
+      void run(JniTransitionsBenchmark self, int reps) { pushPopLocalFrame(reps, self); }
+    },
+    new Body("NewDeleteGlobalRef") {
+      void run(JniTransitionsBenchmark self, int reps) { newDeleteGlobalRef(reps, self); }
+    },
+    new Body("NewDeleteWeakGlobalRef") {
+      void run(JniTransitionsBenchmark self, int reps) { newDeleteWeakGlobalRef(reps, self); }
+    },
+    new Body("GetObjectClass") {
+      void run(JniTransitionsBenchmark self, int reps) { getObjectClass(reps, self); }
+    },
+    new Body("IsInstanceOf") {
+      void run(JniTransitionsBenchmark self, int reps) { isInstanceOf(reps, self); }
+    },
+    new Body("FindClass") {
+      void run(JniTransitionsBenchmark self, int reps) { findClass(reps); }
+    },
+    new Body("GetMethodID") {
+      void run(JniTransitionsBenchmark self, int reps) { getMethodID(reps); }
+    },
+    new Body("GetReleaseIntArrayElements") {
+      void run(JniTransitionsBenchmark self, int reps) {
+        getReleaseIntArrayElements(reps, self.intArray);
+      }
+    },
+    new Body("GetReleasePrimitiveArrayCritical") {
+      void run(JniTransitionsBenchmark self, int reps) {
+        getReleasePrimitiveArrayCritical(reps, self.intArray);
+      }
+    },
+    new Body("GetIntArrayRegion") {
+      void run(JniTransitionsBenchmark self, int reps) { getIntArrayRegion(reps, self.intArray); }
+    },
+    new Body("GetArrayLength") {
+      void run(JniTransitionsBenchmark self, int reps) { getArrayLength(reps, self.intArray); }
+    },
+    new Body("GetReleaseStringUTFChars") {
+      void run(JniTransitionsBenchmark self, int reps) {
+        getReleaseStringUTFChars(reps, self.string);
+      }
+    },
+    new Body("GetReleaseStringCritical") {
+      void run(JniTransitionsBenchmark self, int reps) {
+        getReleaseStringCritical(reps, self.string);
+      }
+    },
+    new Body("NewStringUTF") {
+      void run(JniTransitionsBenchmark self, int reps) { newStringUTF(reps); }
+    },
+    new Body("MonitorEnterExit") {
+      void run(JniTransitionsBenchmark self, int reps) { monitorEnterExit(reps, self.lock); }
+    },
+    new Body("ExceptionCheck") {
+      void run(JniTransitionsBenchmark self, int reps) { exceptionCheck(reps); }
+    },
+  };
+
+  /**
+   * Run body reps times on each of numThreads threads, which start together. Returns the wall
+   * time in nanoseconds, so the result is the time per operation for each thread.
+   */
+  static long runThreaded(final Body body, final int reps, int numThreads) throws Exception {
+    if (numThreads == 1) {
+      JniTransitionsBenchmark self = new JniTransitionsBenchmark();
+      long start = System.nanoTime();
+      body.run(self, reps);
+      return System.nanoTime() - start;
+    }
+    final CyclicBarrier barrier = new CyclicBarrier(numThreads + 1);
+    Thread[] workers = new Thread[numThreads];
+    for (int t = 0; t < numThreads; ++t) {
+      workers[t] = new Thread() {
+        public void run() {
+          JniTransitionsBenchmark self = new JniTransitionsBenchmark();
+          try {
+            barrier.await();
+            body.run(self, reps);
+            barrier.await();
+          } catch (Exception e) {
+            throw new RuntimeException(e);
+          }
+        }
+      };
+      workers[t].start();
+    }
+    barrier.await();
+    long start = System.nanoTime();
+    barrier.await();
+    long elapsed = System.nanoTime() - start;
+    for (Thread worker : workers) {
+      worker.join();
+    }
+    return elapsed;
+  }
+
+  private void time(String name, int reps) throws Exception {
+    for (Body body : BODIES) {
+      if (body.name.equals(name)) {
+        runThreaded(body, reps, threads);
+        return;
+      }
+    }
+    throw new AssertionError(name);
+  }
+
+  public void timeEmptyStatic(int reps) throws Exception { time("EmptyStatic", reps); }
+  public void timeEmptyVirtual(int reps) throws Exception { time("EmptyVirtual", reps); }
+  public void timeFastEmptyStatic(int reps) throws Exception { time("FastEmptyStatic", reps); }
+  public void timeCallVoidMethod(int reps) throws Exception { time("CallVoidMethod", reps); }
+  public void timeCallStaticIntMethod(int reps) throws Exception {
+    time("CallStaticIntMethod", reps);
+  }
+  public void timeCallNonvirtualVoidMethodA(int reps) throws Exception {
+    time("CallNonvirtualVoidMethodA", reps);
+  }
+  public void timeGetSetIntField(int reps) throws Exception { time("GetSetIntField", reps); }
+  public void timeGetObjectField(int reps) throws Exception { time("GetObjectField", reps); }
+  public void timeGetStaticIntField(int reps) throws Exception { time("GetStaticIntField", reps); }
+  public void timeNewDeleteLocalRef(int reps) throws Exception { time("NewDeleteLocalRef", reps); }
+  public void timePushPopLocalFrame(int reps) throws Exception { time("PushPopLocalFrame", reps); }
+  public void timeNewDeleteGlobalRef(int reps) throws Exception {
+    time("NewDeleteGlobalRef", reps);
+  }
+  public void timeNewDeleteWeakGlobalRef(int reps) throws Exception {
+    time("NewDeleteWeakGlobalRef", reps);
+  }
+  public void timeGetObjectClass(int reps) throws Exception { time("GetObjectClass", reps); }
+  public void timeIsInstanceOf(int reps) throws Exception { time("IsInstanceOf", reps); }
+  public void timeFindClass(int reps) throws Exception { time("FindClass", reps); }
+  public void timeGetMethodID(int reps) throws Exception { time("GetMethodID", reps); }
+  public void timeGetReleaseIntArrayElements(int reps) throws Exception {
+    time("GetReleaseIntArrayElements", reps);
+  }
+  public void timeGetReleasePrimitiveArrayCritical(int reps) throws Exception {
+    time("GetReleasePrimitiveArrayCritical", reps);
+  }
+  public void timeGetIntArrayRegion(int reps) throws Exception { time("GetIntArrayRegion", reps); }
+  public void timeGetArrayLength(int reps) throws Exception { time("GetArrayLength", reps); }
+  public void timeGetReleaseStringUTFChars(int reps) throws Exception {
+    time("GetReleaseStringUTFChars", reps);
+  }
+  public void timeGetReleaseStringCritical(int reps) throws Exception {
+    time("GetReleaseStringCritical", reps);
+  }
+  public void timeNewStringUTF(int reps) throws Exception { time("NewStringUTF", reps); }
+  public void timeMonitorEnterExit(int reps) throws Exception { time("MonitorEnterExit", reps); }
+  public void timeExceptionCheck(int reps) throws Exception { time("ExceptionCheck", reps); }
+
+  // Standalone mode parameters. Every result is the median of kRuns runs of kReps repetitions,
+  // after a warm up run that lets the JIT compile the Java side.
+  private static final int kReps = 100000;
+  private static final int kRuns = 9;
+
+  public static void main(String[] args) throws Exception {
+    int maxThreads = (args.length > 0) ? Integer.parseInt(args[0]) : 4;
+    StringBuilder json = new StringBuilder();
+    json.append("{\n  \"benchmarks\": [");
+    String separator = "\n";
+    for (Body body : BODIES) {
+      for (int numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+        runThreaded(body, kReps, numThreads);
+        long[] times = new long[kRuns];
+        for (int run = 0; run < kRuns; ++run) {
+          times[run] = runThreaded(body, kReps, numThreads);
+        }
+        Arrays.sort(times);
+        double nsPerOp = (double) times[kRuns / 2] / kReps;
+        json.append(separator);
+        json.append(String.format("    {\"name\": \"%s\", \"threads\": %d, \"ns_per_op\": %.2f}",
+                                  body.name, numThreads, nsPerOp));
+        separator = ",\n";
+      }
+    }
+    json.append("\n  ]\n}");
+    System.out.println(json);
+  }
+}
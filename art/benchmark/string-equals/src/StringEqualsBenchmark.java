@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import com.google.caliper.Param;
+import com.google.caliper.SimpleBenchmark;
+
+public class StringEqualsBenchmark extends SimpleBenchmark {
+  @Param({"3", "8", "17", "64", "1000"}) int length;
+
+  private String string;
+  private String sameString;
+  private String lastCharDiffers;
+
+  @Override
+  protected void setUp() {
+    char[] chars = new char[length];
+    for (int i = 0; i < length; ++i) {
+      chars[i] = (char) ('a' + i % 26);
+    }
+    string = new String(chars);
+    sameString = new String(chars);
+    chars[length - 1] = '!';
+    lastCharDiffers = new String(chars);
+  }
+
+  public boolean timeEquals(int reps) {
+    boolean result = false;
+    for (int i = 0; i < reps; ++i) {
+      result ^= string.equals(sameString);
+    }
+    return result;
+  }
+
+  public boolean timeEqualsLastCharDiffers(int reps) {
+    boolean result = false;
+    for (int i = 0; i < reps; ++i) {
+      result ^= string.equals(lastCharDiffers);
+    }
+    return result;
+  }
+}
@@ -107,7 +107,11 @@ static constexpr bool kIntrinsicIsStatic[] = {
     false,  // kIntrinsicUnsafeStoreFence,
     false,  // kIntrinsicUnsafeFullFence,
     true,   // kIntrinsicSystemArrayCopyCharArray
+    true,   // kIntrinsicSystemArrayCopyByteArray
+    true,   // kIntrinsicSystemArrayCopyIntArray
     true,   // kIntrinsicSystemArrayCopy
+    true,   // kIntrinsicArraysFillByteArray
+    true,   // kIntrinsicArraysFillIntArray
 };
 static_assert(arraysize(kIntrinsicIsStatic) == kInlineOpNop,
               "arraysize of kIntrinsicIsStatic unexpected");
@@ -192,8 +196,16 @@ static_assert(!kIntrinsicIsStatic[kIntrinsicUnsafeStoreFence], "UnsafeStoreFence
 static_assert(!kIntrinsicIsStatic[kIntrinsicUnsafeFullFence], "UnsafeFullFence must not be static");
 static_assert(kIntrinsicIsStatic[kIntrinsicSystemArrayCopyCharArray],
               "SystemArrayCopyCharArray must be static");
+static_assert(kIntrinsicIsStatic[kIntrinsicSystemArrayCopyByteArray],
+              "SystemArrayCopyByteArray must be static");
+static_assert(kIntrinsicIsStatic[kIntrinsicSystemArrayCopyIntArray],
+              "SystemArrayCopyIntArray must be static");
 static_assert(kIntrinsicIsStatic[kIntrinsicSystemArrayCopy],
               "SystemArrayCopy must be static");
+static_assert(kIntrinsicIsStatic[kIntrinsicArraysFillByteArray],
+              "ArraysFillByteArray must be static");
+static_assert(kIntrinsicIsStatic[kIntrinsicArraysFillIntArray],
+              "ArraysFillIntArray must be static");
 
 }  // anonymous namespace
 
@@ -229,6 +241,7 @@ const char* const DexFileMethodInliner::kClassCacheNames[] = {
     "Llibcore/io/Memory;",     // kClassCacheLibcoreIoMemory
     "Lsun/misc/Unsafe;",       // kClassCacheSunMiscUnsafe
     "Ljava/lang/System;",      // kClassCacheJavaLangSystem
+    "Ljava/util/Arrays;",      // kClassCacheJavaUtilArrays
 };
 
 const char* const DexFileMethodInliner::kNameCacheNames[] = {
@@ -324,6 +337,7 @@ const char* const DexFileMethodInliner::kNameCacheNames[] = {
     "rotateRight",           // kNameCacheRotateRight
     "rotateLeft",            // kNameCacheRotateLeft
     "signum",                // kNameCacheSignum
+    "fill",                  // kNameCacheFill
 };
 
 const DexFileMethodInliner::ProtoDef DexFileMethodInliner::kProtoCacheDefs[] = {
@@ -421,9 +435,19 @@ const DexFileMethodInliner::ProtoDef DexFileMethodInliner::kProtoCacheDefs[] = {
     // kProtoCacheCharArrayICharArrayII_V
     { kClassCacheVoid, 5, {kClassCacheJavaLangCharArray, kClassCacheInt,
         kClassCacheJavaLangCharArray, kClassCacheInt, kClassCacheInt} },
+    // kProtoCacheByteArrayIByteArrayII_V
+    { kClassCacheVoid, 5, {kClassCacheJavaLangByteArray, kClassCacheInt,
+        kClassCacheJavaLangByteArray, kClassCacheInt, kClassCacheInt} },
+    // kProtoCacheIntArrayIIntArrayII_V
+    { kClassCacheVoid, 5, {kClassCacheJavaLangIntArray, kClassCacheInt,
+        kClassCacheJavaLangIntArray, kClassCacheInt, kClassCacheInt} },
     // kProtoCacheObjectIObjectII_V
     { kClassCacheVoid, 5, {kClassCacheJavaLangObject, kClassCacheInt,
         kClassCacheJavaLangObject, kClassCacheInt, kClassCacheInt} },
+    // kProtoCacheByteArrayB_V
+    { kClassCacheVoid, 2, { kClassCacheJavaLangByteArray, kClassCacheByte } },
+    // kProtoCacheIntArrayI_V
+    { kClassCacheVoid, 2, { kClassCacheJavaLangIntArray, kClassCacheInt } },
     // kProtoCacheIICharArrayI_V
     { kClassCacheVoid, 4, { kClassCacheInt, kClassCacheInt, kClassCacheJavaLangCharArray,
         kClassCacheInt } },
@@ -631,9 +655,16 @@ const DexFileMethodInliner::IntrinsicDef DexFileMethodInliner::kIntrinsicMethods
 
     INTRINSIC(JavaLangSystem, ArrayCopy, CharArrayICharArrayII_V , kIntrinsicSystemArrayCopyCharArray,
               0),
+    INTRINSIC(JavaLangSystem, ArrayCopy, ByteArrayIByteArrayII_V,
+              kIntrinsicSystemArrayCopyByteArray, 0),
+    INTRINSIC(JavaLangSystem, ArrayCopy, IntArrayIIntArrayII_V,
+              kIntrinsicSystemArrayCopyIntArray, 0),
     INTRINSIC(JavaLangSystem, ArrayCopy, ObjectIObjectII_V , kIntrinsicSystemArrayCopy,
               0),
 
+    INTRINSIC(JavaUtilArrays, Fill, ByteArrayB_V, kIntrinsicArraysFillByteArray, 0),
+    INTRINSIC(JavaUtilArrays, Fill, IntArrayI_V, kIntrinsicArraysFillIntArray, 0),
+
     INTRINSIC(JavaLangInteger, RotateRight, II_I, kIntrinsicRotateRight, k32),
     INTRINSIC(JavaLangLong, RotateRight, JI_J, kIntrinsicRotateRight, k64),
     INTRINSIC(JavaLangInteger, RotateLeft, II_I, kIntrinsicRotateLeft, k32),
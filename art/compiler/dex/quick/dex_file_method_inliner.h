@@ -121,6 +121,7 @@ class DexFileMethodInliner {
       kClassCacheLibcoreIoMemory,
       kClassCacheSunMiscUnsafe,
       kClassCacheJavaLangSystem,
+      kClassCacheJavaUtilArrays,
       kClassCacheLast
     };
 
@@ -223,6 +224,7 @@ class DexFileMethodInliner {
       kNameCacheRotateRight,
       kNameCacheRotateLeft,
       kNameCacheSignum,
+      kNameCacheFill,
       kNameCacheLast
     };
 
@@ -277,7 +279,11 @@ class DexFileMethodInliner {
       kProtoCacheObjectJObject_V,
       kProtoCacheObjectJObject_Object,
       kProtoCacheCharArrayICharArrayII_V,
+      kProtoCacheByteArrayIByteArrayII_V,
+      kProtoCacheIntArrayIIntArrayII_V,
       kProtoCacheObjectIObjectII_V,
+      kProtoCacheByteArrayB_V,
+      kProtoCacheIntArrayI_V,
       kProtoCacheIICharArrayI_V,
       kProtoCacheByteArrayIII_String,
       kProtoCacheIICharArray_String,
@@ -75,6 +75,59 @@ template <typename ContentType>
 class CompiledMethodStorage::DedupeHashFunc {
  private:
   static constexpr bool kUseMurmur3Hash = true;
+  // On 64-bit hosts, hash 8 bytes per iteration instead of 4.
+  static constexpr bool kUseMurmur64Hash = sizeof(size_t) == sizeof(uint64_t);
+
+  // MurmurHash64A.
+  static uint64_t Murmur64Hash(const uint8_t* data, size_t len) {
+    static constexpr uint64_t m = UINT64_C(0xc6a4a7935bd1e995);
+    static constexpr uint32_t r = 47;
+
+    uint64_t hash = UINT64_C(0x8445d61a4e774912) ^ (len * m);
+
+    const size_t nblocks = len / 8;
+    typedef __attribute__((__aligned__(1))) uint64_t unaligned_uint64_t;
+    const unaligned_uint64_t *blocks = reinterpret_cast<const uint64_t*>(data);
+    for (size_t i = 0; i != nblocks; ++i) {
+      uint64_t k = blocks[i];
+      k *= m;
+      k ^= k >> r;
+      k *= m;
+
+      hash ^= k;
+      hash *= m;
+    }
+
+    const uint8_t *tail = data + nblocks * 8;
+    switch (len & 7) {
+      case 7:
+        hash ^= static_cast<uint64_t>(tail[6]) << 48;
+        FALLTHROUGH_INTENDED;
+      case 6:
+        hash ^= static_cast<uint64_t>(tail[5]) << 40;
+        FALLTHROUGH_INTENDED;
+      case 5:
+        hash ^= static_cast<uint64_t>(tail[4]) << 32;
+        FALLTHROUGH_INTENDED;
+      case 4:
+        hash ^= static_cast<uint64_t>(tail[3]) << 24;
+        FALLTHROUGH_INTENDED;
+      case 3:
+        hash ^= static_cast<uint64_t>(tail[2]) << 16;
+        FALLTHROUGH_INTENDED;
+      case 2:
+        hash ^= static_cast<uint64_t>(tail[1]) << 8;
+        FALLTHROUGH_INTENDED;
+      case 1:
+        hash ^= static_cast<uint64_t>(tail[0]);
+        hash *= m;
+    }
+
+    hash ^= hash >> r;
+    hash *= m;
+    hash ^= hash >> r;
+    return hash;
+  }
 
  public:
   size_t operator()(const ArrayRef<ContentType>& array) const {
@@ -83,7 +136,9 @@ class CompiledMethodStorage::DedupeHashFunc {
     // static_assert(IsPowerOfTwo(sizeof(ContentType)),
     //    "ContentType is not power of two, don't know whether array layout is as assumed");
     uint32_t len = sizeof(ContentType) * array.size();
-    if (kUseMurmur3Hash) {
+    if (kUseMurmur64Hash) {
+      return static_cast<size_t>(Murmur64Hash(data, len));
+    } else if (kUseMurmur3Hash) {
       static constexpr uint32_t c1 = 0xcc9e2d51;
       static constexpr uint32_t c2 = 0x1b873593;
       static constexpr uint32_t r1 = 15;
@@ -177,7 +232,7 @@ CompiledMethodStorage::CompiledMethodStorage(int swap_fd)
       dedupe_vmap_table_("dedupe vmap table",
                          LengthPrefixedArrayAlloc<uint8_t>(swap_space_.get())),
       dedupe_cfi_info_("dedupe cfi info", LengthPrefixedArrayAlloc<uint8_t>(swap_space_.get())),
-      dedupe_linker_patches_("dedupe cfi info",
+      dedupe_linker_patches_("dedupe linker patches",
                              LengthPrefixedArrayAlloc<LinkerPatch>(swap_space_.get())) {
 }
 
@@ -193,8 +248,10 @@ void CompiledMethodStorage::DumpMemoryUsage(std::ostream& os, bool extended) con
   if (extended) {
     Thread* self = Thread::Current();
     os << "\nCode dedupe: " << dedupe_code_.DumpStats(self);
+    os << "\nSource mapping table dedupe: " << dedupe_src_mapping_table_.DumpStats(self);
     os << "\nVmap table dedupe: " << dedupe_vmap_table_.DumpStats(self);
     os << "\nCFI info dedupe: " << dedupe_cfi_info_.DumpStats(self);
+    os << "\nLinker patches dedupe: " << dedupe_linker_patches_.DumpStats(self);
   }
 }
 
@@ -49,6 +49,13 @@ class CompiledMethodStorage {
     return SwapAllocator<void>(swap_space_.get());
   }
 
+  // Hint that the code will be read soon. Only has an effect when the code is in the swap space.
+  void PrefetchCode(const ArrayRef<const uint8_t>& code) const {
+    if (swap_space_ != nullptr) {
+      SwapSpace::Prefetch(code.data(), code.size());
+    }
+  }
+
   const LengthPrefixedArray<uint8_t>* DeduplicateCode(const ArrayRef<const uint8_t>& code);
   void ReleaseCode(const LengthPrefixedArray<uint8_t>* code);
 
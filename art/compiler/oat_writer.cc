@@ -32,6 +32,7 @@
 #include "debug/method_debug_info.h"
 #include "dex/verification_results.h"
 #include "dex_file-inl.h"
+#include "driver/compiled_method_storage.h"
 #include "driver/compiler_driver.h"
 #include "driver/compiler_options.h"
 #include "gc/space/image_space.h"
@@ -972,6 +973,17 @@ class OatWriter::WriteCodeMethodVisitor : public OatDexMethodVisitor {
       dex_cache_ = class_linker_->FindDexCache(Thread::Current(), *dex_file);
       DCHECK(dex_cache_ != nullptr);
     }
+    // Compiled code may have been written out to the swap file. Ask for the code of the next
+    // class now so that it is read back while we are writing this one.
+    if (oat_class_index_ + 1u < writer_->oat_classes_.size()) {
+      CompiledMethodStorage* storage = writer_->compiler_driver_->GetCompiledMethodStorage();
+      for (const CompiledMethod* compiled_method :
+           writer_->oat_classes_[oat_class_index_ + 1u].compiled_methods_) {
+        if (compiled_method != nullptr) {
+          storage->PrefetchCode(compiled_method->GetQuickCode());
+        }
+      }
+    }
     return true;
   }
 
@@ -19,6 +19,7 @@
 #include "base/arena_bit_vector.h"
 #include "base/arena_containers.h"
 #include "base/bit_vector-inl.h"
+#include "load_store_analysis.h"
 #include "side_effects_analysis.h"
 #include "utils.h"
 
@@ -131,6 +132,14 @@ class ValueSet : public ArenaObject<kArenaAllocGvn> {
     });
   }
 
+  // Removes all instructions in the set for which `is_killed` returns true.
+  template<typename Functor>
+  void KillWhich(Functor is_killed) {
+    DeleteAllImpureWhich([is_killed](Node* node) {
+      return is_killed(node->GetInstruction());
+    });
+  }
+
   void Clear() {
     num_entries_ = 0;
     for (size_t i = 0; i < num_buckets_; ++i) {
@@ -358,15 +367,45 @@ class GlobalValueNumberer : public ValueObject {
         side_effects_(side_effects),
         sets_(graph->GetBlocks().size(), nullptr, allocator->Adapter(kArenaAllocGvn)),
         visited_blocks_(
-            allocator, graph->GetBlocks().size(), /* expandable */ false, kArenaAllocGvn) {}
+            allocator, graph->GetBlocks().size(), /* expandable */ false, kArenaAllocGvn),
+        heap_location_collector_(nullptr),
+        heap_locations_(allocator->Adapter(kArenaAllocGvn)),
+        number_of_removed_instructions_(0u) {}
 
   void Run();
 
+  size_t GetNumberOfRemovedInstructions() const { return number_of_removed_instructions_; }
+
  private:
   // Per-block GVN. Will also update the ValueSet of the dominated and
   // successor blocks.
   void VisitBasicBlock(HBasicBlock* block);
 
+  // Collects the heap locations accessed by the graph so that a store only kills the
+  // loads which may alias with it, instead of all loads of the same type. Leaves
+  // `heap_location_collector_` null if the method is not suitable for the analysis.
+  void CollectHeapLocations(HeapLocationCollector* collector);
+
+  // Returns the heap location accessed by `instruction` before GVN started, or
+  // kHeapLocationNotFound if it is not a field or array access.
+  size_t GetHeapLocationOf(HInstruction* instruction) const {
+    if (heap_location_collector_ == nullptr) {
+      return HeapLocationCollector::kHeapLocationNotFound;
+    }
+    DCHECK_LT(static_cast<size_t>(instruction->GetId()), heap_locations_.size());
+    return heap_locations_[instruction->GetId()];
+  }
+
+  bool MayAlias(size_t location1, size_t location2) const {
+    return location1 == location2 || heap_location_collector_->MayAlias(location1, location2);
+  }
+
+  // Removes the instructions of `set` which may read what `instruction` writes.
+  void KillEffectsOf(ValueSet* set, HInstruction* instruction);
+
+  // Removes the instructions of `set` which may read what the loop of `header` writes.
+  void KillLoopEffects(ValueSet* set, HBasicBlock* header);
+
   HGraph* graph_;
   ArenaAllocator* const allocator_;
   const SideEffectsAnalysis& side_effects_;
@@ -402,18 +441,31 @@ class GlobalValueNumberer : public ValueObject {
   // visited/unvisited boolean.
   ArenaBitVector visited_blocks_;
 
+  // Heap locations and their aliasing, or null if heap accesses are only
+  // disambiguated by their side effects.
+  HeapLocationCollector* heap_location_collector_;
+
+  // Map from instruction id to the heap location it accesses. The index and reference
+  // inputs of an access may be replaced during GVN, so this is computed up front.
+  ArenaVector<size_t> heap_locations_;
+
+  size_t number_of_removed_instructions_;
+
   DISALLOW_COPY_AND_ASSIGN(GlobalValueNumberer);
 };
 
 void GlobalValueNumberer::Run() {
   DCHECK(side_effects_.HasRun());
   sets_[graph_->GetEntryBlock()->GetBlockId()] = new (allocator_) ValueSet(allocator_);
+  HeapLocationCollector heap_location_collector(graph_);
+  CollectHeapLocations(&heap_location_collector);
 
   // Use the reverse post order to ensure the non back-edge predecessors of a block are
   // visited before the block itself.
   for (HReversePostOrderIterator it(*graph_); !it.Done(); it.Advance()) {
     VisitBasicBlock(it.Current());
   }
+  heap_location_collector_ = nullptr;
 }
 
 void GlobalValueNumberer::VisitBasicBlock(HBasicBlock* block) {
@@ -465,7 +517,7 @@ void GlobalValueNumberer::VisitBasicBlock(HBasicBlock* block) {
         } else {
           DCHECK(!block->GetLoopInformation()->IsIrreducible());
           DCHECK_EQ(block->GetDominator(), block->GetLoopInformation()->GetPreHeader());
-          set->Kill(side_effects_.GetLoopEffects(block));
+          KillLoopEffects(set, block);
         }
       } else if (predecessors.size() > 1) {
         for (HBasicBlock* predecessor : predecessors) {
@@ -500,12 +552,13 @@ void GlobalValueNumberer::VisitBasicBlock(HBasicBlock* block) {
         // Or current is used by a phi, and we don't do OrderInputs() on a phi anyway.
         current->ReplaceWith(existing);
         current->GetBlock()->RemoveInstruction(current);
+        ++number_of_removed_instructions_;
       } else {
-        set->Kill(current->GetSideEffects());
+        KillEffectsOf(set, current);
         set->Add(current);
       }
     } else {
-      set->Kill(current->GetSideEffects());
+      KillEffectsOf(set, current);
     }
     current = next;
   }
@@ -513,6 +566,98 @@ void GlobalValueNumberer::VisitBasicBlock(HBasicBlock* block) {
   visited_blocks_.SetBit(block->GetBlockId());
 }
 
+void GlobalValueNumberer::CollectHeapLocations(HeapLocationCollector* collector) {
+  for (HReversePostOrderIterator it(*graph_); !it.Done(); it.Advance()) {
+    collector->VisitBasicBlock(it.Current());
+  }
+  if (!collector->HasHeapStores() ||
+      collector->GetNumberOfHeapLocations() > kMaxNumberOfHeapLocations ||
+      collector->HasVolatile() ||
+      collector->HasMonitorOps()) {
+    // Nothing to disambiguate, or keep the plain side effects based GVN to be safe and
+    // avoid pathological compile times.
+    return;
+  }
+  collector->BuildAliasingMatrix();
+  heap_locations_.resize(graph_->GetCurrentInstructionId(),
+                         HeapLocationCollector::kHeapLocationNotFound);
+  for (HReversePostOrderIterator it(*graph_); !it.Done(); it.Advance()) {
+    for (HInstructionIterator inst_it(it.Current()->GetInstructions());
+         !inst_it.Done();
+         inst_it.Advance()) {
+      HInstruction* instruction = inst_it.Current();
+      heap_locations_[instruction->GetId()] = collector->FindHeapLocationIndexOfAccess(instruction);
+    }
+  }
+  heap_location_collector_ = collector;
+}
+
+void GlobalValueNumberer::KillEffectsOf(ValueSet* set, HInstruction* instruction) {
+  SideEffects side_effects = instruction->GetSideEffects();
+  size_t location = GetHeapLocationOf(instruction);
+  if (location == HeapLocationCollector::kHeapLocationNotFound || !side_effects.DoesAnyWrite()) {
+    set->Kill(side_effects);
+    return;
+  }
+  // A store to a known heap location only kills the loads which may alias with it.
+  set->KillWhich([this, side_effects, location](HInstruction* other) {
+    if (!other->GetSideEffects().MayDependOn(side_effects)) {
+      return false;
+    }
+    size_t other_location = GetHeapLocationOf(other);
+    return other_location == HeapLocationCollector::kHeapLocationNotFound ||
+        MayAlias(location, other_location);
+  });
+}
+
+void GlobalValueNumberer::KillLoopEffects(ValueSet* set, HBasicBlock* header) {
+  SideEffects loop_effects = side_effects_.GetLoopEffects(header);
+  if (heap_location_collector_ == nullptr) {
+    set->Kill(loop_effects);
+    return;
+  }
+  // Split the effects of the loop into the stores to known heap locations
+  // and the effects of all other instructions.
+  ArenaBitVector stored_locations(allocator_,
+                                  heap_location_collector_->GetNumberOfHeapLocations(),
+                                  /* expandable */ false,
+                                  kArenaAllocGvn);
+  SideEffects other_effects = SideEffects::None();
+  for (HBlocksInLoopIterator it(*header->GetLoopInformation()); !it.Done(); it.Advance()) {
+    for (HInstructionIterator inst_it(it.Current()->GetInstructions());
+         !inst_it.Done();
+         inst_it.Advance()) {
+      HInstruction* instruction = inst_it.Current();
+      size_t location = GetHeapLocationOf(instruction);
+      if (location != HeapLocationCollector::kHeapLocationNotFound &&
+          instruction->GetSideEffects().DoesAnyWrite()) {
+        stored_locations.SetBit(location);
+      } else {
+        other_effects = other_effects.Union(instruction->GetSideEffects());
+      }
+    }
+  }
+  set->KillWhich([this, loop_effects, other_effects, &stored_locations](HInstruction* other) {
+    SideEffects effects = other->GetSideEffects();
+    if (!effects.MayDependOn(loop_effects)) {
+      return false;
+    }
+    if (effects.MayDependOn(other_effects)) {
+      return true;
+    }
+    size_t location = GetHeapLocationOf(other);
+    if (location == HeapLocationCollector::kHeapLocationNotFound) {
+      return true;
+    }
+    for (uint32_t stored_location : stored_locations.Indexes()) {
+      if (MayAlias(location, stored_location)) {
+        return true;
+      }
+    }
+    return false;
+  });
+}
+
 bool GlobalValueNumberer::WillBeReferencedAgain(HBasicBlock* block) const {
   DCHECK(visited_blocks_.IsBitSet(block->GetBlockId()));
 
@@ -568,6 +713,7 @@ HBasicBlock* GlobalValueNumberer::FindVisitedBlockWithRecyclableSet(
 void GVNOptimization::Run() {
   GlobalValueNumberer gvn(graph_->GetArena(), graph_, side_effects_);
   gvn.Run();
+  MaybeRecordStat(kRemovedByGVN, gvn.GetNumberOfRemovedInstructions());
 }
 
 }  // namespace art
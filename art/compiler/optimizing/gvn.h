@@ -28,8 +28,9 @@ class GVNOptimization : public HOptimization {
  public:
   GVNOptimization(HGraph* graph,
                   const SideEffectsAnalysis& side_effects,
+                  OptimizingCompilerStats* stats = nullptr,
                   const char* pass_name = kGlobalValueNumberingPassName)
-      : HOptimization(graph, pass_name), side_effects_(side_effects) {}
+      : HOptimization(graph, pass_name, stats), side_effects_(side_effects) {}
 
   void Run() OVERRIDE;
 
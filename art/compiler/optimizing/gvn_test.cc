@@ -315,6 +315,129 @@ TEST_F(GVNTest, LoopFieldElimination) {
   ASSERT_TRUE(field_get_in_exit->GetBlock() == nullptr);
 }
 
+// Test that a store in a loop only kills the field gets which may alias with it.
+TEST_F(GVNTest, LoopFieldEliminationWithNonAliasingStore) {
+  ArenaPool pool;
+  ArenaAllocator allocator(&pool);
+  ScopedNullHandle<mirror::DexCache> dex_cache;
+
+  HGraph* graph = CreateGraph(&allocator);
+  HBasicBlock* entry = new (&allocator) HBasicBlock(graph);
+  graph->AddBlock(entry);
+  graph->SetEntryBlock(entry);
+
+  HInstruction* parameter = new (&allocator) HParameterValue(graph->GetDexFile(),
+                                                             0,
+                                                             0,
+                                                             Primitive::kPrimNot);
+  entry->AddInstruction(parameter);
+
+  HBasicBlock* block = new (&allocator) HBasicBlock(graph);
+  graph->AddBlock(block);
+  entry->AddSuccessor(block);
+  block->AddInstruction(new (&allocator) HInstanceFieldGet(parameter,
+                                                           Primitive::kPrimBoolean,
+                                                           MemberOffset(42),
+                                                           false,
+                                                           kUnknownFieldIndex,
+                                                           kUnknownClassDefIndex,
+                                                           graph->GetDexFile(),
+                                                           dex_cache,
+                                                           0));
+  HInstruction* field_get = block->GetLastInstruction();
+  block->AddInstruction(new (&allocator) HInstanceFieldGet(parameter,
+                                                           Primitive::kPrimBoolean,
+                                                           MemberOffset(43),
+                                                           false,
+                                                           kUnknownFieldIndex,
+                                                           kUnknownClassDefIndex,
+                                                           graph->GetDexFile(),
+                                                           dex_cache,
+                                                           0));
+  block->AddInstruction(new (&allocator) HGoto());
+
+  HBasicBlock* loop_header = new (&allocator) HBasicBlock(graph);
+  HBasicBlock* loop_body = new (&allocator) HBasicBlock(graph);
+  HBasicBlock* exit = new (&allocator) HBasicBlock(graph);
+
+  graph->AddBlock(loop_header);
+  graph->AddBlock(loop_body);
+  graph->AddBlock(exit);
+  block->AddSuccessor(loop_header);
+  loop_header->AddSuccessor(loop_body);
+  loop_header->AddSuccessor(exit);
+  loop_body->AddSuccessor(loop_header);
+
+  loop_header->AddInstruction(new (&allocator) HInstanceFieldGet(parameter,
+                                                                 Primitive::kPrimBoolean,
+                                                                 MemberOffset(42),
+                                                                 false,
+                                                                 kUnknownFieldIndex,
+                                                                 kUnknownClassDefIndex,
+                                                                 graph->GetDexFile(),
+                                                                 dex_cache,
+                                                                 0));
+  HInstruction* field_get_in_loop_header = loop_header->GetLastInstruction();
+  loop_header->AddInstruction(new (&allocator) HIf(field_get));
+
+  // A store of the same type to a different field does not kill the field gets.
+  loop_body->AddInstruction(new (&allocator) HInstanceFieldSet(parameter,
+                                                               field_get,
+                                                               Primitive::kPrimBoolean,
+                                                               MemberOffset(43),
+                                                               false,
+                                                               kUnknownFieldIndex,
+                                                               kUnknownClassDefIndex,
+                                                               graph->GetDexFile(),
+                                                               dex_cache,
+                                                               0));
+  loop_body->AddInstruction(new (&allocator) HInstanceFieldGet(parameter,
+                                                               Primitive::kPrimBoolean,
+                                                               MemberOffset(42),
+                                                               false,
+                                                               kUnknownFieldIndex,
+                                                               kUnknownClassDefIndex,
+                                                               graph->GetDexFile(),
+                                                               dex_cache,
+                                                               0));
+  HInstruction* field_get_in_loop_body = loop_body->GetLastInstruction();
+  loop_body->AddInstruction(new (&allocator) HInstanceFieldGet(parameter,
+                                                               Primitive::kPrimBoolean,
+                                                               MemberOffset(43),
+                                                               false,
+                                                               kUnknownFieldIndex,
+                                                               kUnknownClassDefIndex,
+                                                               graph->GetDexFile(),
+                                                               dex_cache,
+                                                               0));
+  HInstruction* stored_field_get_in_loop_body = loop_body->GetLastInstruction();
+  loop_body->AddInstruction(new (&allocator) HGoto());
+
+  exit->AddInstruction(new (&allocator) HInstanceFieldGet(parameter,
+                                                          Primitive::kPrimBoolean,
+                                                          MemberOffset(43),
+                                                          false,
+                                                          kUnknownFieldIndex,
+                                                          kUnknownClassDefIndex,
+                                                          graph->GetDexFile(),
+                                                          dex_cache,
+                                                          0));
+  HInstruction* stored_field_get_in_exit = exit->GetLastInstruction();
+  exit->AddInstruction(new (&allocator) HExit());
+
+  graph->BuildDominatorTree();
+  SideEffectsAnalysis side_effects(graph);
+  side_effects.Run();
+  GVNOptimization(graph, side_effects).Run();
+
+  // The gets of the field that is not stored to are all GVN'ed.
+  ASSERT_TRUE(field_get_in_loop_header->GetBlock() == nullptr);
+  ASSERT_TRUE(field_get_in_loop_body->GetBlock() == nullptr);
+  // The gets of the stored field are killed by the store in the loop.
+  ASSERT_EQ(stored_field_get_in_loop_body->GetBlock(), loop_body);
+  ASSERT_EQ(stored_field_get_in_exit->GetBlock(), exit);
+}
+
 // Test that inner loops affect the side effects of the outer loop.
 TEST_F(GVNTest, LoopSideEffects) {
   ArenaPool pool;
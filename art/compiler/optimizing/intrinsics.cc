@@ -339,9 +339,20 @@ static Intrinsics GetIntrinsic(InlineMethod method) {
     case kIntrinsicSystemArrayCopyCharArray:
       return Intrinsics::kSystemArrayCopyChar;
 
+    case kIntrinsicSystemArrayCopyByteArray:
+      return Intrinsics::kSystemArrayCopyByte;
+    case kIntrinsicSystemArrayCopyIntArray:
+      return Intrinsics::kSystemArrayCopyInt;
+
     case kIntrinsicSystemArrayCopy:
       return Intrinsics::kSystemArrayCopy;
 
+    // Arrays.fill.
+    case kIntrinsicArraysFillByteArray:
+      return Intrinsics::kArraysFillByte;
+    case kIntrinsicArraysFillIntArray:
+      return Intrinsics::kArraysFillInt;
+
     // Thread.currentThread.
     case kIntrinsicCurrentThread:
       return Intrinsics::kThreadCurrentThread;
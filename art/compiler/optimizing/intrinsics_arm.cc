@@ -2007,6 +2007,10 @@ UNIMPLEMENTED_INTRINSIC(ARM, IntegerHighestOneBit)
 UNIMPLEMENTED_INTRINSIC(ARM, LongHighestOneBit)
 UNIMPLEMENTED_INTRINSIC(ARM, IntegerLowestOneBit)
 UNIMPLEMENTED_INTRINSIC(ARM, LongLowestOneBit)
+UNIMPLEMENTED_INTRINSIC(ARM, SystemArrayCopyByte)
+UNIMPLEMENTED_INTRINSIC(ARM, SystemArrayCopyInt)
+UNIMPLEMENTED_INTRINSIC(ARM, ArraysFillByte)
+UNIMPLEMENTED_INTRINSIC(ARM, ArraysFillInt)
 
 // 1.8.
 UNIMPLEMENTED_INTRINSIC(ARM, UnsafeGetAndAddInt)
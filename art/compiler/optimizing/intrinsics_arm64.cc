@@ -2208,6 +2208,10 @@ UNIMPLEMENTED_INTRINSIC(ARM64, IntegerHighestOneBit)
 UNIMPLEMENTED_INTRINSIC(ARM64, LongHighestOneBit)
 UNIMPLEMENTED_INTRINSIC(ARM64, IntegerLowestOneBit)
 UNIMPLEMENTED_INTRINSIC(ARM64, LongLowestOneBit)
+UNIMPLEMENTED_INTRINSIC(ARM64, SystemArrayCopyByte)
+UNIMPLEMENTED_INTRINSIC(ARM64, SystemArrayCopyInt)
+UNIMPLEMENTED_INTRINSIC(ARM64, ArraysFillByte)
+UNIMPLEMENTED_INTRINSIC(ARM64, ArraysFillInt)
 
 // 1.8.
 UNIMPLEMENTED_INTRINSIC(ARM64, UnsafeGetAndAddInt)
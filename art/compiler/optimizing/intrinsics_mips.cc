@@ -2463,6 +2463,10 @@ UNIMPLEMENTED_INTRINSIC(MIPS, MathNextAfter)
 UNIMPLEMENTED_INTRINSIC(MIPS, MathSinh)
 UNIMPLEMENTED_INTRINSIC(MIPS, MathTan)
 UNIMPLEMENTED_INTRINSIC(MIPS, MathTanh)
+UNIMPLEMENTED_INTRINSIC(MIPS, SystemArrayCopyByte)
+UNIMPLEMENTED_INTRINSIC(MIPS, SystemArrayCopyInt)
+UNIMPLEMENTED_INTRINSIC(MIPS, ArraysFillByte)
+UNIMPLEMENTED_INTRINSIC(MIPS, ArraysFillInt)
 
 // 1.8.
 UNIMPLEMENTED_INTRINSIC(MIPS, UnsafeGetAndAddInt)
@@ -1726,6 +1726,10 @@ UNIMPLEMENTED_INTRINSIC(MIPS64, IntegerHighestOneBit)
 UNIMPLEMENTED_INTRINSIC(MIPS64, LongHighestOneBit)
 UNIMPLEMENTED_INTRINSIC(MIPS64, IntegerLowestOneBit)
 UNIMPLEMENTED_INTRINSIC(MIPS64, LongLowestOneBit)
+UNIMPLEMENTED_INTRINSIC(MIPS64, SystemArrayCopyByte)
+UNIMPLEMENTED_INTRINSIC(MIPS64, SystemArrayCopyInt)
+UNIMPLEMENTED_INTRINSIC(MIPS64, ArraysFillByte)
+UNIMPLEMENTED_INTRINSIC(MIPS64, ArraysFillInt)
 
 // 1.8.
 UNIMPLEMENTED_INTRINSIC(MIPS64, UnsafeGetAndAddInt)
@@ -934,7 +934,7 @@ void IntrinsicCodeGeneratorX86_64::VisitStringCharAt(HInvoke* invoke) {
   __ Bind(slow_path->GetExitLabel());
 }
 
-void IntrinsicLocationsBuilderX86_64::VisitSystemArrayCopyChar(HInvoke* invoke) {
+static void CreateSystemArrayCopyPrimitiveLocations(ArenaAllocator* arena, HInvoke* invoke) {
   // Check to see if we have known failures that will cause us to have to bail out
   // to the runtime, and just generate the runtime call directly.
   HIntConstant* src_pos = invoke->InputAt(1)->AsIntConstant();
@@ -957,9 +957,9 @@ void IntrinsicLocationsBuilderX86_64::VisitSystemArrayCopyChar(HInvoke* invoke)
     }
   }
 
-  LocationSummary* locations = new (arena_) LocationSummary(invoke,
-                                                            LocationSummary::kCallOnSlowPath,
-                                                            kIntrinsified);
+  LocationSummary* locations = new (arena) LocationSummary(invoke,
+                                                           LocationSummary::kCallOnSlowPath,
+                                                           kIntrinsified);
   // arraycopy(Object src, int src_pos, Object dest, int dest_pos, int length).
   locations->SetInAt(0, Location::RequiresRegister());
   locations->SetInAt(1, Location::RegisterOrConstant(invoke->InputAt(1)));
@@ -967,12 +967,24 @@ void IntrinsicLocationsBuilderX86_64::VisitSystemArrayCopyChar(HInvoke* invoke)
   locations->SetInAt(3, Location::RegisterOrConstant(invoke->InputAt(3)));
   locations->SetInAt(4, Location::RegisterOrConstant(invoke->InputAt(4)));
 
-  // And we need some temporaries.  We will use REP MOVSW, so we need fixed registers.
+  // And we need some temporaries.  We will use REP MOVS, so we need fixed registers.
   locations->AddTemp(Location::RegisterLocation(RSI));
   locations->AddTemp(Location::RegisterLocation(RDI));
   locations->AddTemp(Location::RegisterLocation(RCX));
 }
 
+void IntrinsicLocationsBuilderX86_64::VisitSystemArrayCopyChar(HInvoke* invoke) {
+  CreateSystemArrayCopyPrimitiveLocations(arena_, invoke);
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitSystemArrayCopyByte(HInvoke* invoke) {
+  CreateSystemArrayCopyPrimitiveLocations(arena_, invoke);
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitSystemArrayCopyInt(HInvoke* invoke) {
+  CreateSystemArrayCopyPrimitiveLocations(arena_, invoke);
+}
+
 static void CheckPosition(X86_64Assembler* assembler,
                           Location pos,
                           CpuRegister input,
@@ -1039,8 +1051,12 @@ static void CheckPosition(X86_64Assembler* assembler,
   }
 }
 
-void IntrinsicCodeGeneratorX86_64::VisitSystemArrayCopyChar(HInvoke* invoke) {
-  X86_64Assembler* assembler = GetAssembler();
+// Copies between two arrays of the primitive `type`, which is at most 4 bytes wide, with REP MOVS.
+static void GenSystemArrayCopyPrimitive(X86_64Assembler* assembler,
+                                        CodeGeneratorX86_64* codegen,
+                                        ArenaAllocator* allocator,
+                                        HInvoke* invoke,
+                                        Primitive::Type type) {
   LocationSummary* locations = invoke->GetLocations();
 
   CpuRegister src = locations->InAt(0).AsRegister<CpuRegister>();
@@ -1049,7 +1065,7 @@ void IntrinsicCodeGeneratorX86_64::VisitSystemArrayCopyChar(HInvoke* invoke) {
   Location dest_pos = locations->InAt(3);
   Location length = locations->InAt(4);
 
-  // Temporaries that we need for MOVSW.
+  // Temporaries that we need for MOVS.
   CpuRegister src_base = locations->GetTemp(0).AsRegister<CpuRegister>();
   DCHECK_EQ(src_base.AsRegister(), RSI);
   CpuRegister dest_base = locations->GetTemp(1).AsRegister<CpuRegister>();
@@ -1057,8 +1073,8 @@ void IntrinsicCodeGeneratorX86_64::VisitSystemArrayCopyChar(HInvoke* invoke) {
   CpuRegister count = locations->GetTemp(2).AsRegister<CpuRegister>();
   DCHECK_EQ(count.AsRegister(), RCX);
 
-  SlowPathCode* slow_path = new (GetAllocator()) IntrinsicSlowPathX86_64(invoke);
-  codegen_->AddSlowPath(slow_path);
+  SlowPathCode* slow_path = new (allocator) IntrinsicSlowPathX86_64(invoke);
+  codegen->AddSlowPath(slow_path);
 
   // Bail out if the source and destination are the same.
   __ cmpl(src, dest);
@@ -1093,33 +1109,134 @@ void IntrinsicCodeGeneratorX86_64::VisitSystemArrayCopyChar(HInvoke* invoke) {
   }
 
   // Okay, everything checks out.  Finally time to do the copy.
-  // Check assumption that sizeof(Char) is 2 (used in scaling below).
-  const size_t char_size = Primitive::ComponentSize(Primitive::kPrimChar);
-  DCHECK_EQ(char_size, 2u);
+  const size_t component_size = Primitive::ComponentSize(type);
+  const ScaleFactor scale_factor = static_cast<ScaleFactor>(Primitive::ComponentSizeShift(type));
+  DCHECK_LE(component_size, 4u);
 
-  const uint32_t data_offset = mirror::Array::DataOffset(char_size).Uint32Value();
+  const uint32_t data_offset = mirror::Array::DataOffset(component_size).Uint32Value();
 
   if (src_pos.IsConstant()) {
     int32_t src_pos_const = src_pos.GetConstant()->AsIntConstant()->GetValue();
-    __ leal(src_base, Address(src, char_size * src_pos_const + data_offset));
+    __ leal(src_base, Address(src, component_size * src_pos_const + data_offset));
   } else {
-    __ leal(src_base, Address(src, src_pos.AsRegister<CpuRegister>(),
-                              ScaleFactor::TIMES_2, data_offset));
+    __ leal(src_base, Address(src, src_pos.AsRegister<CpuRegister>(), scale_factor, data_offset));
   }
   if (dest_pos.IsConstant()) {
     int32_t dest_pos_const = dest_pos.GetConstant()->AsIntConstant()->GetValue();
-    __ leal(dest_base, Address(dest, char_size * dest_pos_const + data_offset));
+    __ leal(dest_base, Address(dest, component_size * dest_pos_const + data_offset));
   } else {
     __ leal(dest_base, Address(dest, dest_pos.AsRegister<CpuRegister>(),
-                               ScaleFactor::TIMES_2, data_offset));
+                               scale_factor, data_offset));
   }
 
   // Do the move.
-  __ rep_movsw();
+  switch (component_size) {
+    case 1u:
+      __ rep_movsb();
+      break;
+    case 2u:
+      __ rep_movsw();
+      break;
+    case 4u:
+      __ rep_movsl();
+      break;
+    default:
+      LOG(FATAL) << "Unexpected array component type " << type;
+      UNREACHABLE();
+  }
 
   __ Bind(slow_path->GetExitLabel());
 }
 
+void IntrinsicCodeGeneratorX86_64::VisitSystemArrayCopyChar(HInvoke* invoke) {
+  GenSystemArrayCopyPrimitive(GetAssembler(), codegen_, GetAllocator(), invoke,
+                              Primitive::kPrimChar);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitSystemArrayCopyByte(HInvoke* invoke) {
+  GenSystemArrayCopyPrimitive(GetAssembler(), codegen_, GetAllocator(), invoke,
+                              Primitive::kPrimByte);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitSystemArrayCopyInt(HInvoke* invoke) {
+  GenSystemArrayCopyPrimitive(GetAssembler(), codegen_, GetAllocator(), invoke,
+                              Primitive::kPrimInt);
+}
+
+static void CreateArraysFillLocations(ArenaAllocator* arena, HInvoke* invoke) {
+  LocationSummary* locations = new (arena) LocationSummary(invoke,
+                                                           LocationSummary::kCallOnSlowPath,
+                                                           kIntrinsified);
+  // fill(array, value). We will use REP STOS, which takes the value in RAX.
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RegisterLocation(RAX));
+  locations->AddTemp(Location::RegisterLocation(RDI));
+  locations->AddTemp(Location::RegisterLocation(RCX));
+}
+
+// Stores the value to every element of an array of the primitive `type`, which is either 1 or
+// 4 bytes wide, with REP STOS.
+static void GenArraysFill(X86_64Assembler* assembler,
+                          CodeGeneratorX86_64* codegen,
+                          ArenaAllocator* allocator,
+                          HInvoke* invoke,
+                          Primitive::Type type) {
+  LocationSummary* locations = invoke->GetLocations();
+
+  CpuRegister array = locations->InAt(0).AsRegister<CpuRegister>();
+  DCHECK_EQ(locations->InAt(1).AsRegister<CpuRegister>().AsRegister(), RAX);
+  CpuRegister dest_base = locations->GetTemp(0).AsRegister<CpuRegister>();
+  DCHECK_EQ(dest_base.AsRegister(), RDI);
+  CpuRegister count = locations->GetTemp(1).AsRegister<CpuRegister>();
+  DCHECK_EQ(count.AsRegister(), RCX);
+
+  SlowPathCode* slow_path = nullptr;
+  if (invoke->InputAt(0)->CanBeNull()) {
+    // Let the original method throw the NullPointerException.
+    slow_path = new (allocator) IntrinsicSlowPathX86_64(invoke);
+    codegen->AddSlowPath(slow_path);
+    __ testl(array, array);
+    __ j(kEqual, slow_path->GetEntryLabel());
+  }
+
+  const size_t component_size = Primitive::ComponentSize(type);
+  const uint32_t length_offset = mirror::Array::LengthOffset().Uint32Value();
+  const uint32_t data_offset = mirror::Array::DataOffset(component_size).Uint32Value();
+  __ movl(count, Address(array, length_offset));
+  __ leal(dest_base, Address(array, data_offset));
+
+  switch (component_size) {
+    case 1u:
+      __ rep_stosb();
+      break;
+    case 4u:
+      __ rep_stosl();
+      break;
+    default:
+      LOG(FATAL) << "Unexpected array component type " << type;
+      UNREACHABLE();
+  }
+
+  if (slow_path != nullptr) {
+    __ Bind(slow_path->GetExitLabel());
+  }
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitArraysFillByte(HInvoke* invoke) {
+  CreateArraysFillLocations(arena_, invoke);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitArraysFillByte(HInvoke* invoke) {
+  GenArraysFill(GetAssembler(), codegen_, GetAllocator(), invoke, Primitive::kPrimByte);
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitArraysFillInt(HInvoke* invoke) {
+  CreateArraysFillLocations(arena_, invoke);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitArraysFillInt(HInvoke* invoke) {
+  GenArraysFill(GetAssembler(), codegen_, GetAllocator(), invoke, Primitive::kPrimInt);
+}
 
 void IntrinsicLocationsBuilderX86_64::VisitSystemArrayCopy(HInvoke* invoke) {
   CodeGenerator::CreateSystemArrayCopyLocationSummary(invoke);
@@ -1388,12 +1505,15 @@ void IntrinsicLocationsBuilderX86_64::VisitStringEquals(HInvoke* invoke) {
   locations->SetInAt(0, Location::RequiresRegister());
   locations->SetInAt(1, Location::RequiresRegister());
 
-  // Request temporary registers, RCX and RDI needed for repe_cmpsq instruction.
-  locations->AddTemp(Location::RegisterLocation(RCX));
-  locations->AddTemp(Location::RegisterLocation(RDI));
+  // Request temporary registers for the length and the comparison mask.
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  // Request temporary registers for the compared blocks of characters.
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
 
-  // Set output, RSI needed for repe_cmpsq instruction anyways.
-  locations->SetOut(Location::RegisterLocation(RSI), Location::kOutputOverlap);
+  // The output is also used as the offset of the compared block.
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
 }
 
 void IntrinsicCodeGeneratorX86_64::VisitStringEquals(HInvoke* invoke) {
@@ -1402,11 +1522,14 @@ void IntrinsicCodeGeneratorX86_64::VisitStringEquals(HInvoke* invoke) {
 
   CpuRegister str = locations->InAt(0).AsRegister<CpuRegister>();
   CpuRegister arg = locations->InAt(1).AsRegister<CpuRegister>();
-  CpuRegister rcx = locations->GetTemp(0).AsRegister<CpuRegister>();
-  CpuRegister rdi = locations->GetTemp(1).AsRegister<CpuRegister>();
-  CpuRegister rsi = locations->Out().AsRegister<CpuRegister>();
+  CpuRegister length = locations->GetTemp(0).AsRegister<CpuRegister>();
+  CpuRegister mask = locations->GetTemp(1).AsRegister<CpuRegister>();
+  XmmRegister str_block = locations->GetTemp(2).AsFpuRegister<XmmRegister>();
+  XmmRegister arg_block = locations->GetTemp(3).AsFpuRegister<XmmRegister>();
+  CpuRegister offset = locations->Out().AsRegister<CpuRegister>();
 
-  NearLabel end, return_true, return_false;
+  Label end, return_true, return_false;
+  NearLabel short_string, loop, loop_condition;
 
   // Get offsets of count, value, and class fields within a string object.
   const uint32_t count_offset = mirror::String::CountOffset().Uint32Value();
@@ -1424,8 +1547,8 @@ void IntrinsicCodeGeneratorX86_64::VisitStringEquals(HInvoke* invoke) {
   // All string objects must have the same type since String cannot be subclassed.
   // Receiver must be a string object, so its class field is equal to all strings' class fields.
   // If the argument is a string object, its class field must be equal to receiver's class field.
-  __ movl(rcx, Address(str, class_offset));
-  __ cmpl(rcx, Address(arg, class_offset));
+  __ movl(length, Address(str, class_offset));
+  __ cmpl(length, Address(arg, class_offset));
   __ j(kNotEqual, &return_false);
 
   // Reference equality check, return true if same reference.
@@ -1433,39 +1556,69 @@ void IntrinsicCodeGeneratorX86_64::VisitStringEquals(HInvoke* invoke) {
   __ j(kEqual, &return_true);
 
   // Load length of receiver string.
-  __ movl(rcx, Address(str, count_offset));
+  __ movl(length, Address(str, count_offset));
   // Check if lengths are equal, return false if they're not.
-  __ cmpl(rcx, Address(arg, count_offset));
+  __ cmpl(length, Address(arg, count_offset));
   __ j(kNotEqual, &return_false);
   // Return true if both strings are empty.
-  __ jrcxz(&return_true);
-
-  // Load starting addresses of string values into RSI/RDI as required for repe_cmpsq instruction.
-  __ leal(rsi, Address(str, value_offset));
-  __ leal(rdi, Address(arg, value_offset));
+  __ testl(length, length);
+  __ j(kEqual, &return_true);
 
-  // Divide string length by 4 and adjust for lengths not divisible by 4.
-  __ addl(rcx, Immediate(3));
-  __ shrl(rcx, Immediate(2));
+  // Strings shorter than a block are compared four characters at a time.
+  static constexpr size_t kCharsPerBlock = 16u / sizeof(uint16_t);
+  __ cmpl(length, Immediate(kCharsPerBlock));
+  __ j(kLess, &short_string);
+
+  // Compare the strings a block of eight characters at a time with SSE2, which all x86-64 CPUs
+  // have. The last block ends at the last character and may overlap the previous one, so that
+  // nothing is read past the end of the strings.
+  __ leal(length, Address(length, length, TIMES_1, -16));  // Offset of the last block.
+  __ xorl(offset, offset);
+  __ jmp(&loop_condition);
+  __ Bind(&loop);
+  __ movdqu(str_block, Address(str, offset, TIMES_1, value_offset));
+  __ movdqu(arg_block, Address(arg, offset, TIMES_1, value_offset));
+  __ pcmpeqw(str_block, arg_block);
+  __ pmovmskb(mask, str_block);
+  __ cmpl(mask, Immediate(0xffff));
+  __ j(kNotEqual, &return_false);
+  __ addl(offset, Immediate(16));
+  __ Bind(&loop_condition);
+  __ cmpl(offset, length);
+  __ j(kLess, &loop);
+  __ movdqu(str_block, Address(str, length, TIMES_1, value_offset));
+  __ movdqu(arg_block, Address(arg, length, TIMES_1, value_offset));
+  __ pcmpeqw(str_block, arg_block);
+  __ pmovmskb(mask, str_block);
+  __ cmpl(mask, Immediate(0xffff));
+  __ j(kNotEqual, &return_false);
+  __ jmp(&return_true);
 
-  // Assertions that must hold in order to compare strings 4 characters at a time.
+  // Assertions that must hold in order to compare short strings 4 characters at a time.
   DCHECK_ALIGNED(value_offset, 8);
   static_assert(IsAligned<8>(kObjectAlignment), "String is not zero padded");
 
-  // Loop to compare strings four characters at a time starting at the beginning of the string.
-  __ repe_cmpsq();
-  // If strings are not equal, zero flag will be cleared.
+  // A string shorter than a block fits in two quadwords, the second one only if it has more
+  // than four characters.
+  __ Bind(&short_string);
+  __ movq(mask, Address(str, value_offset));
+  __ cmpq(mask, Address(arg, value_offset));
+  __ j(kNotEqual, &return_false);
+  __ cmpl(length, Immediate(4));
+  __ j(kLessEqual, &return_true);
+  __ movq(mask, Address(str, value_offset + 8));
+  __ cmpq(mask, Address(arg, value_offset + 8));
   __ j(kNotEqual, &return_false);
 
   // Return true and exit the function.
-  // If loop does not result in returning false, we return true.
+  // If no block differs, we return true.
   __ Bind(&return_true);
-  __ movl(rsi, Immediate(1));
+  __ movl(offset, Immediate(1));
   __ jmp(&end);
 
   // Return false and exit the function.
   __ Bind(&return_false);
-  __ xorl(rsi, rsi);
+  __ xorl(offset, offset);
   __ Bind(&end);
 }
 
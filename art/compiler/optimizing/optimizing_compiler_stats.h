@@ -65,6 +65,7 @@ enum MethodCompilationStat {
   kInlinedInvokeVirtualOrInterface,
   kImplicitNullCheckGenerated,
   kExplicitNullCheckGenerated,
+  kRemovedByGVN,
   kLastStat
 };
 
@@ -143,6 +144,7 @@ class OptimizingCompilerStats {
       case kInlinedInvokeVirtualOrInterface: name = "InlinedInvokeVirtualOrInterface"; break;
       case kImplicitNullCheckGenerated: name = "ImplicitNullCheckGenerated"; break;
       case kExplicitNullCheckGenerated: name = "ExplicitNullCheckGenerated"; break;
+      case kRemovedByGVN: name = "RemovedByGVN"; break;
 
       case kLastStat:
         LOG(FATAL) << "invalid stat "
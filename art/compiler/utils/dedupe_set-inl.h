@@ -42,6 +42,8 @@ struct DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Stats {
   size_t collision_max = 0u;
   size_t total_probe_distance = 0u;
   size_t total_size = 0u;
+  size_t total_adds = 0u;
+  size_t total_hits = 0u;
 };
 
 template <typename InKey,
@@ -56,7 +58,9 @@ class DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Shard {
       : alloc_(alloc),
         lock_name_(lock_name),
         lock_(lock_name_.c_str()),
-        keys_() {
+        keys_(),
+        adds_(0u),
+        hits_(0u) {
   }
 
   ~Shard() {
@@ -67,14 +71,29 @@ class DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Shard {
   }
 
   const StoreKey* Add(Thread* self, size_t hash, const InKey& in_key) REQUIRES(!lock_) {
-    MutexLock lock(self, lock_);
     HashedKey<InKey> hashed_in_key(hash, &in_key);
+    {
+      MutexLock lock(self, lock_);
+      ++adds_;
+      auto it = keys_.Find(hashed_in_key);
+      if (it != keys_.end()) {
+        DCHECK(it->Key() != nullptr);
+        ++hits_;
+        return it->Key();
+      }
+    }
+    // Copy the key without holding the lock, the allocator may need to write it to the swap file.
+    // Alloc::Copy() must therefore be thread-safe.
+    const StoreKey* store_key = alloc_.Copy(in_key);
+    MutexLock lock(self, lock_);
     auto it = keys_.Find(hashed_in_key);
-    if (it != keys_.end()) {
+    if (UNLIKELY(it != keys_.end())) {
+      // Another thread added an equal key while we were copying.
       DCHECK(it->Key() != nullptr);
+      alloc_.Destroy(store_key);
+      ++hits_;
       return it->Key();
     }
-    const StoreKey* store_key = alloc_.Copy(in_key);
     keys_.Insert(HashedKey<StoreKey> { hash, store_key });
     return store_key;
   }
@@ -89,6 +108,8 @@ class DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Shard {
       // It may have been higher before a re-hash.
       global_stats->total_probe_distance += keys_.TotalProbeDistance();
       global_stats->total_size += keys_.Size();
+      global_stats->total_adds += adds_;
+      global_stats->total_hits += hits_;
       for (const HashedKey<StoreKey>& key : keys_) {
         auto it = stats.find(key.Hash());
         if (it == stats.end()) {
@@ -176,6 +197,9 @@ class DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Shard {
   const std::string lock_name_;
   Mutex lock_;
   HashSet<HashedKey<StoreKey>, ShardEmptyFn, ShardHashFn, ShardPred> keys_ GUARDED_BY(lock_);
+  // Number of calls to Add() and how many of them found an existing key.
+  size_t adds_ GUARDED_BY(lock_);
+  size_t hits_ GUARDED_BY(lock_);
 };
 
 template <typename InKey,
@@ -238,8 +262,14 @@ std::string DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::DumpS
   for (HashType shard = 0; shard < kShard; ++shard) {
     shards_[shard]->UpdateStats(self, &stats);
   }
-  return StringPrintf("%zu collisions, %zu max hash collisions, "
+  const double hit_ratio = (stats.total_adds != 0u)
+      ? 100.0 * stats.total_hits / stats.total_adds
+      : 0.0;
+  return StringPrintf("%zu/%zu hits (%.1f%%), %zu collisions, %zu max hash collisions, "
                       "%zu/%zu probe distance, %" PRIu64 " ns hash time",
+                      stats.total_hits,
+                      stats.total_adds,
+                      hit_ratio,
                       stats.collision_sum,
                       stats.collision_max,
                       stats.total_probe_distance,
@@ -29,7 +29,8 @@ class Thread;
 
 // A set of Keys that support a HashFunc returning HashType. Used to find duplicates of Key in the
 // Add method. The data-structure is thread-safe through the use of internal locks, it also
-// supports the lock being sharded.
+// supports the lock being sharded. Keys are hashed and copied outside of the locks, so the
+// Alloc must be thread-safe.
 template <typename InKey,
           typename StoreKey,
           typename Alloc,
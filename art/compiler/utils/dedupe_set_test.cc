@@ -86,6 +86,9 @@ TEST(DedupeSetTest, Test) {
     ASSERT_NE(array3, array1);
     ASSERT_TRUE(std::equal(test3.begin(), test3.end(), array3->begin()));
   }
+
+  std::string stats = deduplicator.DumpStats(self);
+  EXPECT_NE(stats.find("1/3 hits"), std::string::npos) << stats;
 }
 
 }  // namespace art
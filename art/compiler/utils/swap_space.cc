@@ -17,6 +17,7 @@
 #include "swap_space.h"
 
 #include <algorithm>
+#include <fcntl.h>
 #include <numeric>
 #include <sys/mman.h>
 
@@ -61,6 +62,7 @@ inline void SwapSpace::InsertChunk(const SpaceChunk& chunk) {
 SwapSpace::SwapSpace(int fd, size_t initial_size)
     : fd_(fd),
       size_(0),
+      last_chunk_offset_(0u),
       lock_("SwapSpace lock", static_cast<LockLevel>(LockLevel::kDefaultMutexLevel - 1)) {
   // Assume that the file is unlinked.
 
@@ -135,6 +137,13 @@ void* SwapSpace::Alloc(size_t size) {
 
 SwapSpace::SpaceChunk SwapSpace::NewFileChunk(size_t min_size) {
 #if !defined(__APPLE__)
+  if (size_ != last_chunk_offset_) {
+    // Start asynchronous writeback of the previous chunk so that its pages are clean and can be
+    // dropped without stalls when memory gets tight. (msync() with MS_ASYNC is a no-op on Linux.)
+    // POSIX_FADV_DONTNEED does not drop pages that are still mapped, so this only initiates the
+    // writeback and does not block.
+    posix_fadvise64(fd_, last_chunk_offset_, size_ - last_chunk_offset_, POSIX_FADV_DONTNEED);
+  }
   size_t next_part = std::max(RoundUp(min_size, kPageSize), RoundUp(kMininumMapSize, kPageSize));
   int result = TEMP_FAILURE_RETRY(ftruncate64(fd_, size_ + next_part));
   if (result != 0) {
@@ -150,6 +159,7 @@ SwapSpace::SpaceChunk SwapSpace::NewFileChunk(size_t min_size) {
     LOG(ERROR) << "In free list: " << CollectFree(free_by_start_, free_by_size_);
     LOG(FATAL) << "Aborting...";
   }
+  last_chunk_offset_ = size_;
   size_ += next_part;
   SpaceChunk new_chunk = {ptr, next_part};
   return new_chunk;
@@ -160,6 +170,16 @@ SwapSpace::SpaceChunk SwapSpace::NewFileChunk(size_t min_size) {
 #endif
 }
 
+void SwapSpace::Prefetch(const void* ptr, size_t size) {
+  if (size == 0u) {
+    return;
+  }
+  uintptr_t start = RoundDown(reinterpret_cast<uintptr_t>(ptr), kPageSize);
+  uintptr_t end = RoundUp(reinterpret_cast<uintptr_t>(ptr) + size, kPageSize);
+  // This is just a hint, ignore failures.
+  madvise(reinterpret_cast<void*>(start), end - start, MADV_WILLNEED);
+}
+
 // TODO: Full coalescing.
 void SwapSpace::Free(void* ptr, size_t size) {
   MutexLock lock(Thread::Current(), lock_);
@@ -42,6 +42,10 @@ class SwapSpace {
     return size_;
   }
 
+  // Hint that the memory in [ptr, ptr + size) will be read soon, so that the kernel can start
+  // reading back pages of the swap file that have been evicted.
+  static void Prefetch(const void* ptr, size_t size);
+
  private:
   // Chunk of space.
   struct SpaceChunk {
@@ -85,6 +89,9 @@ class SwapSpace {
 
   int fd_;
   size_t size_;
+  // File offset of the most recently mapped chunk. Once a new chunk is needed, the previous one
+  // is mostly written and we start its writeback.
+  size_t last_chunk_offset_ GUARDED_BY(lock_);
 
   // NOTE: Boost.Bimap would be useful for the two following members.
 
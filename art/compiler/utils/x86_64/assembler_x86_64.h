@@ -403,6 +403,9 @@ class X86_64Assembler FINAL : public Assembler {
   void movd(XmmRegister dst, CpuRegister src, bool is64bit);
   void movd(CpuRegister dst, XmmRegister src, bool is64bit);
 
+  void movdqu(XmmRegister dst, const Address& src);
+  void movdqu(const Address& dst, XmmRegister src);
+
   void addss(XmmRegister dst, XmmRegister src);
   void addss(XmmRegister dst, const Address& src);
   void subss(XmmRegister dst, XmmRegister src);
@@ -462,6 +465,9 @@ class X86_64Assembler FINAL : public Assembler {
   void sqrtsd(XmmRegister dst, XmmRegister src);
   void sqrtss(XmmRegister dst, XmmRegister src);
 
+  void pcmpeqw(XmmRegister dst, XmmRegister src);
+  void pmovmskb(CpuRegister dst, XmmRegister src);
+
   void xorpd(XmmRegister dst, const Address& src);
   void xorpd(XmmRegister dst, XmmRegister src);
   void xorps(XmmRegister dst, const Address& src);
@@ -669,7 +675,11 @@ class X86_64Assembler FINAL : public Assembler {
   void repe_cmpsw();
   void repe_cmpsl();
   void repe_cmpsq();
+  void rep_movsb();
   void rep_movsw();
+  void rep_movsl();
+  void rep_stosb();
+  void rep_stosl();
 
   //
   // Macros for High-level operations.
@@ -960,12 +960,36 @@ TEST_F(AssemblerX86_64Test, RepneScasw) {
   DriverStr(expected, "repne_scasw");
 }
 
+TEST_F(AssemblerX86_64Test, RepMovsb) {
+  GetAssembler()->rep_movsb();
+  const char* expected = "rep movsb\n";
+  DriverStr(expected, "rep_movsb");
+}
+
 TEST_F(AssemblerX86_64Test, RepMovsw) {
   GetAssembler()->rep_movsw();
   const char* expected = "rep movsw\n";
   DriverStr(expected, "rep_movsw");
 }
 
+TEST_F(AssemblerX86_64Test, RepMovsl) {
+  GetAssembler()->rep_movsl();
+  const char* expected = "rep movsl\n";
+  DriverStr(expected, "rep_movsl");
+}
+
+TEST_F(AssemblerX86_64Test, RepStosb) {
+  GetAssembler()->rep_stosb();
+  const char* expected = "rep stosb\n";
+  DriverStr(expected, "rep_stosb");
+}
+
+TEST_F(AssemblerX86_64Test, RepStosl) {
+  GetAssembler()->rep_stosl();
+  const char* expected = "rep stosl\n";
+  DriverStr(expected, "rep_stosl");
+}
+
 TEST_F(AssemblerX86_64Test, Movsxd) {
   DriverStr(RepeatRr(&x86_64::X86_64Assembler::movsxd, "movsxd %{reg2}, %{reg1}"), "movsxd");
 }
@@ -994,6 +1018,32 @@ TEST_F(AssemblerX86_64Test, Movd2) {
   DriverStr(RepeatRF(&x86_64::X86_64Assembler::movd, "movd %{reg2}, %{reg1}"), "movd.2");
 }
 
+TEST_F(AssemblerX86_64Test, Movdqu) {
+  GetAssembler()->movdqu(x86_64::XmmRegister(x86_64::XMM0), x86_64::Address(
+      x86_64::CpuRegister(x86_64::RDI), x86_64::CpuRegister(x86_64::RBX), x86_64::TIMES_1, 12));
+  GetAssembler()->movdqu(x86_64::XmmRegister(x86_64::XMM9), x86_64::Address(
+      x86_64::CpuRegister(x86_64::R13), x86_64::CpuRegister(x86_64::R9), x86_64::TIMES_1, 12));
+  GetAssembler()->movdqu(x86_64::Address(x86_64::CpuRegister(x86_64::RSP), 16),
+                         x86_64::XmmRegister(x86_64::XMM1));
+  GetAssembler()->movdqu(x86_64::Address(x86_64::CpuRegister(x86_64::R8), 0),
+                         x86_64::XmmRegister(x86_64::XMM15));
+  const char* expected =
+    "movdqu 0xc(%RDI,%RBX,1), %xmm0\n"
+    "movdqu 0xc(%R13,%R9,1), %xmm9\n"
+    "movdqu %xmm1, 0x10(%RSP)\n"
+    "movdqu %xmm15, (%R8)\n";
+
+  DriverStr(expected, "movdqu");
+}
+
+TEST_F(AssemblerX86_64Test, Pcmpeqw) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::pcmpeqw, "pcmpeqw %{reg2}, %{reg1}"), "pcmpeqw");
+}
+
+TEST_F(AssemblerX86_64Test, Pmovmskb) {
+  DriverStr(RepeatrF(&x86_64::X86_64Assembler::pmovmskb, "pmovmskb %{reg2}, %{reg1}"), "pmovmskb");
+}
+
 TEST_F(AssemblerX86_64Test, Addss) {
   DriverStr(RepeatFF(&x86_64::X86_64Assembler::addss, "addss %{reg2}, %{reg1}"), "addss");
 }
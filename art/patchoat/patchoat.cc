@@ -46,6 +46,7 @@
 #include "runtime.h"
 #include "scoped_thread_state_change.h"
 #include "thread.h"
+#include "thread_pool.h"
 #include "utils.h"
 
 namespace art {
@@ -154,6 +155,7 @@ bool PatchOat::Patch(const std::string& image_location,
                      off_t delta,
                      const std::string& output_directory,
                      InstructionSet isa,
+                     size_t thread_count,
                      TimingLogger* timings) {
   CHECK(Runtime::Current() == nullptr);
   CHECK(!image_location.empty()) << "image file must have a filename.";
@@ -178,6 +180,11 @@ bool PatchOat::Patch(const std::string& image_location,
   // Runtime::Create acquired the mutator_lock_ that is normally given away when we Runtime::Start,
   // give it away now and then switch to a more manageable ScopedObjectAccess.
   Thread::Current()->TransitionFromRunnableToSuspended(kNative);
+  // The calling thread also works on the tasks, so the pool needs one thread less.
+  std::unique_ptr<ThreadPool> thread_pool;
+  if (thread_count > 1u) {
+    thread_pool.reset(new ThreadPool("Patchoat thread pool", thread_count - 1u));
+  }
   ScopedObjectAccess soa(Thread::Current());
 
   t.NewTiming("Image and oat Patching setup");
@@ -292,7 +299,7 @@ bool PatchOat::Patch(const std::string& image_location,
       LOG(ERROR) << "Failed to patch oat file " << input_oat_file->GetPath();
       return false;
     }
-    if (!p.PatchImage(i == 0)) {
+    if (!p.PatchImage(i == 0, thread_pool.get())) {
       LOG(ERROR) << "Failed to patch image file " << input_image_filename;
       return false;
     }
@@ -627,7 +634,53 @@ void PatchOat::PatchDexFileArrays(mirror::ObjectArray<mirror::Object>* img_roots
   }
 }
 
-bool PatchOat::PatchImage(bool primary_image) {
+class PatchObjectsTask : public SelfDeletingTask {
+ public:
+  PatchObjectsTask(PatchOat* patch_oat, uintptr_t begin, uintptr_t end)
+      : patch_oat_(patch_oat), begin_(begin), end_(end) {}
+
+  // The heap_bitmap_lock_ is held by the thread waiting for the tasks and the bitmap is not
+  // modified while patching.
+  void Run(Thread* self) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    ScopedObjectAccess soa(self);
+    PatchOat* const patch_oat = patch_oat_;
+    patch_oat->bitmap_->VisitMarkedRange(
+        begin_,
+        end_,
+        [patch_oat](mirror::Object* obj) NO_THREAD_SAFETY_ANALYSIS {
+          patch_oat->VisitObject(obj);
+        });
+  }
+
+ private:
+  PatchOat* const patch_oat_;
+  const uintptr_t begin_;
+  const uintptr_t end_;
+};
+
+void PatchOat::PatchObjects(ThreadPool* thread_pool) {
+  if (thread_pool == nullptr) {
+    bitmap_->Walk(PatchOat::BitmapCallback, this);
+    return;
+  }
+  // Each object is only written to its own copy, so the objects can be patched in any order.
+  // Vtables and method arrays that are shared between classes may be fixed up by more than one
+  // task, but always with the same values. Use several chunks per thread to balance the load.
+  Thread* self = Thread::Current();
+  const size_t num_chunks = (thread_pool->GetThreadCount() + 1u) * 4u;
+  const uintptr_t begin = bitmap_->HeapBegin();
+  const uintptr_t end = static_cast<uintptr_t>(bitmap_->HeapLimit());
+  const size_t chunk_size = RoundUp((end - begin + num_chunks - 1u) / num_chunks, kPageSize);
+  for (uintptr_t chunk_begin = begin; chunk_begin < end; chunk_begin += chunk_size) {
+    uintptr_t chunk_end = std::min(chunk_begin + chunk_size, end);
+    thread_pool->AddTask(self, new PatchObjectsTask(this, chunk_begin, chunk_end));
+  }
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, /* do_work */ true, /* may_hold_locks */ true);
+  thread_pool->StopWorkers(self);
+}
+
+bool PatchOat::PatchImage(bool primary_image, ThreadPool* thread_pool) {
   ImageHeader* image_header = reinterpret_cast<ImageHeader*>(image_->Begin());
   CHECK_GT(image_->Size(), sizeof(ImageHeader));
   // These are the roots from the original file.
@@ -655,7 +708,7 @@ bool PatchOat::PatchImage(bool primary_image) {
     TimingLogger::ScopedTiming t("Walk Bitmap", timings_);
     // Walk the bitmap.
     WriterMutexLock mu(Thread::Current(), *Locks::heap_bitmap_lock_);
-    bitmap_->Walk(PatchOat::BitmapCallback, this);
+    PatchObjects(thread_pool);
   }
   return true;
 }
@@ -936,6 +989,10 @@ NO_RETURN static void Usage(const char *fmt, ...) {
   UsageError("");
   UsageError("  --no-lock-output: Do not attempt to obtain a flock on output oat file.");
   UsageError("");
+  UsageError("  -j<number>: specifies the number of threads used for patching image objects.");
+  UsageError("      Example: -j4");
+  UsageError("      Default: number of CPUs");
+  UsageError("");
   UsageError("  --dump-timings: dump out patch timing information");
   UsageError("");
   UsageError("  --no-dump-timings: do not dump out patch timing information");
@@ -978,6 +1035,7 @@ static int patchoat_image(TimingLogger& timings,
                           const std::string& output_image_filename,
                           off_t base_delta,
                           bool base_delta_set,
+                          size_t thread_count,
                           bool debug) {
   CHECK(!input_image_location.empty());
   if (output_image_filename.empty()) {
@@ -1002,7 +1060,12 @@ static int patchoat_image(TimingLogger& timings,
 
   std::string output_directory =
       output_image_filename.substr(0, output_image_filename.find_last_of("/"));
-  bool ret = PatchOat::Patch(input_image_location, base_delta, output_directory, isa, &timings);
+  bool ret = PatchOat::Patch(input_image_location,
+                             base_delta,
+                             output_directory,
+                             isa,
+                             thread_count,
+                             &timings);
 
   if (kIsDebugBuild) {
     LOG(INFO) << "Exiting with return ... " << ret;
@@ -1252,6 +1315,7 @@ static int patchoat(int argc, char **argv) {
   std::string patched_image_location;
   bool dump_timings = kIsDebugBuild;
   bool lock_output = true;
+  size_t thread_count = static_cast<size_t>(sysconf(_SC_NPROCESSORS_CONF));
 
   for (int i = 0; i < argc; ++i) {
     const StringPiece option(argv[i]);
@@ -1324,6 +1388,11 @@ static int patchoat(int argc, char **argv) {
       lock_output = true;
     } else if (option == "--no-lock-output") {
       lock_output = false;
+    } else if (option.starts_with("-j")) {
+      const char* thread_count_str = option.substr(strlen("-j")).data();
+      if (!ParseUint(thread_count_str, &thread_count) || thread_count == 0u) {
+        Usage("Failed to parse -j argument '%s' as a positive integer", thread_count_str);
+      }
     } else if (option == "--dump-timings") {
       dump_timings = true;
     } else if (option == "--no-dump-timings") {
@@ -1346,6 +1415,7 @@ static int patchoat(int argc, char **argv) {
                          output_image_filename,
                          base_delta,
                          base_delta_set,
+                         thread_count,
                          debug);
   } else {
     ret = patchoat_oat(timings,
@@ -33,6 +33,7 @@ namespace art {
 class ArtMethod;
 class ImageHeader;
 class OatHeader;
+class ThreadPool;
 
 namespace mirror {
 class Object;
@@ -52,11 +53,12 @@ class PatchOat {
   static bool Patch(const std::string& art_location, off_t delta, File* art_out, InstructionSet isa,
                     TimingLogger* timings);
 
-  // Patch both the image and the oat file
+  // Patch both the image and the oat file. Objects are patched on thread_count threads.
   static bool Patch(const std::string& art_location,
                     off_t delta,
                     const std::string& output_directory,
                     InstructionSet isa,
+                    size_t thread_count,
                     TimingLogger* timings);
 
   ~PatchOat() {}
@@ -114,7 +116,11 @@ class PatchOat {
   template <typename ElfFileImpl>
   bool PatchOatHeader(ElfFileImpl* oat_file);
 
-  bool PatchImage(bool primary_image) SHARED_REQUIRES(Locks::mutator_lock_);
+  // If thread_pool is not null, the objects are patched in parallel on its workers.
+  bool PatchImage(bool primary_image, ThreadPool* thread_pool)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+  void PatchObjects(ThreadPool* thread_pool) SHARED_REQUIRES(Locks::mutator_lock_)
+      REQUIRES(Locks::heap_bitmap_lock_);
   void PatchArtFields(const ImageHeader* image_header) SHARED_REQUIRES(Locks::mutator_lock_);
   void PatchArtMethods(const ImageHeader* image_header) SHARED_REQUIRES(Locks::mutator_lock_);
   void PatchImtConflictTables(const ImageHeader* image_header)
@@ -225,6 +231,7 @@ class PatchOat {
   TimingLogger* timings_;
 
   friend class FixupRootVisitor;
+  friend class PatchObjectsTask;
   friend class RelocatedPointerVisitor;
   friend class PatchOatArtFieldVisitor;
   friend class PatchOatArtMethodVisitor;
@@ -1223,8 +1223,9 @@ TEST_F(StubTest, StringCompareTo) {
   const char* c[] = { "", "", "a", "aa", "ab",
       "aacaacaacaacaacaac",  // This one's under the default limit to go to __memcmp16.
       "aacaacaacaacaacaacaacaacaacaacaacaac",     // This one's over.
-      "aacaacaacaacaacaacaacaacaacaacaacaaca" };  // As is this one. We need a separate one to
+      "aacaacaacaacaacaacaacaacaacaacaacaaca",    // As is this one. We need a separate one to
                                                   // defeat object-equal optimizations.
+      "aacaacabaacaacaacaacaacaacaacaacaac" };    // Differs within the first 8 chars.
   static constexpr size_t kStringCount = arraysize(c);
 
   StackHandleScope<kStringCount> hs(self);
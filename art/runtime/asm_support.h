@@ -151,8 +151,16 @@ ADD_TEST_EQ(THREAD_DEFAULT_IBASE_OFFSET,
 #define THREAD_ALT_IBASE_OFFSET (THREAD_LOCAL_POS_OFFSET + 4 * __SIZEOF_POINTER__)
 ADD_TEST_EQ(THREAD_ALT_IBASE_OFFSET,
             art::Thread::MterpAltIBaseOffset<__SIZEOF_POINTER__>().Int32Value())
+// Offset of field Thread::tlsPtr_.interpreter_cache.
+#define THREAD_INTERPRETER_CACHE_OFFSET (THREAD_LOCAL_POS_OFFSET + 5 * __SIZEOF_POINTER__)
+ADD_TEST_EQ(THREAD_INTERPRETER_CACHE_OFFSET,
+            art::Thread::InterpreterCacheOffset<__SIZEOF_POINTER__>().Int32Value())
+// Log2 of the number of {key, value} entries in the interpreter cache.
+#define INTERPRETER_CACHE_SIZE_LOG2 8
+ADD_TEST_EQ(static_cast<size_t>(1U << INTERPRETER_CACHE_SIZE_LOG2),
+            art::interpreter::InterpreterCache::kSize)
 // Offset of field Thread::tlsPtr_.rosalloc_runs.
-#define THREAD_ROSALLOC_RUNS_OFFSET (THREAD_LOCAL_POS_OFFSET + 5 * __SIZEOF_POINTER__)
+#define THREAD_ROSALLOC_RUNS_OFFSET (THREAD_LOCAL_POS_OFFSET + 6 * __SIZEOF_POINTER__)
 ADD_TEST_EQ(THREAD_ROSALLOC_RUNS_OFFSET,
             art::Thread::RosAllocRunsOffset<__SIZEOF_POINTER__>().Int32Value())
 // Offset of field Thread::tlsPtr_.thread_local_alloc_stack_top.
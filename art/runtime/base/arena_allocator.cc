@@ -15,8 +15,11 @@
  */
 
 #include <algorithm>
+#include <functional>
 #include <iomanip>
+#include <limits>
 #include <numeric>
+#include <vector>
 
 #include "arena_allocator.h"
 #include "logging.h"
@@ -24,6 +27,7 @@
 #include "mutex.h"
 #include "thread-inl.h"
 #include "systrace.h"
+#include "utils.h"
 
 namespace art {
 
@@ -157,7 +161,7 @@ void ArenaAllocatorMemoryTool::DoMakeInaccessible(void* ptr, size_t size) {
   MEMORY_TOOL_MAKE_NOACCESS(ptr, size);
 }
 
-Arena::Arena() : bytes_allocated_(0), next_(nullptr) {
+Arena::Arena() : bytes_allocated_(0), next_(nullptr), free_sequence_(0u) {
 }
 
 MallocArena::MallocArena(size_t size) {
@@ -177,6 +181,13 @@ MemMapArena::MemMapArena(size_t size, bool low_4gb, const char* name) {
   CHECK(map_.get() != nullptr) << error_msg;
   memory_ = map_->Begin();
   size_ = map_->Size();
+#ifdef MADV_HUGEPAGE
+  // Large arenas, such as the ones of the dex2oat verifier and compiler for huge methods, take
+  // far fewer page faults when backed by transparent huge pages. This is only a hint.
+  if (size_ >= kHugeArenaSize) {
+    madvise(memory_, size_, MADV_HUGEPAGE);
+  }
+#endif
 }
 
 MemMapArena::~MemMapArena() {
@@ -200,9 +211,14 @@ void Arena::Reset() {
 ArenaPool::ArenaPool(bool use_malloc, bool low_4gb, const char* name)
     : use_malloc_(use_malloc),
       lock_("Arena pool lock", kArenaPoolLock),
-      free_arenas_(nullptr),
       low_4gb_(low_4gb),
-      name_(name) {
+      name_(name),
+      next_free_sequence_(0u),
+      num_new_arenas_(0u),
+      new_arena_bytes_(0u),
+      num_reused_arenas_(0u),
+      num_stolen_arenas_(0u),
+      num_contended_locks_(0u) {
   if (low_4gb) {
     CHECK(!use_malloc) << "low4gb must use map implementation";
   }
@@ -216,31 +232,110 @@ ArenaPool::~ArenaPool() {
 }
 
 void ArenaPool::ReclaimMemory() {
-  while (free_arenas_ != nullptr) {
-    auto* arena = free_arenas_;
-    free_arenas_ = free_arenas_->next_;
-    delete arena;
+  for (FreeList& list : free_lists_) {
+    while (list.arenas_ != nullptr) {
+      auto* arena = list.arenas_;
+      list.arenas_ = list.arenas_->next_;
+      delete arena;
+    }
   }
 }
 
 void ArenaPool::LockReclaimMemory() {
-  MutexLock lock(Thread::Current(), lock_);
-  ReclaimMemory();
+  Thread* self = Thread::Current();
+  MutexLock pool_lock(self, lock_);
+  for (FreeList& list : free_lists_) {
+    Arena* arenas;
+    {
+      MutexLock lock(self, list.lock_);
+      arenas = list.arenas_;
+      list.arenas_ = nullptr;
+    }
+    while (arenas != nullptr) {
+      auto* arena = arenas;
+      arenas = arenas->next_;
+      delete arena;
+    }
+  }
+}
+
+size_t ArenaPool::FreeListIndex(Thread* self) {
+  if (LIKELY(self != nullptr)) {
+    // Thin lock ids are small, cached in the Thread, and consecutive for threads created
+    // together such as the compiler workers.
+    return self->GetThreadId() & (kNumFreeLists - 1);
+  }
+  // Threads that are not attached to the runtime do not use arenas on hot paths.
+  return static_cast<size_t>(GetTid()) & (kNumFreeLists - 1);
+}
+
+void ArenaPool::LockFreeList(Thread* self, FreeList* list) const {
+  if (!list->lock_.ExclusiveTryLock(self)) {
+    num_contended_locks_.FetchAndAddRelaxed(1u);
+    list->lock_.ExclusiveLock(self);
+  }
+}
+
+Arena* ArenaPool::TakeFreeArena(Thread* self, FreeList* list, size_t size) {
+  LockFreeList(self, list);
+  Arena* ret = list->arenas_;
+  if (ret != nullptr && LIKELY(ret->Size() >= size)) {
+    list->arenas_ = ret->next_;
+  } else {
+    ret = nullptr;
+  }
+  list->lock_.ExclusiveUnlock(self);
+  return ret;
+}
+
+Arena* ArenaPool::TakeMostRecentFreeArena(Thread* self, size_t skip_index, size_t size) {
+  while (true) {
+    // Free lists are LIFO, so only the first arena of each list needs to be looked at.
+    FreeList* best_list = nullptr;
+    uint64_t best_sequence = 0u;
+    for (size_t i = 0; i != kNumFreeLists; ++i) {
+      FreeList* list = &free_lists_[i];
+      if (i == skip_index) {
+        continue;
+      }
+      MutexLock lock(self, list->lock_);
+      Arena* arena = list->arenas_;
+      if (arena != nullptr && arena->Size() >= size &&
+          (best_list == nullptr || arena->free_sequence_ > best_sequence)) {
+        best_list = list;
+        best_sequence = arena->free_sequence_;
+      }
+    }
+    if (best_list == nullptr) {
+      return nullptr;
+    }
+    MutexLock lock(self, best_list->lock_);
+    Arena* arena = best_list->arenas_;
+    if (arena != nullptr && arena->free_sequence_ == best_sequence) {
+      best_list->arenas_ = arena->next_;
+      return arena;
+    }
+    // Another thread took or freed an arena in the meantime, look again.
+  }
 }
 
 Arena* ArenaPool::AllocArena(size_t size) {
   Thread* self = Thread::Current();
-  Arena* ret = nullptr;
-  {
-    MutexLock lock(self, lock_);
-    if (free_arenas_ != nullptr && LIKELY(free_arenas_->Size() >= size)) {
-      ret = free_arenas_;
-      free_arenas_ = free_arenas_->next_;
+  const size_t own_index = FreeListIndex(self);
+  Arena* ret = TakeFreeArena(self, &free_lists_[own_index], size);
+  if (ret == nullptr) {
+    ret = TakeMostRecentFreeArena(self, own_index, size);
+    if (ret != nullptr) {
+      num_stolen_arenas_.FetchAndAddRelaxed(1u);
     }
   }
   if (ret == nullptr) {
     ret = use_malloc_ ? static_cast<Arena*>(new MallocArena(size)) :
         new MemMapArena(size, low_4gb_, name_);
+    num_new_arenas_.FetchAndAddRelaxed(1u);
+    new_arena_bytes_.FetchAndAddRelaxed(ret->Size());
+  } else {
+    num_reused_arenas_.FetchAndAddRelaxed(1u);
   }
   ret->Reset();
   return ret;
@@ -250,18 +345,49 @@ void ArenaPool::TrimMaps() {
   if (!use_malloc_) {
     ScopedTrace trace(__PRETTY_FUNCTION__);
     // Doesn't work for malloc.
-    MutexLock lock(Thread::Current(), lock_);
-    for (auto* arena = free_arenas_; arena != nullptr; arena = arena->next_) {
-      arena->Release();
+    Thread* self = Thread::Current();
+    MutexLock pool_lock(self, lock_);
+    // Keep a bounded warm set of the most recently freed arenas so that the next user, typically
+    // the next JIT compilation, does not fault in fresh pages. The lists cannot be locked all at
+    // once, so first find the oldest arena to keep, then release the older ones.
+    std::vector<std::pair<uint64_t, size_t>> free_arenas;
+    for (FreeList& list : free_lists_) {
+      MutexLock lock(self, list.lock_);
+      for (Arena* arena = list.arenas_; arena != nullptr; arena = arena->next_) {
+        free_arenas.push_back(std::make_pair(arena->free_sequence_, arena->Size()));
+      }
+    }
+    std::sort(free_arenas.begin(), free_arenas.end(), std::greater<std::pair<uint64_t, size_t>>());
+    uint64_t oldest_warm_sequence = std::numeric_limits<uint64_t>::max();
+    size_t warm_bytes = 0u;
+    for (const std::pair<uint64_t, size_t>& free_arena : free_arenas) {
+      if (warm_bytes + free_arena.second > kWarmArenaBytes) {
+        break;
+      }
+      warm_bytes += free_arena.second;
+      oldest_warm_sequence = free_arena.first;
+    }
+    // Arenas freed since the first pass are more recent and kept as well.
+    for (FreeList& list : free_lists_) {
+      MutexLock lock(self, list.lock_);
+      for (Arena* arena = list.arenas_; arena != nullptr; arena = arena->next_) {
+        if (arena->free_sequence_ < oldest_warm_sequence) {
+          arena->Release();
+        }
+      }
     }
   }
 }
 
 size_t ArenaPool::GetBytesAllocated() const {
   size_t total = 0;
-  MutexLock lock(Thread::Current(), lock_);
-  for (Arena* arena = free_arenas_; arena != nullptr; arena = arena->next_) {
-    total += arena->GetBytesAllocated();
+  Thread* self = Thread::Current();
+  MutexLock pool_lock(self, lock_);
+  for (FreeList& list : free_lists_) {
+    MutexLock lock(self, list.lock_);
+    for (Arena* arena = list.arenas_; arena != nullptr; arena = arena->next_) {
+      total += arena->GetBytesAllocated();
+    }
   }
   return total;
 }
@@ -273,17 +399,35 @@ void ArenaPool::FreeArenaChain(Arena* first) {
     }
   }
   if (first != nullptr) {
+    size_t count = 1u;
     Arena* last = first;
     while (last->next_ != nullptr) {
       last = last->next_;
+      ++count;
+    }
+    // Number the arenas so that the first one of the chain, which ends up first in the free
+    // list, is the most recent.
+    const uint64_t sequence = next_free_sequence_.FetchAndAddRelaxed(count);
+    for (Arena* arena = first; arena != nullptr; arena = arena->next_) {
+      arena->free_sequence_ = sequence + --count;
     }
     Thread* self = Thread::Current();
-    MutexLock lock(self, lock_);
-    last->next_ = free_arenas_;
-    free_arenas_ = first;
+    FreeList* list = &free_lists_[FreeListIndex(self)];
+    LockFreeList(self, list);
+    last->next_ = list->arenas_;
+    list->arenas_ = first;
+    list->lock_.ExclusiveUnlock(self);
   }
 }
 
+void ArenaPool::DumpStats(std::ostream& os) const {
+  os << "Arena pool: new arenas: " << num_new_arenas_.LoadRelaxed()
+     << " (" << new_arena_bytes_.LoadRelaxed() << " bytes never used before)"
+     << ", reused arenas: " << num_reused_arenas_.LoadRelaxed()
+     << ", taken from another thread: " << num_stolen_arenas_.LoadRelaxed()
+     << ", contended free list locks: " << num_contended_locks_.LoadRelaxed() << "\n";
+}
+
 size_t ArenaAllocator::BytesAllocated() const {
   return ArenaAllocatorStats::BytesAllocated();
 }
@@ -389,23 +533,27 @@ bool ArenaAllocator::Contains(const void* ptr) const {
 }
 
 MemStats::MemStats(const char* name, const ArenaAllocatorStats* stats, const Arena* first_arena,
-                   ssize_t lost_bytes_adjustment)
+                   ssize_t lost_bytes_adjustment, const ArenaPool* pool)
     : name_(name),
       stats_(stats),
       first_arena_(first_arena),
-      lost_bytes_adjustment_(lost_bytes_adjustment) {
+      lost_bytes_adjustment_(lost_bytes_adjustment),
+      pool_(pool) {
 }
 
 void MemStats::Dump(std::ostream& os) const {
   os << name_ << " stats:\n";
   stats_->Dump(os, first_arena_, lost_bytes_adjustment_);
+  if (pool_ != nullptr) {
+    pool_->DumpStats(os);
+  }
 }
 
 // Dump memory usage stats.
 MemStats ArenaAllocator::GetMemStats() const {
   ssize_t lost_bytes_adjustment =
       (arena_head_ == nullptr) ? 0 : (end_ - ptr_) - arena_head_->RemainingSpace();
-  return MemStats("ArenaAllocator", this, arena_head_, lost_bytes_adjustment);
+  return MemStats("ArenaAllocator", this, arena_head_, lost_bytes_adjustment, pool_);
 }
 
 }  // namespace art
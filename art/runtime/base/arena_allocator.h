@@ -20,6 +20,7 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#include "atomic.h"
 #include "base/bit_utils.h"
 #include "base/memory_tool.h"
 #include "debug_stack.h"
@@ -228,6 +229,8 @@ class Arena {
   uint8_t* memory_;
   size_t size_;
   Arena* next_;
+  // Order in which the arena was last returned to the pool, higher is more recent.
+  uint64_t free_sequence_;
   friend class ArenaPool;
   friend class ArenaAllocator;
   friend class ArenaStack;
@@ -248,6 +251,9 @@ class MallocArena FINAL : public Arena {
 
 class MemMapArena FINAL : public Arena {
  public:
+  // Arenas of at least this size are advised to use transparent huge pages.
+  static constexpr size_t kHugeArenaSize = 2 * MB;
+
   MemMapArena(size_t size, bool low_4gb, const char* name);
   virtual ~MemMapArena();
   void Release() OVERRIDE;
@@ -268,15 +274,57 @@ class ArenaPool {
   void ReclaimMemory() NO_THREAD_SAFETY_ANALYSIS;
   void LockReclaimMemory() REQUIRES(!lock_);
   // Trim the maps in arenas by madvising, used by JIT to reduce memory usage. This only works
-  // use_malloc is false.
+  // use_malloc is false. Up to kWarmArenaBytes of the most recently freed arenas are kept.
   void TrimMaps() REQUIRES(!lock_);
+  void DumpStats(std::ostream& os) const;
 
  private:
+  // Free arenas are kept in several lists, each with its own lock, so that the threads of a
+  // parallel compilation do not all contend on a single lock. A thread allocates from and frees
+  // to the list selected by its thin lock id, and only looks at the other lists when its own has
+  // no suitable arena.
+  static constexpr size_t kNumFreeLists = 8;
+  static_assert(IsPowerOfTwo(kNumFreeLists), "kNumFreeLists must be a power of two");
+  // Bytes of free arenas that TrimMaps does not release.
+  static constexpr size_t kWarmArenaBytes = 2 * Arena::kDefaultSize;
+
+  struct FreeList {
+    FreeList() : lock_("Arena pool free list lock", kArenaPoolFreeListLock), arenas_(nullptr) {}
+
+    Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+    Arena* arenas_ GUARDED_BY(lock_);
+  };
+
+  static size_t FreeListIndex(Thread* self);
+
+  // Lock the list, counting the times it was held by another thread.
+  void LockFreeList(Thread* self, FreeList* list) const ACQUIRE(list->lock_);
+
+  // Pop the first arena of the list if it has at least size bytes.
+  Arena* TakeFreeArena(Thread* self, FreeList* list, size_t size) REQUIRES(!list->lock_);
+  // Pop the most recently freed arena with at least size bytes from the lists other than the
+  // one at skip_index. Its pages are the most likely not to have been released by TrimMaps.
+  Arena* TakeMostRecentFreeArena(Thread* self, size_t skip_index, size_t size);
+
   const bool use_malloc_;
+  // Serializes the operations that walk all the free lists. It is taken before the locks of the
+  // free lists, which AllocArena and FreeArenaChain take on their own.
   mutable Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
-  Arena* free_arenas_ GUARDED_BY(lock_);
+  mutable FreeList free_lists_[kNumFreeLists];
   const bool low_4gb_;
   const char* name_;
+  // Source of Arena::free_sequence_.
+  Atomic<uint64_t> next_free_sequence_;
+
+  // Pool statistics for MemStats.
+  Atomic<size_t> num_new_arenas_;
+  Atomic<size_t> new_arena_bytes_;
+  Atomic<size_t> num_reused_arenas_;
+  // Arenas taken from the free list of another thread.
+  Atomic<size_t> num_stolen_arenas_;
+  // Free list locks that were held by another thread when taken.
+  mutable Atomic<size_t> num_contended_locks_;
+
   DISALLOW_COPY_AND_ASSIGN(ArenaPool);
 };
 
@@ -387,7 +435,7 @@ class ArenaAllocator
 class MemStats {
  public:
   MemStats(const char* name, const ArenaAllocatorStats* stats, const Arena* first_arena,
-           ssize_t lost_bytes_adjustment = 0);
+           ssize_t lost_bytes_adjustment = 0, const ArenaPool* pool = nullptr);
   void Dump(std::ostream& os) const;
 
  private:
@@ -395,6 +443,7 @@ class MemStats {
   const ArenaAllocatorStats* const stats_;
   const Arena* const first_arena_;
   const ssize_t lost_bytes_adjustment_;
+  const ArenaPool* const pool_;
 };  // MemStats
 
 }  // namespace art
@@ -18,6 +18,9 @@
 #include "base/arena_bit_vector.h"
 #include "gtest/gtest.h"
 
+#include <memory>
+#include <thread>
+
 namespace art {
 
 class ArenaAllocatorTest : public testing::Test {
@@ -124,4 +127,43 @@ TEST_F(ArenaAllocatorTest, LargeAllocations) {
   }
 }
 
+TEST_F(ArenaAllocatorTest, ReuseArenaFreedByOtherThread) {
+  ArenaPool pool;
+  void* other_thread_alloc = nullptr;
+  std::thread other_thread([&pool, &other_thread_alloc]() {
+    ArenaAllocator arena(&pool);
+    other_thread_alloc = arena.Alloc(Arena::kDefaultSize / 2);
+  });
+  other_thread.join();
+  ASSERT_TRUE(other_thread_alloc != nullptr);
+  // The arena is on the free list of the other thread but is still found by this one.
+  ArenaAllocator arena(&pool);
+  void* alloc = arena.Alloc(Arena::kDefaultSize / 2);
+  ASSERT_EQ(other_thread_alloc, alloc);
+  ASSERT_EQ(1u, NumberOfArenas(&arena));
+}
+
+TEST_F(ArenaAllocatorTest, TrimMapsKeepsMostRecentlyFreedArenas) {
+  ArenaPool pool(/* use_malloc */ false);
+  // Keep all the arenas in use at the same time, so that none of them is reused, then free them
+  // in order.
+  static constexpr size_t kNumArenas = 6u;
+  std::unique_ptr<ArenaAllocator> arenas[kNumArenas];
+  uint8_t* allocs[kNumArenas];
+  for (size_t i = 0; i != kNumArenas; ++i) {
+    arenas[i].reset(new ArenaAllocator(&pool));
+    allocs[i] = arenas[i]->AllocArray<uint8_t>(Arena::kDefaultSize / 2);
+    allocs[i][0] = 1u;
+  }
+  for (size_t i = 0; i != kNumArenas; ++i) {
+    ASSERT_NE(allocs[i], allocs[(i + 1) % kNumArenas]);
+    arenas[i].reset();
+  }
+  pool.TrimMaps();
+  // Only the last two arenas freed are still warm, the others read back as zero.
+  for (size_t i = 0; i != kNumArenas; ++i) {
+    EXPECT_EQ(i + 2u >= kNumArenas ? 1u : 0u, allocs[i][0]) << i;
+  }
+}
+
 }  // namespace art
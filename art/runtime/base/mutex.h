@@ -78,6 +78,7 @@ enum LockLevel {
   kJitDebugInterfaceLock,
   kAllocSpaceLock,
   kBumpPointerSpaceBlockLock,
+  kArenaPoolFreeListLock,
   kArenaPoolLock,
   kDexFileMethodInlinerLock,
   kDexFileToMethodInlinerMapLock,
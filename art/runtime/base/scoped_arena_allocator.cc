@@ -49,7 +49,7 @@ void ArenaStack::Reset() {
 MemStats ArenaStack::GetPeakStats() const {
   DebugStackRefCounter::CheckNoRefs();
   return MemStats("ArenaStack peak", static_cast<const TaggedStats<Peak>*>(&stats_and_pool_),
-                  bottom_arena_);
+                  bottom_arena_, /* lost_bytes_adjustment */ 0, stats_and_pool_.pool);
 }
 
 uint8_t* ArenaStack::AllocateFromNextArena(size_t rounded_bytes) {
@@ -23,28 +23,36 @@ namespace art {
 
 template<class Visitor>
 void ClassTable::VisitRoots(Visitor& visitor) {
-  ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    for (GcRoot<mirror::Class>& root : class_set) {
-      visitor.VisitRoot(root.AddressWithoutBarrier());
-    }
-  }
-  for (GcRoot<mirror::Object>& root : strong_roots_) {
-    visitor.VisitRoot(root.AddressWithoutBarrier());
-  }
+  VisitRootsInternal(visitor);
 }
 
 template<class Visitor>
 void ClassTable::VisitRoots(const Visitor& visitor) {
+  VisitRootsInternal(visitor);
+}
+
+template<class Visitor>
+void ClassTable::VisitRootsInternal(Visitor& visitor) {
   ReaderMutexLock mu(Thread::Current(), lock_);
+  // Every class in the lookup index is also in a class set, so only the class set roots are
+  // visited. The index slots of the classes that the visitor moved are updated afterwards.
+  std::unordered_map<mirror::Class*, mirror::Class*> moved_classes;
   for (ClassSet& class_set : classes_) {
     for (GcRoot<mirror::Class>& root : class_set) {
+      mirror::Class* const old_klass = root.Read<kWithoutReadBarrier>();
       visitor.VisitRoot(root.AddressWithoutBarrier());
+      mirror::Class* const new_klass = root.Read<kWithoutReadBarrier>();
+      if (UNLIKELY(new_klass != old_klass)) {
+        moved_classes.emplace(old_klass, new_klass);
+      }
     }
   }
   for (GcRoot<mirror::Object>& root : strong_roots_) {
     visitor.VisitRoot(root.AddressWithoutBarrier());
   }
+  if (!moved_classes.empty()) {
+    IndexUpdateMovedClasses(moved_classes);
+  }
 }
 
 template <typename Visitor>
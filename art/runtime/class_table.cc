@@ -17,13 +17,23 @@
 #include "class_table.h"
 
 #include "mirror/class-inl.h"
+#include "utils.h"
 
 namespace art {
 
+// Minimum capacity of the lookup index, must be a power of two.
+static constexpr size_t kMinIndexCapacity = 64u;
+
+static_assert(sizeof(Atomic<GcRoot<mirror::Class>>) == sizeof(GcRoot<mirror::Class>),
+              "Index slot roots are accessed as atomics");
+
 ClassTable::ClassTable() : lock_("Class loader classes", kClassLoaderClassesLock) {
   Runtime* const runtime = Runtime::Current();
   classes_.push_back(ClassSet(runtime->GetHashTableMinLoadFactor(),
                               runtime->GetHashTableMaxLoadFactor()));
+  indexes_.emplace_back(new Index(kMinIndexCapacity));
+  index_.StoreRelaxed(indexes_.back().get());
+  num_unindexed_sets_.StoreRelaxed(0u);
 }
 
 void ClassTable::FreezeSnapshot() {
@@ -55,6 +65,7 @@ mirror::Class* ClassTable::LookupByDescriptor(mirror::Class* klass) {
 
 mirror::Class* ClassTable::UpdateClass(const char* descriptor, mirror::Class* klass, size_t hash) {
   WriterMutexLock mu(Thread::Current(), lock_);
+  IndexClassSets();
   // Should only be updating latest table.
   auto existing_it = classes_.back().FindWithHash(descriptor, hash);
   if (kIsDebugBuild && existing_it == classes_.back().end()) {
@@ -74,6 +85,7 @@ mirror::Class* ClassTable::UpdateClass(const char* descriptor, mirror::Class* kl
   // Update the element in the hash set with the new class. This is safe to do since the descriptor
   // doesn't change.
   *existing_it = GcRoot<mirror::Class>(klass);
+  IndexReplace(existing, klass, hash);
   return existing;
 }
 
@@ -92,38 +104,154 @@ size_t ClassTable::NumNonZygoteClasses() const {
 }
 
 mirror::Class* ClassTable::Lookup(const char* descriptor, size_t hash) {
-  ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    auto it = class_set.FindWithHash(descriptor, hash);
-    if (it != class_set.end()) {
-     return it->Read();
+  if (UNLIKELY(num_unindexed_sets_.LoadAcquire() != 0u)) {
+    WriterMutexLock mu(Thread::Current(), lock_);
+    IndexClassSets();
+  }
+  return IndexLookup(descriptor, hash);
+}
+
+mirror::Class* ClassTable::IndexLookup(const char* descriptor, size_t hash) {
+  const Index* const index = index_.LoadAcquire();
+  const uint32_t index_hash = IndexHash(hash);
+  for (size_t i = index_hash & index->mask; ; i = (i + 1u) & index->mask) {
+    const IndexSlot& slot = index->slots[i];
+    const uint32_t slot_hash = slot.hash.LoadAcquire();
+    if (slot_hash == 0u) {
+      return nullptr;
+    }
+    if (slot_hash == index_hash) {
+      GcRoot<mirror::Class> root = slot.LoadRootAcquire();
+      if (!root.IsNull()) {
+        mirror::Class* const klass = root.Read();
+        if (klass->DescriptorEquals(descriptor)) {
+          return klass;
+        }
+      }
     }
   }
-  return nullptr;
 }
 
 void ClassTable::Insert(mirror::Class* klass) {
+  const size_t hash = ClassDescriptorHashEquals()(GcRoot<mirror::Class>(klass));
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.back().Insert(GcRoot<mirror::Class>(klass));
+  IndexClassSets();
+  classes_.back().InsertWithHash(GcRoot<mirror::Class>(klass), hash);
+  IndexInsert(klass, hash);
 }
 
 void ClassTable::InsertWithHash(mirror::Class* klass, size_t hash) {
   WriterMutexLock mu(Thread::Current(), lock_);
+  IndexClassSets();
   classes_.back().InsertWithHash(GcRoot<mirror::Class>(klass), hash);
+  IndexInsert(klass, hash);
 }
 
 bool ClassTable::Remove(const char* descriptor) {
+  const size_t hash = ComputeModifiedUtf8Hash(descriptor);
   WriterMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    auto it = class_set.Find(descriptor);
-    if (it != class_set.end()) {
-      class_set.Erase(it);
+  IndexClassSets();
+  for (auto set_it = classes_.begin(); set_it != classes_.end(); ++set_it) {
+    auto it = set_it->FindWithHash(descriptor, hash);
+    if (it != set_it->end()) {
+      mirror::Class* const removed = it->Read();
+      set_it->Erase(it);
+      // A class with the same descriptor in a later set is no longer shadowed by the removed one.
+      mirror::Class* next = nullptr;
+      for (auto next_it = set_it + 1; next_it != classes_.end() && next == nullptr; ++next_it) {
+        auto found = next_it->FindWithHash(descriptor, hash);
+        if (found != next_it->end()) {
+          next = found->Read();
+        }
+      }
+      IndexReplace(removed, next, hash);
       return true;
     }
   }
   return false;
 }
 
+void ClassTable::IndexInsert(mirror::Class* klass, size_t hash) {
+  Index* index = indexes_.back().get();
+  // Keep the load factor, including removed classes, at or below 3/4.
+  if ((index->num_used + 1u) * 4u > (index->mask + 1u) * 3u) {
+    IndexGrow();
+    index = indexes_.back().get();
+  }
+  const uint32_t index_hash = IndexHash(hash);
+  size_t i = index_hash & index->mask;
+  while (index->slots[i].hash.LoadRelaxed() != 0u) {
+    i = (i + 1u) & index->mask;
+  }
+  // Publish the root before the hash, readers skip the slot until they see the hash.
+  index->slots[i].StoreRootRelease(klass);
+  index->slots[i].hash.StoreRelease(index_hash);
+  ++index->num_used;
+}
+
+void ClassTable::IndexReplace(mirror::Class* old_klass, mirror::Class* new_klass, size_t hash) {
+  Index* const index = indexes_.back().get();
+  const uint32_t index_hash = IndexHash(hash);
+  for (size_t i = index_hash & index->mask;
+       index->slots[i].hash.LoadRelaxed() != 0u;
+       i = (i + 1u) & index->mask) {
+    IndexSlot& slot = index->slots[i];
+    if (slot.hash.LoadRelaxed() == index_hash && !slot.root.IsNull() &&
+        slot.root.Read() == old_klass) {
+      // A removed class keeps its hash so that probe sequences going through it stay intact.
+      slot.StoreRootRelease(new_klass);
+      return;
+    }
+  }
+  LOG(FATAL) << "Class not found in lookup index " << PrettyClass(old_klass);
+}
+
+void ClassTable::IndexUpdateMovedClasses(
+    const std::unordered_map<mirror::Class*, mirror::Class*>& moved_classes) {
+  Index* const index = indexes_.back().get();
+  for (size_t i = 0; i <= index->mask; ++i) {
+    IndexSlot& slot = index->slots[i];
+    mirror::Class* const klass = slot.root.Read<kWithoutReadBarrier>();
+    if (klass != nullptr) {
+      auto it = moved_classes.find(klass);
+      if (it != moved_classes.end()) {
+        slot.StoreRootRelease(it->second);
+      }
+    }
+  }
+}
+
+void ClassTable::IndexGrow() {
+  const Index* const old_index = indexes_.back().get();
+  size_t num_live = 0u;
+  for (size_t i = 0; i <= old_index->mask; ++i) {
+    if (!old_index->slots[i].root.IsNull()) {
+      ++num_live;
+    }
+  }
+  // Only double the capacity if removed classes do not account for the lack of free slots.
+  const size_t old_capacity = old_index->mask + 1u;
+  const size_t new_capacity =
+      (num_live * 2u >= old_capacity) ? old_capacity * 2u : old_capacity;
+  DCHECK_LE((num_live + 1u) * 4u, new_capacity * 3u);
+  std::unique_ptr<Index> new_index(new Index(new_capacity));
+  for (size_t i = 0; i <= old_index->mask; ++i) {
+    const IndexSlot& old_slot = old_index->slots[i];
+    if (!old_slot.root.IsNull()) {
+      const uint32_t index_hash = old_slot.hash.LoadRelaxed();
+      size_t j = index_hash & new_index->mask;
+      while (new_index->slots[j].hash.LoadRelaxed() != 0u) {
+        j = (j + 1u) & new_index->mask;
+      }
+      new_index->slots[j].root = old_slot.root;
+      new_index->slots[j].hash.StoreRelaxed(index_hash);
+    }
+  }
+  new_index->num_used = num_live;
+  index_.StoreRelease(new_index.get());
+  indexes_.push_back(std::move(new_index));
+}
+
 uint32_t ClassTable::ClassDescriptorHashEquals::operator()(const GcRoot<mirror::Class>& root)
     const {
   std::string temp;
@@ -180,13 +308,39 @@ size_t ClassTable::WriteToMemory(uint8_t* ptr) const {
 
 size_t ClassTable::ReadFromMemory(uint8_t* ptr) {
   size_t read_count = 0;
-  AddClassSet(ClassSet(ptr, /*make copy*/false, &read_count));
+  WriterMutexLock mu(Thread::Current(), lock_);
+  // Do not read the roots here, they may not be relocated yet.
+  classes_.insert(classes_.begin(), ClassSet(ptr, /*make copy*/false, &read_count));
+  num_unindexed_sets_.StoreRelease(num_unindexed_sets_.LoadRelaxed() + 1u);
   return read_count;
 }
 
 void ClassTable::AddClassSet(ClassSet&& set) {
   WriterMutexLock mu(Thread::Current(), lock_);
   classes_.insert(classes_.begin(), std::move(set));
+  num_unindexed_sets_.StoreRelease(num_unindexed_sets_.LoadRelaxed() + 1u);
+  IndexClassSets();
+}
+
+void ClassTable::IndexClassSets() {
+  size_t num_unindexed_sets = num_unindexed_sets_.LoadRelaxed();
+  // Sets closer to the front are searched first, so index them last: their classes shadow the
+  // indexed classes with the same descriptor.
+  std::string temp;
+  while (num_unindexed_sets != 0u) {
+    --num_unindexed_sets;
+    for (const GcRoot<mirror::Class>& root : classes_[num_unindexed_sets]) {
+      mirror::Class* const klass = root.Read();
+      const size_t hash = ClassDescriptorHashEquals()(root);
+      mirror::Class* const existing = IndexLookup(klass->GetDescriptor(&temp), hash);
+      if (existing != nullptr) {
+        IndexReplace(existing, klass, hash);
+      } else {
+        IndexInsert(klass, hash);
+      }
+    }
+  }
+  num_unindexed_sets_.StoreRelease(0u);
 }
 
 void ClassTable::ClearStrongRoots() {
@@ -17,10 +17,13 @@
 #ifndef ART_RUNTIME_CLASS_TABLE_H_
 #define ART_RUNTIME_CLASS_TABLE_H_
 
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "atomic.h"
 #include "base/allocator.h"
 #include "base/hash_set.h"
 #include "base/macros.h"
@@ -110,7 +113,8 @@ class ClassTable {
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
-  // Return the first class that matches the descriptor. Returns null if there are none.
+  // Return the first class that matches the descriptor. Returns null if there are none. Does not
+  // acquire lock_, see Index.
   mirror::Class* Lookup(const char* descriptor, size_t hash)
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
@@ -143,7 +147,9 @@ class ClassTable {
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
-  // Read a table from ptr and put it at the front of the class set.
+  // Read a table from ptr and put it at the front of the class set. The roots of the table may
+  // still need to be relocated (see ImageSpace), so its classes are only added to the lookup
+  // index by the first lookup or modification of the table.
   size_t ReadFromMemory(uint8_t* ptr)
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
@@ -163,6 +169,91 @@ class ClassTable {
   }
 
  private:
+  // A slot of the lookup index. A zero hash marks an empty slot, a non zero hash with a null root
+  // marks a removed class.
+  struct IndexSlot {
+    // Replacing a class stores a new root while readers may be probing the slot, so the root is
+    // only read and written atomically. The GC still visits it in place.
+    GcRoot<mirror::Class> LoadRootAcquire() const {
+      return reinterpret_cast<const Atomic<GcRoot<mirror::Class>>*>(&root)->LoadAcquire();
+    }
+
+    void StoreRootRelease(mirror::Class* klass) SHARED_REQUIRES(Locks::mutator_lock_) {
+      reinterpret_cast<Atomic<GcRoot<mirror::Class>>*>(&root)->StoreRelease(
+          GcRoot<mirror::Class>(klass));
+    }
+
+    Atomic<uint32_t> hash;
+    GcRoot<mirror::Class> root;
+  };
+
+  // A merged open addressing index over the classes of all the class sets. Storing the descriptor
+  // hash next to the class lets a lookup do a single probe sequence (instead of one per snapshot)
+  // that only compares descriptors on full hash matches. Slots are only added or removed with
+  // lock_ held exclusively but the index is read without any lock: a slot is published by
+  // storing its hash last with release semantics, and a grown index is published with a release
+  // store to index_.
+  // Readers never reach a suspend point while probing, but a reader may still be probing a
+  // retired index when it is replaced, so retired indexes are kept until the table is deleted.
+  // Growing doubles the capacity, so the indexes retired that way take less memory than the
+  // current one. Rebuilding an index to drop removed classes keeps the capacity and retires an
+  // index of the same size each time. Only the image writer removes classes, when it prunes
+  // them, so this does not happen in a running app.
+  // The GC only updates the roots of the current index, a retired index may point to classes
+  // which have since moved.
+  struct Index {
+    explicit Index(size_t capacity)
+        : mask(capacity - 1u), num_used(0u), slots(new IndexSlot[capacity]) {}
+
+    const size_t mask;
+    // Number of non empty slots, including removed classes.
+    size_t num_used;
+    std::unique_ptr<IndexSlot[]> slots;
+  };
+
+  static uint32_t IndexHash(size_t hash) {
+    // Zero is reserved for empty slots.
+    uint32_t index_hash = static_cast<uint32_t>(hash);
+    return (index_hash != 0u) ? index_hash : 1u;
+  }
+
+  template<class Visitor>
+  void VisitRootsInternal(Visitor& visitor)
+      NO_THREAD_SAFETY_ANALYSIS
+      REQUIRES(!lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Does not require lock_, see Index.
+  mirror::Class* IndexLookup(const char* descriptor, size_t hash)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Add the classes of the class sets which are not indexed yet to the lookup index.
+  void IndexClassSets()
+      REQUIRES(lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  void IndexInsert(mirror::Class* klass, size_t hash)
+      REQUIRES(lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Replace old_klass with new_klass, or remove old_klass if new_klass is null.
+  void IndexReplace(mirror::Class* old_klass, mirror::Class* new_klass, size_t hash)
+      REQUIRES(lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Point the slots of the current index at the new addresses of moved classes. Only the root
+  // of a slot changes, so holding lock_ shared is enough.
+  void IndexUpdateMovedClasses(
+      const std::unordered_map<mirror::Class*, mirror::Class*>& moved_classes)
+      SHARED_REQUIRES(lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Rehash the live classes into a new index, doubling the capacity unless enough slots are
+  // freed by dropping removed classes.
+  void IndexGrow()
+      REQUIRES(lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
   // Lock to guard inserting and removing.
   mutable ReaderWriterMutex lock_;
   // We have a vector to help prevent dirty pages after the zygote forks by calling FreezeSnapshot.
@@ -171,6 +262,12 @@ class ClassTable {
   // loader which may not be owned by the class loader must be held strongly live. Also dex caches
   // are held live to prevent them being unloading once they have classes in them.
   std::vector<GcRoot<mirror::Object>> strong_roots_ GUARDED_BY(lock_);
+  // All the lookup indexes allocated so far, the last one is the current one.
+  std::vector<std::unique_ptr<Index>> indexes_ GUARDED_BY(lock_);
+  // The current lookup index, read by Lookup without holding lock_.
+  Atomic<Index*> index_;
+  // The number of class sets at the front of classes_ which are not in the lookup index yet.
+  Atomic<size_t> num_unindexed_sets_;
 };
 
 }  // namespace art
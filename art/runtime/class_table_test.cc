@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "class_table.h"
+
+#include <memory>
+#include <vector>
+
+#include "class_linker-inl.h"
+#include "class_table-inl.h"
+#include "common_runtime_test.h"
+#include "handle_scope-inl.h"
+#include "mirror/class-inl.h"
+#include "mirror/class_loader.h"
+#include "scoped_thread_state_change.h"
+#include "utils.h"
+
+namespace art {
+
+// Moves the roots it visits by a fixed offset, like the relocation of an app image.
+class RelocateRootVisitor {
+ public:
+  explicit RelocateRootVisitor(intptr_t delta) : delta_(delta) {}
+
+  void VisitRootIfNonNull(mirror::CompressedReference<mirror::Object>* root) const
+      SHARED_REQUIRES(Locks::mutator_lock_) {
+    if (!root->IsNull()) {
+      VisitRoot(root);
+    }
+  }
+
+  void VisitRoot(mirror::CompressedReference<mirror::Object>* root) const
+      SHARED_REQUIRES(Locks::mutator_lock_) {
+    uint8_t* ref = reinterpret_cast<uint8_t*>(root->AsMirrorPtr());
+    root->Assign(reinterpret_cast<mirror::Object*>(ref + delta_));
+  }
+
+ private:
+  const intptr_t delta_;
+};
+
+// Moves one class to another address, like a moving GC, and counts the roots it visits.
+class MoveClassRootVisitor {
+ public:
+  MoveClassRootVisitor(mirror::Class* from, mirror::Class* to) : from_(from), to_(to) {}
+
+  void VisitRootIfNonNull(mirror::CompressedReference<mirror::Object>* root)
+      SHARED_REQUIRES(Locks::mutator_lock_) {
+    if (!root->IsNull()) {
+      VisitRoot(root);
+    }
+  }
+
+  void VisitRoot(mirror::CompressedReference<mirror::Object>* root)
+      SHARED_REQUIRES(Locks::mutator_lock_) {
+    ++num_visited_;
+    if (root->AsMirrorPtr() == from_) {
+      root->Assign(to_);
+    }
+  }
+
+  size_t NumVisited() const {
+    return num_visited_;
+  }
+
+ private:
+  mirror::Class* const from_;
+  mirror::Class* const to_;
+  size_t num_visited_ = 0u;
+};
+
+class CollectBootClassesVisitor : public ClassVisitor {
+ public:
+  CollectBootClassesVisitor(std::vector<mirror::Class*>* classes, size_t count)
+      : classes_(classes), count_(count) {}
+
+  bool operator()(mirror::Class* klass) OVERRIDE SHARED_REQUIRES(Locks::mutator_lock_) {
+    if (klass->GetClassLoader() == nullptr && !klass->IsTemp() && !klass->IsRetired()) {
+      classes_->push_back(klass);
+    }
+    return classes_->size() < count_;
+  }
+
+ private:
+  std::vector<mirror::Class*>* const classes_;
+  const size_t count_;
+};
+
+class ClassTableTest : public CommonRuntimeTest {
+ protected:
+  // Collects some boot classes, enough to make the lookup index grow a few times.
+  void GetBootClasses(std::vector<mirror::Class*>* classes, size_t count)
+      SHARED_REQUIRES(Locks::mutator_lock_) {
+    CollectBootClassesVisitor visitor(classes, count);
+    class_linker_->VisitClasses(&visitor);
+  }
+
+  static mirror::Class* Lookup(ClassTable* table, mirror::Class* klass)
+      SHARED_REQUIRES(Locks::mutator_lock_) {
+    std::string temp;
+    const char* descriptor = klass->GetDescriptor(&temp);
+    return table->Lookup(descriptor, ComputeModifiedUtf8Hash(descriptor));
+  }
+};
+
+TEST_F(ClassTableTest, InsertAndLookup) {
+  ScopedObjectAccess soa(Thread::Current());
+  std::vector<mirror::Class*> classes;
+  GetBootClasses(&classes, 500u);
+  ASSERT_EQ(500u, classes.size());
+
+  ClassTable table;
+  for (mirror::Class* klass : classes) {
+    EXPECT_TRUE(Lookup(&table, klass) == nullptr);
+    table.Insert(klass);
+    EXPECT_EQ(klass, Lookup(&table, klass));
+  }
+  // The index grew while the classes were inserted, all of them must still be found.
+  for (mirror::Class* klass : classes) {
+    EXPECT_EQ(klass, Lookup(&table, klass));
+  }
+  EXPECT_TRUE(table.Lookup("LDoesNotExist;", ComputeModifiedUtf8Hash("LDoesNotExist;")) ==
+              nullptr);
+
+  // Removed classes are no longer found, the others still are.
+  for (size_t i = 0; i < classes.size(); i += 2) {
+    std::string temp;
+    EXPECT_TRUE(table.Remove(classes[i]->GetDescriptor(&temp)));
+  }
+  for (size_t i = 0; i < classes.size(); ++i) {
+    EXPECT_EQ((i % 2 == 0) ? nullptr : classes[i], Lookup(&table, classes[i]));
+  }
+}
+
+TEST_F(ClassTableTest, Replace) {
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<2> hs(soa.Self());
+  // Two loaders of the same dex file define two different classes with the same descriptor.
+  Handle<mirror::ClassLoader> loader1(
+      hs.NewHandle(soa.Decode<mirror::ClassLoader*>(LoadDex("XandY"))));
+  Handle<mirror::ClassLoader> loader2(
+      hs.NewHandle(soa.Decode<mirror::ClassLoader*>(LoadDex("XandY"))));
+  mirror::Class* x1 = class_linker_->FindClass(soa.Self(), "LX;", loader1);
+  ASSERT_TRUE(x1 != nullptr);
+  mirror::Class* x2 = class_linker_->FindClass(soa.Self(), "LX;", loader2);
+  ASSERT_TRUE(x2 != nullptr);
+  ASSERT_NE(x1, x2);
+
+  ClassTable table;
+  table.Insert(x1);
+  EXPECT_EQ(x1, Lookup(&table, x1));
+
+  // A class set added in front shadows the classes with the same descriptor.
+  ClassTable::ClassSet set;
+  set.Insert(GcRoot<mirror::Class>(x2));
+  table.AddClassSet(std::move(set));
+  EXPECT_EQ(x2, Lookup(&table, x1));
+
+  // Removing the shadowing class makes the shadowed one visible again.
+  EXPECT_TRUE(table.Remove("LX;"));
+  EXPECT_EQ(x1, Lookup(&table, x1));
+  EXPECT_TRUE(table.Remove("LX;"));
+  EXPECT_TRUE(Lookup(&table, x1) == nullptr);
+  EXPECT_FALSE(table.Remove("LX;"));
+}
+
+TEST_F(ClassTableTest, LookupAfterUpdateClass) {
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::ClassLoader> loader(
+      hs.NewHandle(soa.Decode<mirror::ClassLoader*>(LoadDex("XandY"))));
+  // Classes with embedded tables are first inserted as temporary classes, which the class linker
+  // then replaces with UpdateClass().
+  mirror::Class* x = class_linker_->FindClass(soa.Self(), "LX;", loader);
+  ASSERT_TRUE(x != nullptr);
+  mirror::Class* y = class_linker_->FindClass(soa.Self(), "LY;", loader);
+  ASSERT_TRUE(y != nullptr);
+  EXPECT_FALSE(x->IsTemp());
+  EXPECT_FALSE(y->IsTemp());
+
+  ClassTable* table = loader->GetClassTable();
+  ASSERT_TRUE(table != nullptr);
+  EXPECT_EQ(x, Lookup(table, x));
+  EXPECT_EQ(y, Lookup(table, y));
+}
+
+TEST_F(ClassTableTest, LookupAfterReadFromMemory) {
+  ScopedObjectAccess soa(Thread::Current());
+  std::vector<mirror::Class*> classes;
+  GetBootClasses(&classes, 200u);
+  ASSERT_EQ(200u, classes.size());
+
+  ClassTable table;
+  for (mirror::Class* klass : classes) {
+    table.Insert(klass);
+  }
+  const size_t size = table.WriteToMemory(nullptr);
+  std::unique_ptr<uint8_t[]> buffer(new uint8_t[size]);
+  ASSERT_EQ(size, table.WriteToMemory(buffer.get()));
+
+  // Make the serialized roots point to where the classes would be before relocation. They must
+  // not be read until they are fixed up.
+  const intptr_t delta = static_cast<intptr_t>(kPageSize);
+  {
+    size_t read_count;
+    ClassTable::ClassSet set(buffer.get(), /*make copy*/false, &read_count);
+    RelocateRootVisitor unrelocate(-delta);
+    for (GcRoot<mirror::Class>& root : set) {
+      unrelocate.VisitRoot(root.AddressWithoutBarrier());
+    }
+  }
+
+  ClassTable temp_table;
+  EXPECT_EQ(size, temp_table.ReadFromMemory(buffer.get()));
+  RelocateRootVisitor relocate(delta);
+  temp_table.VisitRoots(relocate);
+  for (mirror::Class* klass : classes) {
+    EXPECT_EQ(klass, Lookup(&temp_table, klass));
+  }
+}
+
+TEST_F(ClassTableTest, VisitRootsUpdatesIndex) {
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<2> hs(soa.Self());
+  Handle<mirror::ClassLoader> loader1(
+      hs.NewHandle(soa.Decode<mirror::ClassLoader*>(LoadDex("XandY"))));
+  Handle<mirror::ClassLoader> loader2(
+      hs.NewHandle(soa.Decode<mirror::ClassLoader*>(LoadDex("XandY"))));
+  mirror::Class* x1 = class_linker_->FindClass(soa.Self(), "LX;", loader1);
+  ASSERT_TRUE(x1 != nullptr);
+  mirror::Class* x2 = class_linker_->FindClass(soa.Self(), "LX;", loader2);
+  ASSERT_TRUE(x2 != nullptr);
+  mirror::Class* y1 = class_linker_->FindClass(soa.Self(), "LY;", loader1);
+  ASSERT_TRUE(y1 != nullptr);
+
+  ClassTable table;
+  table.Insert(x1);
+  table.Insert(y1);
+  EXPECT_EQ(x1, Lookup(&table, x1));
+
+  // Each class is a single root even though it is in both a class set and the lookup index.
+  // Moving x1 to where x2 is (they have the same descriptor) must also move it in the index.
+  MoveClassRootVisitor visitor(x1, x2);
+  table.VisitRoots(visitor);
+  EXPECT_EQ(2u, visitor.NumVisited());
+  EXPECT_EQ(x2, Lookup(&table, x1));
+  EXPECT_EQ(y1, Lookup(&table, y1));
+  EXPECT_TRUE(table.Contains(x2));
+}
+
+}  // namespace art
@@ -16,9 +16,17 @@
 
 #include "allocation_record.h"
 
+#include <algorithm>
+#include <cmath>
+#include <map>
+
 #include "art_method-inl.h"
 #include "base/stl_util.h"
+#include "base/time_utils.h"
+#include "scoped_thread_state_change.h"
 #include "stack.h"
+#include "thread_list.h"
+#include "utils.h"
 
 #ifdef __ANDROID__
 #include "cutils/properties.h"
@@ -88,9 +96,33 @@ void AllocRecordObjectMap::SetProperties() {
       max_stack_depth_ = value;
     }
   }
+  // Check whether there's a system property asking to only record a sample of the allocations,
+  // one every <value> allocated bytes on average. 524288 keeps the overhead low enough to leave
+  // the tracker on for a whole app session.
+  propertyName = "dalvik.vm.allocTrackerSampleInterval";
+  char sampleIntervalString[PROPERTY_VALUE_MAX];
+  if (property_get(propertyName, sampleIntervalString, "") > 0) {
+    char* end;
+    size_t value = strtoul(sampleIntervalString, &end, 10);
+    if (*end != '\0') {
+      LOG(ERROR) << "Ignoring  " << propertyName << " '" << sampleIntervalString
+                 << "' --- invalid";
+    } else {
+      sample_interval_ = value;
+    }
+  }
 #endif
 }
 
+void AllocRecordObjectMap::SetSampleInterval(size_t sample_interval) {
+  DCHECK(!Runtime::Current()->GetHeap()->IsAllocTrackingEnabled());
+  sample_interval_ = sample_interval;
+}
+
+static void ResetAllocTrackerSampling(Thread* thread, void* arg ATTRIBUTE_UNUSED) {
+  thread->SetAllocTrackerBytesUntilSample(0u);
+}
+
 AllocRecordObjectMap::~AllocRecordObjectMap() {
   Clear();
 }
@@ -101,16 +133,15 @@ void AllocRecordObjectMap::VisitRoots(RootVisitor* visitor) {
   size_t count = recent_record_max_;
   // Only visit the last recent_record_max_ number of allocation records in entries_ and mark the
   // klass_ fields as strong roots.
-  for (auto it = entries_.rbegin(), end = entries_.rend(); it != end; ++it) {
-    AllocRecord& record = it->second;
-    if (count > 0) {
-      buffered_visitor.VisitRootIfNonNull(record.GetClassGcRoot());
-      --count;
-    }
-    // Visit all of the stack frames to make sure no methods in the stack traces get unloaded by
-    // class unloading.
-    for (size_t i = 0, depth = record.GetDepth(); i < depth; ++i) {
-      const AllocRecordStackTraceElement& element = record.StackElement(i);
+  for (auto it = entries_.rbegin(), end = entries_.rend(); it != end && count > 0; ++it, --count) {
+    buffered_visitor.VisitRootIfNonNull(it->second.GetClassGcRoot());
+  }
+  // Visit all of the stack frames to make sure no methods in the stack traces get unloaded by
+  // class unloading. Each distinct trace only needs to be visited once.
+  for (const auto& pair : stack_traces_) {
+    const AllocRecordStackTrace& trace = pair.first;
+    for (size_t i = 0, depth = trace.GetDepth(); i < depth; ++i) {
+      const AllocRecordStackTraceElement& element = trace.GetStackElement(i);
       DCHECK(element.GetMethod() != nullptr);
       element.GetMethod()->VisitRoots(buffered_visitor, sizeof(void*));
     }
@@ -151,6 +182,7 @@ void AllocRecordObjectMap::SweepAllocationRecords(IsMarkedVisitor* visitor) {
         SweepClassObject(&record, visitor);
         ++it;
       } else {
+        ReleaseStackTrace(record.GetStackTrace());
         it = entries_.erase(it);
         ++count_deleted;
       }
@@ -237,6 +269,15 @@ void AllocRecordObjectMap::SetAllocTrackingEnabled(bool enable) {
       LOG(INFO) << "Enabling alloc tracker (" << records->alloc_record_max_ << " entries of "
                 << records->max_stack_depth_ << " frames, taking up to "
                 << PrettySize(sz * records->alloc_record_max_) << ")";
+      if (records->sample_interval_ != 0) {
+        LOG(INFO) << "Sampling one allocation every " << PrettySize(records->sample_interval_)
+                  << " on average";
+      }
+    }
+    {
+      // Make every thread draw its distance to the next sample with the current interval.
+      MutexLock mu(self, *Locks::thread_list_lock_);
+      Runtime::Current()->GetThreadList()->ForEach(ResetAllocTrackerSampling, nullptr);
     }
     Runtime::Current()->GetInstrumentation()->InstrumentQuickAllocEntryPoints();
     {
@@ -261,9 +302,46 @@ void AllocRecordObjectMap::SetAllocTrackingEnabled(bool enable) {
   }
 }
 
+size_t AllocRecordObjectMap::NextSampleDistance(Thread* self) const {
+  DCHECK_NE(sample_interval_, 0u);
+  // The distance between two samples of a Poisson process is exponentially distributed. Use a
+  // xorshift of the time and thread as the uniform source, this only needs to be cheap.
+  uint64_t x = NanoTime() ^ (static_cast<uint64_t>(self->GetTid()) << 32);
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  x *= UINT64_C(2685821657736338717);
+  // Uniform in (0, 1].
+  double u = (static_cast<double>(x >> 11) + 1.0) / static_cast<double>(UINT64_C(1) << 53);
+  return static_cast<size_t>(-std::log(u) * static_cast<double>(sample_interval_)) + 1u;
+}
+
+bool AllocRecordObjectMap::ShouldSample(Thread* self, size_t byte_count) const {
+  if (sample_interval_ == 0) {
+    return true;
+  }
+  // Each thread counts down its own distance, so that unsampled allocations do not touch any
+  // shared cache line. The distance is memoryless, so a new one is drawn after each sample.
+  size_t bytes_until_sample = self->GetAllocTrackerBytesUntilSample();
+  if (UNLIKELY(bytes_until_sample == 0u)) {
+    bytes_until_sample = NextSampleDistance(self);
+  }
+  if (LIKELY(byte_count < bytes_until_sample)) {
+    self->SetAllocTrackerBytesUntilSample(bytes_until_sample - byte_count);
+    return false;
+  }
+  self->SetAllocTrackerBytesUntilSample(NextSampleDistance(self));
+  return true;
+}
+
 void AllocRecordObjectMap::RecordAllocation(Thread* self,
                                             mirror::Object** obj,
                                             size_t byte_count) {
+  // Skip unsampled allocations before paying for the stack walk.
+  if (!ShouldSample(self, byte_count)) {
+    return;
+  }
+
   // Get stack trace outside of lock in case there are allocations during the stack walk.
   // b/27858645.
   AllocRecordStackTrace trace;
@@ -304,12 +382,85 @@ void AllocRecordObjectMap::RecordAllocation(Thread* self,
   trace.SetTid(self->GetTid());
 
   // Add the record.
-  Put(*obj, AllocRecord(byte_count, (*obj)->GetClass(), std::move(trace)));
+  Put(*obj, AllocRecord(byte_count, (*obj)->GetClass(), InternStackTrace(std::move(trace))));
   DCHECK_LE(Size(), alloc_record_max_);
 }
 
 void AllocRecordObjectMap::Clear() {
   entries_.clear();
+  stack_traces_.clear();
+}
+
+const AllocRecordStackTrace* AllocRecordObjectMap::InternStackTrace(
+    AllocRecordStackTrace&& trace) {
+  auto it = stack_traces_.emplace(std::move(trace), 0u).first;
+  ++it->second;
+  return &it->first;
+}
+
+void AllocRecordObjectMap::ReleaseStackTrace(const AllocRecordStackTrace* trace) {
+  auto it = stack_traces_.find(*trace);
+  DCHECK(it != stack_traces_.end());
+  DCHECK_EQ(&it->first, trace);
+  DCHECK_NE(it->second, 0u);
+  if (--it->second == 0u) {
+    stack_traces_.erase(it);
+  }
+}
+
+void AllocRecordObjectMap::DumpSampledHeapProfile(std::ostream& os) {
+  Thread* self = Thread::Current();
+  ScopedObjectAccess soa(self);
+  MutexLock mu(self, *Locks::alloc_tracker_lock_);
+  Heap* heap = Runtime::Current()->GetHeap();
+  AllocRecordObjectMap* records = heap->GetAllocationRecords();
+  if (!heap->IsAllocTrackingEnabled() || records == nullptr || records->sample_interval_ == 0) {
+    return;
+  }
+  struct SiteStats {
+    size_t count = 0;
+    size_t bytes = 0;
+    double estimated_bytes = 0.0;
+  };
+  // Interned traces can be compared by address.
+  std::map<const AllocRecordStackTrace*, SiteStats> sites;
+  const double interval = static_cast<double>(records->sample_interval_);
+  size_t total_count = 0;
+  double total_estimated_bytes = 0.0;
+  for (const EntryPair& entry : records->entries_) {
+    if (entry.first.Read() == nullptr) {
+      continue;  // Freed, only kept for the recent allocation list.
+    }
+    const AllocRecord& record = entry.second;
+    const double size = static_cast<double>(record.ByteCount());
+    // An allocation of this size is sampled with probability 1 - exp(-size / interval).
+    const double estimate = size / -std::expm1(-size / interval);
+    SiteStats& stats = sites[record.GetStackTrace()];
+    ++stats.count;
+    stats.bytes += record.ByteCount();
+    stats.estimated_bytes += estimate;
+    ++total_count;
+    total_estimated_bytes += estimate;
+  }
+  typedef std::pair<const AllocRecordStackTrace*, SiteStats> Site;
+  std::vector<Site> sorted(sites.begin(), sites.end());
+  std::sort(sorted.begin(), sorted.end(), [](const Site& lhs, const Site& rhs) {
+    return lhs.second.estimated_bytes > rhs.second.estimated_bytes;
+  });
+  os << "Sampled heap profile: " << total_count << " live samples in " << sorted.size()
+     << " sites, estimated " << PrettySize(static_cast<size_t>(total_estimated_bytes))
+     << " live (sample interval " << records->sample_interval_ << " bytes)\n";
+  for (const auto& site : sorted) {
+    const AllocRecordStackTrace* trace = site.first;
+    os << "  " << PrettySize(static_cast<size_t>(site.second.estimated_bytes)) << " estimated, "
+       << site.second.count << " samples of " << site.second.bytes << " bytes, thread "
+       << trace->GetTid() << "\n";
+    for (size_t i = 0, depth = trace->GetDepth(); i < depth; ++i) {
+      const AllocRecordStackTraceElement& element = trace->GetStackElement(i);
+      os << "    at " << PrettyMethod(element.GetMethod()) << " line "
+         << element.ComputeLineNumber() << "\n";
+    }
+  }
 }
 
 AllocRecordObjectMap::AllocRecordObjectMap()
@@ -19,6 +19,8 @@
 
 #include <list>
 #include <memory>
+#include <ostream>
+#include <unordered_map>
 
 #include "base/mutex.h"
 #include "object_callbacks.h"
@@ -154,16 +156,17 @@ template <typename T> struct EqAllocRecordTypesPtr {
 
 class AllocRecord {
  public:
-  // All instances of AllocRecord should be managed by an instance of AllocRecordObjectMap.
-  AllocRecord(size_t count, mirror::Class* klass, AllocRecordStackTrace&& trace)
-      : byte_count_(count), klass_(klass), trace_(std::move(trace)) {}
+  // All instances of AllocRecord should be managed by an instance of AllocRecordObjectMap, which
+  // also owns the (interned) stack trace.
+  AllocRecord(size_t count, mirror::Class* klass, const AllocRecordStackTrace* trace)
+      : byte_count_(count), klass_(klass), trace_(trace) {}
 
   size_t GetDepth() const {
-    return trace_.GetDepth();
+    return trace_->GetDepth();
   }
 
   const AllocRecordStackTrace* GetStackTrace() const {
-    return &trace_;
+    return trace_;
   }
 
   size_t ByteCount() const {
@@ -171,7 +174,7 @@ class AllocRecord {
   }
 
   pid_t GetTid() const {
-    return trace_.GetTid();
+    return trace_->GetTid();
   }
 
   mirror::Class* GetClass() const SHARED_REQUIRES(Locks::mutator_lock_) {
@@ -186,15 +189,16 @@ class AllocRecord {
   }
 
   const AllocRecordStackTraceElement& StackElement(size_t index) const {
-    return trace_.GetStackElement(index);
+    return trace_->GetStackElement(index);
   }
 
  private:
   const size_t byte_count_;
   // The klass_ could be a strong or weak root for GC
   GcRoot<mirror::Class> klass_;
-  // TODO: Share between alloc records with identical stack traces.
-  AllocRecordStackTrace trace_;
+  // Shared between alloc records with identical stack traces, see
+  // AllocRecordObjectMap::InternStackTrace().
+  const AllocRecordStackTrace* trace_;
 };
 
 class AllocRecordObjectMap {
@@ -208,7 +212,8 @@ class AllocRecordObjectMap {
   typedef std::list<EntryPair> EntryList;
 
   // Caller needs to check that it is enabled before calling since we read the stack trace before
-  // checking the enabled boolean.
+  // checking the enabled boolean. If a sample interval is set, only a sample of the allocations
+  // is recorded and the others return before walking the stack.
   void RecordAllocation(Thread* self,
                         mirror::Object** obj,
                         size_t byte_count)
@@ -217,13 +222,24 @@ class AllocRecordObjectMap {
 
   static void SetAllocTrackingEnabled(bool enabled) REQUIRES(!Locks::alloc_tracker_lock_);
 
+  // Dump the sampled live objects aggregated by allocation site, with the sampled sizes scaled
+  // up to an estimate of the total live bytes. Does nothing unless sampled allocation tracking
+  // is enabled.
+  static void DumpSampledHeapProfile(std::ostream& os) REQUIRES(!Locks::alloc_tracker_lock_);
+
   AllocRecordObjectMap() REQUIRES(Locks::alloc_tracker_lock_);
   ~AllocRecordObjectMap();
 
+  // Record one allocation every sample_interval bytes on average, or all of them for 0. Only
+  // valid while allocation tracking is disabled. dalvik.vm.allocTrackerSampleInterval, if set,
+  // overrides it when tracking is enabled.
+  void SetSampleInterval(size_t sample_interval) REQUIRES(Locks::alloc_tracker_lock_);
+
   void Put(mirror::Object* obj, AllocRecord&& record)
       SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(Locks::alloc_tracker_lock_) {
     if (entries_.size() == alloc_record_max_) {
+      ReleaseStackTrace(entries_.front().second.GetStackTrace());
       entries_.pop_front();
     }
     entries_.push_back(EntryPair(GcRoot<mirror::Object>(obj), std::move(record)));
@@ -290,7 +306,18 @@ class AllocRecordObjectMap {
 
   void Clear() REQUIRES(Locks::alloc_tracker_lock_);
 
+  // Returns the shared copy of the trace, adding a reference to it.
+  const AllocRecordStackTrace* InternStackTrace(AllocRecordStackTrace&& trace)
+      REQUIRES(Locks::alloc_tracker_lock_);
+
+  // Drops a reference added by InternStackTrace(), deleting the trace when it is the last one.
+  void ReleaseStackTrace(const AllocRecordStackTrace* trace) REQUIRES(Locks::alloc_tracker_lock_);
+
  private:
+  // Number of records referencing each distinct stack trace. The node based map keeps the keys
+  // at stable addresses for AllocRecord::trace_.
+  typedef std::unordered_map<AllocRecordStackTrace, size_t, HashAllocRecordTypes> StackTraceMap;
+
   static constexpr size_t kDefaultNumAllocRecords = 512 * 1024;
   static constexpr size_t kDefaultNumRecentRecords = 64 * 1024 - 1;
   static constexpr size_t kDefaultAllocStackDepth = 16;
@@ -298,13 +325,25 @@ class AllocRecordObjectMap {
   size_t alloc_record_max_ GUARDED_BY(Locks::alloc_tracker_lock_) = kDefaultNumAllocRecords;
   size_t recent_record_max_ GUARDED_BY(Locks::alloc_tracker_lock_) = kDefaultNumRecentRecords;
   size_t max_stack_depth_ = kDefaultAllocStackDepth;
+  // Mean number of bytes allocated between two recorded allocations, 0 records all allocations.
+  // Only set while allocation tracking is disabled.
+  // The countdown to the next sample is kept per thread, see
+  // Thread::GetAllocTrackerBytesUntilSample().
+  size_t sample_interval_ = 0;
   pid_t alloc_ddm_thread_id_  GUARDED_BY(Locks::alloc_tracker_lock_) = 0;
   bool allow_new_record_ GUARDED_BY(Locks::alloc_tracker_lock_) = true;
   ConditionVariable new_record_condition_ GUARDED_BY(Locks::alloc_tracker_lock_);
   // see the comment in typedef of EntryList
   EntryList entries_ GUARDED_BY(Locks::alloc_tracker_lock_);
+  StackTraceMap stack_traces_ GUARDED_BY(Locks::alloc_tracker_lock_);
 
   void SetProperties() REQUIRES(Locks::alloc_tracker_lock_);
+
+  // Returns whether an allocation of byte_count bytes is picked by the sampler. Allocations are
+  // sampled per byte with a Poisson process so that larger objects are proportionally more
+  // likely to be recorded.
+  bool ShouldSample(Thread* self, size_t byte_count) const;
+  size_t NextSampleDistance(Thread* self) const;
 };
 
 }  // namespace gc
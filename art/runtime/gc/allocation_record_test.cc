@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "allocation_record.h"
+
+#include <cmath>
+
+#include "common_runtime_test.h"
+#include "gc/heap.h"
+#include "mirror/array-inl.h"
+#include "scoped_thread_state_change.h"
+
+namespace art {
+namespace gc {
+
+class AllocationRecordTest : public CommonRuntimeTest {};
+
+TEST_F(AllocationRecordTest, SampleInterval) {
+  static constexpr size_t kSampleInterval = 4 * KB;
+  static constexpr size_t kNumAllocations = 4000u;
+  static constexpr size_t kArrayLength = 1000u;
+  Thread* self = Thread::Current();
+  Heap* heap = Runtime::Current()->GetHeap();
+  {
+    MutexLock mu(self, *Locks::alloc_tracker_lock_);
+    AllocRecordObjectMap* records = new AllocRecordObjectMap;
+    records->SetSampleInterval(kSampleInterval);
+    heap->SetAllocationRecords(records);
+  }
+  AllocRecordObjectMap::SetAllocTrackingEnabled(true);
+
+  {
+    ScopedObjectAccess soa(self);
+    for (size_t i = 0; i != kNumAllocations; ++i) {
+      ASSERT_TRUE(mirror::ByteArray::Alloc(soa.Self(), kArrayLength) != nullptr);
+    }
+  }
+
+  size_t num_samples = 0u;
+  // The bytes counted for each array, which includes the rounding of the allocator.
+  size_t byte_count = 0u;
+  {
+    ScopedObjectAccess soa(self);
+    MutexLock mu(self, *Locks::alloc_tracker_lock_);
+    AllocRecordObjectMap* records = heap->GetAllocationRecords();
+    mirror::Class* byte_array_class = mirror::ByteArray::GetArrayClass();
+    const AllocRecordStackTrace* trace = nullptr;
+    for (auto it = records->Begin(); it != records->End(); ++it) {
+      const AllocRecord& record = it->second;
+      if (record.GetClass() != byte_array_class || record.GetTid() != self->GetTid()) {
+        continue;
+      }
+      if (byte_count == 0u) {
+        byte_count = record.ByteCount();
+      }
+      EXPECT_EQ(byte_count, record.ByteCount());
+      // All the arrays are allocated from the same stack, which is interned only once.
+      if (trace == nullptr) {
+        trace = record.GetStackTrace();
+      }
+      EXPECT_EQ(trace, record.GetStackTrace());
+      ++num_samples;
+    }
+  }
+  AllocRecordObjectMap::SetAllocTrackingEnabled(false);
+
+  // Each allocation is recorded with probability 1 - exp(-size / interval).
+  ASSERT_NE(0u, num_samples);
+  const double expected =
+      kNumAllocations * -std::expm1(-static_cast<double>(byte_count) / kSampleInterval);
+  EXPECT_GT(num_samples, static_cast<size_t>(expected * 0.8));
+  EXPECT_LT(num_samples, static_cast<size_t>(expected * 1.2));
+}
+
+}  // namespace gc
+}  // namespace art
@@ -236,6 +236,8 @@ Heap::Heap(size_t initial_size,
       running_collection_is_blocking_(false),
       blocking_gc_count_(0U),
       blocking_gc_time_(0U),
+      blocking_get_referent_count_(0U),
+      blocking_get_referent_time_(0U),
       last_update_time_gc_count_rate_histograms_(  // Round down by the window duration.
           (NanoTime() / kGcCountRateHistogramWindowDuration) * kGcCountRateHistogramWindowDuration),
       gc_count_last_window_(0U),
@@ -1172,6 +1174,9 @@ void Heap::DumpGcPerformanceInfo(std::ostream& os) {
   os << "Total GC time: " << PrettyDuration(GetGcTime()) << "\n";
   os << "Total blocking GC count: " << GetBlockingGcCount() << "\n";
   os << "Total blocking GC time: " << PrettyDuration(GetBlockingGcTime()) << "\n";
+  os << "Total blocking Reference.get() count: " << GetBlockingGetReferentCount() << "\n";
+  os << "Total blocking Reference.get() time: "
+     << PrettyDuration(GetBlockingGetReferentTime()) << "\n";
 
   {
     MutexLock mu(Thread::Current(), *gc_complete_lock_);
@@ -1218,6 +1223,8 @@ void Heap::ResetGcPerformanceInfo() {
   total_wait_time_ = 0;
   blocking_gc_count_ = 0;
   blocking_gc_time_ = 0;
+  blocking_get_referent_count_.StoreRelaxed(0);
+  blocking_get_referent_time_.StoreRelaxed(0);
   gc_count_last_window_ = 0;
   blocking_gc_count_last_window_ = 0;
   last_update_time_gc_count_rate_histograms_ =  // Round down by the window duration.
@@ -3490,6 +3497,9 @@ void Heap::DumpForSigQuit(std::ostream& os) {
   os << "Heap: " << GetPercentFree() << "% free, " << PrettySize(GetBytesAllocated()) << "/"
      << PrettySize(GetTotalMemory()) << "; " << GetObjectsAllocated() << " objects\n";
   DumpGcPerformanceInfo(os);
+  if (IsAllocTrackingEnabled()) {
+    AllocRecordObjectMap::DumpSampledHeapProfile(os);
+  }
 }
 
 size_t Heap::GetPercentFree() {
@@ -532,7 +532,8 @@ class Heap {
   space::Space* FindSpaceFromObject(const mirror::Object*, bool fail_ok) const
       SHARED_REQUIRES(Locks::mutator_lock_);
 
-  void DumpForSigQuit(std::ostream& os) REQUIRES(!*gc_complete_lock_, !native_histogram_lock_);
+  void DumpForSigQuit(std::ostream& os)
+      REQUIRES(!*gc_complete_lock_, !native_histogram_lock_, !Locks::alloc_tracker_lock_);
 
   // Do a pending collector transition.
   void DoPendingCollectorTransition() REQUIRES(!*gc_complete_lock_);
@@ -737,6 +738,18 @@ class Heap {
   uint64_t GetGcTime() const;
   uint64_t GetBlockingGcCount() const;
   uint64_t GetBlockingGcTime() const;
+
+  // Called by the reference processor when Reference.get() had to wait for the GC.
+  void RecordBlockingGetReferent(uint64_t wait_time_ns) {
+    blocking_get_referent_count_.FetchAndAddRelaxed(1u);
+    blocking_get_referent_time_.FetchAndAddRelaxed(wait_time_ns);
+  }
+  uint64_t GetBlockingGetReferentCount() const {
+    return blocking_get_referent_count_.LoadRelaxed();
+  }
+  uint64_t GetBlockingGetReferentTime() const {
+    return blocking_get_referent_time_.LoadRelaxed();
+  }
   void DumpGcCountRateHistogram(std::ostream& os) const REQUIRES(!*gc_complete_lock_);
   void DumpBlockingGcCountRateHistogram(std::ostream& os) const REQUIRES(!*gc_complete_lock_);
 
@@ -1314,6 +1327,10 @@ class Heap {
   uint64_t blocking_gc_count_;
   // The total duration of blocking GC runs.
   uint64_t blocking_gc_time_;
+  // The number of times a thread had to wait in Reference.get() for reference processing.
+  Atomic<uint64_t> blocking_get_referent_count_;
+  // The total duration of those waits.
+  Atomic<uint64_t> blocking_get_referent_time_;
   // The duration of the window for the GC count rate histograms.
   static constexpr uint64_t kGcCountRateHistogramWindowDuration = MsToNs(10 * 1000);  // 10s.
   // The last time when the GC count rate histograms were updated.
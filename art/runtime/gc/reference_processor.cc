@@ -18,6 +18,7 @@
 
 #include "base/time_utils.h"
 #include "collector/garbage_collector.h"
+#include "heap.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
 #include "mirror/reference-inl.h"
@@ -60,6 +61,29 @@ void ReferenceProcessor::BroadcastForSlowPath(Thread* self) {
   condition_.Broadcast(self);
 }
 
+// Records in the heap how long GetReferent was blocked, if it was blocked at all.
+class ScopedBlockingGetReferentTimer {
+ public:
+  ScopedBlockingGetReferentTimer() : start_ns_(0u) {}
+
+  ~ScopedBlockingGetReferentTimer() {
+    if (start_ns_ != 0u) {
+      Runtime::Current()->GetHeap()->RecordBlockingGetReferent(NanoTime() - start_ns_);
+    }
+  }
+
+  void BeforeWait() {
+    if (start_ns_ == 0u) {
+      start_ns_ = NanoTime();
+    }
+  }
+
+ private:
+  uint64_t start_ns_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedBlockingGetReferentTimer);
+};
+
 mirror::Object* ReferenceProcessor::GetReferent(Thread* self, mirror::Reference* reference) {
   if (!kUseReadBarrier || self->GetWeakRefAccessEnabled()) {
     // Under read barrier / concurrent copying collector, it's not safe to call GetReferent() when
@@ -72,6 +96,7 @@ mirror::Object* ReferenceProcessor::GetReferent(Thread* self, mirror::Reference*
       return referent;
     }
   }
+  ScopedBlockingGetReferentTimer timer;
   MutexLock mu(self, *Locks::reference_processor_lock_);
   while ((!kUseReadBarrier && SlowPathEnabled()) ||
          (kUseReadBarrier && !self->GetWeakRefAccessEnabled())) {
@@ -98,6 +123,7 @@ mirror::Object* ReferenceProcessor::GetReferent(Thread* self, mirror::Reference*
         }
       }
     }
+    timer.BeforeWait();
     condition_.WaitHoldingLocks(self);
   }
   return reference->GetReferent();
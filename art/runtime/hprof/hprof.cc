@@ -31,9 +31,11 @@
 #include <string.h>
 #include <sys/time.h>
 #include <sys/uio.h>
+#include <sys/wait.h>
 #include <time.h>
 #include <time.h>
 #include <unistd.h>
+#include <zlib.h>
 
 #include <set>
 
@@ -74,6 +76,11 @@ static constexpr uint32_t kHprofNullThread = 0;
 static constexpr size_t kMaxObjectsPerSegment = 128;
 static constexpr size_t kMaxBytesPerSegment = 4096;
 
+// Size of the staging buffer used by the streaming (forked) dump. Records are coalesced into it
+// before being written (and optionally compressed), which bounds the memory overhead of the dump
+// independently of the heap size.
+static constexpr size_t kStreamBufferSize = 64 * KB;
+
 // The static field-name for the synthetic object generated to account for class static overhead.
 static constexpr const char* kClassOverheadName = "$classOverhead";
 
@@ -412,6 +419,109 @@ class NetStateEndianOutput FINAL : public EndianOutputBuffered {
   JDWP::JdwpNetStateBase* net_state_;
 };
 
+// Coalesces flushed records into a fixed-size buffer and streams it to a file descriptor,
+// optionally gzip-compressing it on the fly. Used by the forked dump, so it must not throw
+// or log: errors are only reported through Errors().
+class StreamEndianOutput FINAL : public EndianOutputBuffered {
+ public:
+  StreamEndianOutput(int fd, bool compress, size_t reserved_size)
+      : EndianOutputBuffered(reserved_size),
+        fd_(fd),
+        compress_(compress),
+        errors_(false),
+        stream_buffer_(new uint8_t[kStreamBufferSize]),
+        stream_length_(0u),
+        deflate_buffer_(compress ? new uint8_t[kStreamBufferSize] : nullptr) {
+    DCHECK_GE(fd, 0);
+    if (compress_) {
+      memset(&zstream_, 0, sizeof(zstream_));
+      // 15 + 16: default window size, with a gzip header and trailer.
+      errors_ = deflateInit2(&zstream_, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8,
+                             Z_DEFAULT_STRATEGY) != Z_OK;
+    }
+  }
+
+  ~StreamEndianOutput() {
+    if (compress_) {
+      deflateEnd(&zstream_);
+    }
+  }
+
+  // Writes out any buffered data and terminates the compressed stream. Returns false on error.
+  bool Finish() {
+    FlushStreamBuffer(/* finish */ true);
+    return !errors_;
+  }
+
+  bool Errors() const {
+    return errors_;
+  }
+
+ protected:
+  void HandleFlush(const uint8_t* buffer, size_t length) OVERRIDE {
+    if (stream_length_ + length > kStreamBufferSize) {
+      FlushStreamBuffer(/* finish */ false);
+    }
+    if (length > kStreamBufferSize) {
+      // Large records (e.g. big primitive arrays) bypass the staging buffer.
+      WriteOut(buffer, length, /* finish */ false);
+      return;
+    }
+    memcpy(stream_buffer_.get() + stream_length_, buffer, length);
+    stream_length_ += length;
+  }
+
+ private:
+  void FlushStreamBuffer(bool finish) {
+    WriteOut(stream_buffer_.get(), stream_length_, finish);
+    stream_length_ = 0u;
+  }
+
+  void WriteOut(const uint8_t* data, size_t length, bool finish) {
+    if (errors_) {
+      return;
+    }
+    if (!compress_) {
+      WriteRaw(data, length);
+      return;
+    }
+    zstream_.next_in = const_cast<uint8_t*>(data);
+    zstream_.avail_in = length;
+    const int flush = finish ? Z_FINISH : Z_NO_FLUSH;
+    int result;
+    do {
+      zstream_.next_out = deflate_buffer_.get();
+      zstream_.avail_out = kStreamBufferSize;
+      result = deflate(&zstream_, flush);
+      if (result == Z_STREAM_ERROR) {
+        errors_ = true;
+        return;
+      }
+      WriteRaw(deflate_buffer_.get(), kStreamBufferSize - zstream_.avail_out);
+    } while (!errors_ && (zstream_.avail_out == 0u || (finish && result != Z_STREAM_END)));
+  }
+
+  void WriteRaw(const uint8_t* data, size_t length) {
+    while (!errors_ && length != 0u) {
+      ssize_t written = TEMP_FAILURE_RETRY(write(fd_, data, length));
+      if (written <= 0) {
+        errors_ = true;
+        return;
+      }
+      data += written;
+      length -= written;
+    }
+  }
+
+  const int fd_;
+  const bool compress_;
+  bool errors_;
+  std::unique_ptr<uint8_t[]> stream_buffer_;
+  size_t stream_length_;
+  std::unique_ptr<uint8_t[]> deflate_buffer_;
+  z_stream zstream_;
+};
+
 #define __ output_->
 
 class Hprof : public SingleRootVisitor {
@@ -426,24 +536,9 @@ class Hprof : public SingleRootVisitor {
   void Dump()
     REQUIRES(Locks::mutator_lock_)
     REQUIRES(!Locks::heap_bitmap_lock_, !Locks::alloc_tracker_lock_) {
-    {
-      MutexLock mu(Thread::Current(), *Locks::alloc_tracker_lock_);
-      if (Runtime::Current()->GetHeap()->IsAllocTrackingEnabled()) {
-        PopulateAllocationTrackingTraces();
-      }
-    }
-
-    // First pass to measure the size of the dump.
     size_t overall_size;
     size_t max_length;
-    {
-      EndianOutput count_output;
-      output_ = &count_output;
-      ProcessHeap(false);
-      overall_size = count_output.SumLength();
-      max_length = count_output.MaxLength();
-      output_ = nullptr;
-    }
+    MeasureDump(&overall_size, &max_length);
 
     bool okay;
     if (direct_to_ddms_) {
@@ -465,6 +560,39 @@ class Hprof : public SingleRootVisitor {
     }
   }
 
+  // Writes the dump measured by a previous MeasureDump() to "stream_output". This runs in a
+  // child forked by DumpHeapForked, so it neither throws, logs nor allocates: all the IDs and
+  // buffers it needs were set up by the parent before the fork.
+  bool DumpStreaming(StreamEndianOutput* stream_output)
+    REQUIRES(Locks::mutator_lock_)
+    REQUIRES(!Locks::heap_bitmap_lock_, !Locks::alloc_tracker_lock_) {
+    output_ = stream_output;
+    ProcessHeap(true);
+    output_ = nullptr;
+    return stream_output->Finish();
+  }
+
+  // Populates the allocation traces and runs a first pass to measure the size of the dump. The
+  // pass also assigns the string and class IDs that the header needs before the body, so that
+  // the second pass over an unchanged heap only looks them up.
+  void MeasureDump(size_t* overall_size, size_t* max_length)
+    REQUIRES(Locks::mutator_lock_)
+    REQUIRES(!Locks::heap_bitmap_lock_, !Locks::alloc_tracker_lock_) {
+    {
+      MutexLock mu(Thread::Current(), *Locks::alloc_tracker_lock_);
+      if (Runtime::Current()->GetHeap()->IsAllocTrackingEnabled()) {
+        PopulateAllocationTrackingTraces();
+      }
+    }
+
+    EndianOutput count_output;
+    output_ = &count_output;
+    ProcessHeap(false);
+    *overall_size = count_output.SumLength();
+    *max_length = count_output.MaxLength();
+    output_ = nullptr;
+  }
+
  private:
   static void VisitObjectCallback(mirror::Object* obj, void* arg)
       SHARED_REQUIRES(Locks::mutator_lock_) {
@@ -505,7 +633,11 @@ class Hprof : public SingleRootVisitor {
     // Walk the roots and the heap.
     output_->StartNewRecord(HPROF_TAG_HEAP_DUMP_SEGMENT, kHprofTime);
 
-    simple_roots_.clear();
+    // Keep the entries from a previous pass and only mark them as not yet emitted, so that the
+    // second pass does not allocate.
+    for (auto& entry : simple_roots_) {
+      entry.second = false;
+    }
     runtime->VisitRoots(this);
     runtime->VisitImageRoots(this);
     runtime->GetHeap()->VisitObjectsPaused(VisitObjectCallback, this);
@@ -617,8 +749,16 @@ class Hprof : public SingleRootVisitor {
     return LookupStringId(string->ToModifiedUtf8());
   }
 
+  // "string" must stay valid for the whole dump, e.g. a literal or a string in a dex file, as
+  // its address is cached.
   HprofStringId LookupStringId(const char* string) {
-    return LookupStringId(std::string(string));
+    auto it = string_addresses_.find(string);
+    if (it != string_addresses_.end()) {
+      return it->second;
+    }
+    HprofStringId id = LookupStringId(std::string(string));
+    string_addresses_.Put(string, id);
+    return id;
   }
 
   HprofStringId LookupStringId(const std::string& string) {
@@ -632,7 +772,23 @@ class Hprof : public SingleRootVisitor {
   }
 
   HprofStringId LookupClassNameId(mirror::Class* c) SHARED_REQUIRES(Locks::mutator_lock_) {
-    return LookupStringId(PrettyDescriptor(c));
+    auto it = class_name_ids_.find(c);
+    if (it != class_name_ids_.end()) {
+      return it->second;
+    }
+    HprofStringId id = LookupStringId(PrettyDescriptor(c));
+    class_name_ids_.Put(c, id);
+    return id;
+  }
+
+  HprofStringId LookupMethodSignatureId(ArtMethod* method) SHARED_REQUIRES(Locks::mutator_lock_) {
+    auto it = method_signature_ids_.find(method);
+    if (it != method_signature_ids_.end()) {
+      return it->second;
+    }
+    HprofStringId id = LookupStringId(method->GetSignature().ToString());
+    method_signature_ids_.Put(method, id);
+    return id;
   }
 
   void WriteFixedHeader() {
@@ -690,7 +846,7 @@ class Hprof : public SingleRootVisitor {
         CHECK(frame_result != frames_.end());
         __ AddU4(frame_result->second);
         __ AddStringId(LookupStringId(method->GetName()));
-        __ AddStringId(LookupStringId(method->GetSignature().ToString()));
+        __ AddStringId(LookupMethodSignatureId(method));
         const char* source_file = method->GetDeclaringClassSourceFile();
         if (source_file == nullptr) {
           source_file = "";
@@ -874,6 +1030,10 @@ class Hprof : public SingleRootVisitor {
 
   HprofStringId next_string_id_ = 0x400000;
   SafeMap<std::string, HprofStringId> strings_;
+  // Caches of the string IDs above, which avoid building a std::string for every lookup.
+  SafeMap<const char*, HprofStringId> string_addresses_;
+  SafeMap<mirror::Class*, HprofStringId> class_name_ids_;
+  SafeMap<ArtMethod*, HprofStringId> method_signature_ids_;
   HprofClassSerialNumber next_class_serial_number_ = 1;
   SafeMap<mirror::Class*, HprofClassSerialNumber> classes_;
 
@@ -890,8 +1050,8 @@ class Hprof : public SingleRootVisitor {
   // those that contain no other information than the root type and the object
   // id. A pair of root type and object id is packed into a uint64_t, with
   // the root type in the upper 32 bits and the object id in the lower 32
-  // bits.
-  std::unordered_set<uint64_t> simple_roots_;
+  // bits. The value records whether the root was emitted in the current pass.
+  std::unordered_map<uint64_t, bool> simple_roots_;
 
   friend class GcRootVisitor;
   DISALLOW_COPY_AND_ASSIGN(Hprof);
@@ -973,7 +1133,12 @@ void Hprof::MarkRootObject(const mirror::Object* obj, jobject jni_obj, HprofHeap
     case HPROF_ROOT_DEBUGGER:
     case HPROF_ROOT_VM_INTERNAL: {
       uint64_t key = (static_cast<uint64_t>(heap_tag) << 32) | PointerToLowMemUInt32(obj);
-      if (simple_roots_.insert(key).second) {
+      auto it = simple_roots_.find(key);
+      if (it == simple_roots_.end()) {
+        it = simple_roots_.emplace(key, false).first;
+      }
+      if (!it->second) {
+        it->second = true;
         __ AddU1(heap_tag);
         __ AddObjectId(obj);
       }
@@ -1427,5 +1592,110 @@ void DumpHeap(const char* filename, int fd, bool direct_to_ddms) {
   }
 }
 
+// The child process gets a copy-on-write snapshot of the heap taken while all threads are
+// suspended. The app stays paused while the parent measures the dump, a heap walk that assigns
+// the IDs and sizes the buffers without writing anything, and while it forks. The child then
+// walks the heap again to write (and compress) the dump while the app keeps running and
+// collecting garbage. Measuring in the parent is what lets the child run without allocating.
+bool DumpHeapForked(const char* filename, int fd, bool compress) {
+  CHECK(filename != nullptr);
+
+  Thread* self = Thread::Current();
+  int out_fd;
+  if (fd >= 0) {
+    out_fd = dup(fd);
+    if (out_fd < 0) {
+      ScopedObjectAccess soa(self);
+      ThrowRuntimeException("Couldn't dump heap; dup(%d) failed: %s", fd, strerror(errno));
+      return false;
+    }
+  } else {
+    out_fd = open(filename, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    if (out_fd < 0) {
+      ScopedObjectAccess soa(self);
+      ThrowRuntimeException("Couldn't dump heap; open(\"%s\") failed: %s", filename,
+                            strerror(errno));
+      return false;
+    }
+  }
+
+  const uint64_t start_ns = NanoTime();
+  uint64_t pause_ns;
+  uint64_t fork_ns = 0u;
+  bool stream_failed;
+  int fork_errno = 0;
+  pid_t pid = -1;
+  gc::Heap* heap = Runtime::Current()->GetHeap();
+  if (heap->IsGcConcurrentAndMoving()) {
+    // Make sure the snapshot isn't taken in the middle of a moving collection.
+    heap->IncrementDisableMovingGC(self);
+  }
+  {
+    ScopedSuspendAll ssa(__FUNCTION__, true /* long suspend */);
+    Hprof hprof(filename, out_fd, false);
+    // Another thread may have held the malloc lock when we fork, so the child must not allocate.
+    // Assign all the IDs and allocate the output buffers (and the deflate state) here, in the
+    // parent, while the heap cannot change.
+    size_t overall_size;
+    size_t max_length;
+    hprof.MeasureDump(&overall_size, &max_length);
+    StreamEndianOutput stream_output(out_fd, compress, max_length);
+    stream_failed = stream_output.Errors();
+    if (!stream_failed) {
+      const uint64_t fork_start_ns = NanoTime();
+      pid = fork();
+      if (pid == 0) {
+        // Only this thread exists in the child and it still holds the mutator lock exclusively.
+        // Avoid anything that could wait on a lock owned by a thread that did not survive the
+        // fork.
+        bool okay = hprof.DumpStreaming(&stream_output);
+        okay = (fsync(out_fd) == 0 || errno == EINVAL) && okay;
+        // _exit to avoid atexit handlers and destructors (which would free memory) and to never
+        // resume the (nonexistent) threads.
+        _exit(okay ? 0 : 1);
+      }
+      fork_errno = errno;
+      fork_ns = NanoTime() - fork_start_ns;
+    }
+    pause_ns = NanoTime() - start_ns;
+  }
+  if (heap->IsGcConcurrentAndMoving()) {
+    heap->DecrementDisableMovingGC(self);
+  }
+  close(out_fd);
+
+  if (stream_failed || pid == -1) {
+    // Nothing was written, don't leave an empty file behind.
+    if (fd < 0) {
+      unlink(filename);
+    }
+    ScopedObjectAccess soa(self);
+    if (stream_failed) {
+      ThrowRuntimeException("Couldn't dump heap; setting up the %soutput stream failed",
+                            compress ? "compressed " : "");
+    } else {
+      ThrowRuntimeException("Couldn't dump heap; fork failed: %s", strerror(fork_errno));
+    }
+    return false;
+  }
+  int status = -1;
+  pid_t got_pid = TEMP_FAILURE_RETRY(waitpid(pid, &status, 0));
+  if (got_pid != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    std::string msg(StringPrintf("Couldn't dump heap; writing \"%s\" failed (status %d)",
+                                 filename, status));
+    LOG(ERROR) << msg;
+    if (fd < 0) {
+      unlink(filename);
+    }
+    ScopedObjectAccess soa(self);
+    ThrowRuntimeException("%s", msg.c_str());
+    return false;
+  }
+  LOG(INFO) << "hprof: forked heap dump completed in " << PrettyDuration(NanoTime() - start_ns)
+            << " (app paused for " << PrettyDuration(pause_ns) << ", of which fork() took "
+            << PrettyDuration(fork_ns) << ")";
+  return true;
+}
+
 }  // namespace hprof
 }  // namespace art
@@ -23,6 +23,11 @@ namespace hprof {
 
 void DumpHeap(const char* filename, int fd, bool direct_to_ddms);
 
+// Dumps the heap from a forked child process, streaming it to "fd" (or to a new "filename" if
+// "fd" is negative) and gzip-compressing it if "compress" is set. Returns false and throws if
+// the dump failed.
+bool DumpHeapForked(const char* filename, int fd, bool compress);
+
 }  // namespace hprof
 
 }  // namespace art
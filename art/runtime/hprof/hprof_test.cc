@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hprof.h"
+
+#include <zlib.h>
+
+#include <vector>
+
+#include "common_runtime_test.h"
+
+namespace art {
+namespace hprof {
+
+class HprofTest : public CommonRuntimeTest {
+ protected:
+  // Reads back a dump, decompressing it if it is gzip-compressed.
+  static std::vector<uint8_t> ReadDump(const std::string& filename) {
+    std::vector<uint8_t> dump;
+    gzFile in = gzopen(filename.c_str(), "rb");
+    EXPECT_TRUE(in != nullptr);
+    if (in == nullptr) {
+      return dump;
+    }
+    uint8_t buffer[4096];
+    int length;
+    while ((length = gzread(in, buffer, sizeof(buffer))) > 0) {
+      dump.insert(dump.end(), buffer, buffer + length);
+    }
+    EXPECT_EQ(0, length);
+    gzclose(in);
+    return dump;
+  }
+
+  static void CheckDumpHeader(const std::vector<uint8_t>& dump) {
+    static constexpr char kMagic[] = "JAVA PROFILE 1.0.3";
+    // Magic (with its NUL), the identifier size and the two time words, then at least the
+    // string, class and heap records of the boot image.
+    ASSERT_GT(dump.size(), sizeof(kMagic) + 3 * sizeof(uint32_t) + KB);
+    EXPECT_EQ(0, memcmp(dump.data(), kMagic, sizeof(kMagic)));
+    const uint8_t* id_size = dump.data() + sizeof(kMagic);
+    EXPECT_EQ(0u, id_size[0]);
+    EXPECT_EQ(0u, id_size[1]);
+    EXPECT_EQ(0u, id_size[2]);
+    EXPECT_EQ(4u, id_size[3]);
+  }
+};
+
+TEST_F(HprofTest, DumpHeapForked) {
+  ScratchFile file;
+  ASSERT_TRUE(DumpHeapForked(file.GetFilename().c_str(), file.GetFd(), /* compress */ false));
+  std::vector<uint8_t> dump = ReadDump(file.GetFilename());
+  CheckDumpHeader(dump);
+  EXPECT_EQ(static_cast<int64_t>(dump.size()), file.GetFile()->GetLength());
+}
+
+TEST_F(HprofTest, DumpHeapForkedCompressed) {
+  ScratchFile file;
+  ASSERT_TRUE(DumpHeapForked(file.GetFilename().c_str(), file.GetFd(), /* compress */ true));
+  uint8_t gzip_magic[2];
+  ASSERT_TRUE(file.GetFile()->PreadFully(gzip_magic, sizeof(gzip_magic), 0));
+  EXPECT_EQ(0x1fu, gzip_magic[0]);
+  EXPECT_EQ(0x8bu, gzip_magic[1]);
+  std::vector<uint8_t> dump = ReadDump(file.GetFilename());
+  CheckDumpHeader(dump);
+  EXPECT_LT(file.GetFile()->GetLength(), static_cast<int64_t>(dump.size()));
+}
+
+TEST_F(HprofTest, DumpHeapForkedToFilename) {
+  ScratchFile file;
+  std::string filename = file.GetFilename();
+  file.Unlink();
+  // Without an fd, the dump creates the file itself.
+  ASSERT_TRUE(DumpHeapForked(filename.c_str(), -1, /* compress */ false));
+  CheckDumpHeader(ReadDump(filename));
+  unlink(filename.c_str());
+}
+
+}  // namespace hprof
+}  // namespace art
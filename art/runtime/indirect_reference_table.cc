@@ -26,6 +26,7 @@
 #include "utils.h"
 #include "verify_object-inl.h"
 
+#include <algorithm>
 #include <cstdlib>
 
 namespace art {
@@ -71,7 +72,9 @@ IndirectReferenceTable::IndirectReferenceTable(size_t initialCount,
                                                size_t maxCount, IndirectRefKind desiredKind,
                                                bool abort_on_error)
     : kind_(desiredKind),
-      max_entries_(maxCount) {
+      max_entries_(maxCount),
+      last_known_hole_(kNoHole),
+      high_water_mark_(0u) {
   CHECK_GT(initialCount, 0U);
   CHECK_LE(initialCount, maxCount);
   CHECK_NE(desiredKind, kHandleScopeOrInvalid);
@@ -126,20 +129,30 @@ IndirectRef IndirectReferenceTable::Add(uint32_t cookie, mirror::Object* obj) {
   size_t index;
   if (numHoles > 0) {
     DCHECK_GT(topIndex, 1U);
-    // Find the first hole; likely to be near the end of the list.
-    IrtEntry* pScan = &table_[topIndex - 1];
-    DCHECK(!pScan->GetReference()->IsNull());
-    --pScan;
-    while (!pScan->GetReference()->IsNull()) {
-      DCHECK_GE(pScan, table_ + prevState.parts.topIndex);
+    if (last_known_hole_ >= prevState.parts.topIndex && last_known_hole_ < topIndex &&
+        table_[last_known_hole_].GetReference()->IsNull()) {
+      // Fast path for an add immediately following a delete.
+      index = last_known_hole_;
+    } else {
+      // Find the first hole; likely to be near the end of the list.
+      IrtEntry* pScan = &table_[topIndex - 1];
+      DCHECK(!pScan->GetReference()->IsNull());
       --pScan;
+      while (!pScan->GetReference()->IsNull()) {
+        DCHECK_GE(pScan, table_ + prevState.parts.topIndex);
+        --pScan;
+      }
+      index = pScan - table_;
     }
-    index = pScan - table_;
+    last_known_hole_ = kNoHole;
     segment_state_.parts.numHoles--;
   } else {
     // Add to the end.
     index = topIndex++;
     segment_state_.parts.topIndex = topIndex;
+    if (topIndex > high_water_mark_) {
+      high_water_mark_ = topIndex;
+    }
   }
   table_[index].Add(obj);
   result = ToIndirectRef(index);
@@ -253,6 +266,7 @@ bool IndirectReferenceTable::Remove(uint32_t cookie, IndirectRef iref) {
 
     *table_[idx].GetReference() = GcRoot<mirror::Object>(nullptr);
     segment_state_.parts.numHoles++;
+    last_known_hole_ = idx;
     if ((false)) {
       LOG(INFO) << "+++ left hole at " << idx << ", holes=" << segment_state_.parts.numHoles;
     }
@@ -265,8 +279,14 @@ void IndirectReferenceTable::Trim() {
   ScopedTrace trace(__PRETTY_FUNCTION__);
   const size_t top_index = Capacity();
   auto* release_start = AlignUp(reinterpret_cast<uint8_t*>(&table_[top_index]), kPageSize);
-  uint8_t* release_end = table_mem_map_->End();
-  madvise(release_start, release_end - release_start, MADV_DONTNEED);
+  // Pages above the high water mark were never written since the last trim.
+  uint8_t* release_end = std::min(
+      AlignUp(reinterpret_cast<uint8_t*>(&table_[high_water_mark_]), kPageSize),
+      table_mem_map_->End());
+  if (release_start < release_end) {
+    madvise(release_start, release_end - release_start, MADV_DONTNEED);
+  }
+  high_water_mark_ = top_index;
 }
 
 void IndirectReferenceTable::VisitRoots(RootVisitor* visitor, const RootInfo& root_info) {
@@ -175,10 +175,14 @@ static const uint32_t IRT_FIRST_SEGMENT = 0;
  * stale references aren't possible (though we may be able to get similar
  * benefits with other approaches).
  *
- * TODO: consider a "lastDeleteIndex" for quick hole-filling when an
- * add immediately follows a delete; must invalidate after segment pop
- * (which could increase the cost/complexity of method call/return).
- * Might be worth only using it for JNI globals.
+ * We remember the index of the most recently created hole so that an add
+ * immediately following a delete fills it without scanning.  Segment pops
+ * do not invalidate it (they happen in generated code), so the hint is only
+ * trusted if it is still a hole inside the current segment.
+ *
+ * The backing MemMap reserves room for max_entries_ but pages are only
+ * committed when they are first written, and Trim releases the pages
+ * between the top of the table and its high water mark.
  *
  * TODO: may want completely different add/remove algorithms for global
  * and local refs to improve performance.  A large circular buffer might
@@ -354,6 +358,11 @@ class IndirectReferenceTable {
   // Release pages past the end of the table that may have previously held references.
   void Trim() SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Returns the highest top index since the last Trim.
+  size_t GetHighWaterMark() const {
+    return high_water_mark_;
+  }
+
  private:
   // Extract the table index from an indirect reference.
   static uint32_t ExtractIndex(IndirectRef iref) {
@@ -391,6 +400,12 @@ class IndirectReferenceTable {
   const IndirectRefKind kind_;
   /* max #of entries allowed */
   const size_t max_entries_;
+  // Index of the most recently created hole, or kNoHole. May be stale, see the class comment.
+  size_t last_known_hole_;
+  // Highest top index since the last Trim, the pages above it are not committed.
+  size_t high_water_mark_;
+
+  static constexpr size_t kNoHole = static_cast<size_t>(-1);
 };
 
 }  // namespace art
@@ -254,4 +254,55 @@ TEST_F(IndirectReferenceTableTest, BasicTest) {
   CheckDump(&irt, 0, 0);
 }
 
+TEST_F(IndirectReferenceTableTest, HoleReuse) {
+  ScopedObjectAccess soa(Thread::Current());
+  static const size_t kTableInitial = 10;
+  static const size_t kTableMax = 20;
+  IndirectReferenceTable irt(kTableInitial, kTableMax, kLocal);
+
+  mirror::Class* c = class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;");
+  ASSERT_TRUE(c != nullptr);
+  mirror::Object* obj0 = c->AllocObject(soa.Self());
+  ASSERT_TRUE(obj0 != nullptr);
+  mirror::Object* obj1 = c->AllocObject(soa.Self());
+  ASSERT_TRUE(obj1 != nullptr);
+
+  const uint32_t cookie = IRT_FIRST_SEGMENT;
+  IndirectRef refs[4];
+  for (size_t i = 0; i < arraysize(refs); ++i) {
+    refs[i] = irt.Add(cookie, obj0);
+    ASSERT_TRUE(refs[i] != nullptr);
+  }
+  ASSERT_EQ(4U, irt.GetHighWaterMark());
+
+  // Delete followed by add fills the hole instead of growing the table.
+  for (size_t round = 0; round < 3; ++round) {
+    ASSERT_TRUE(irt.Remove(cookie, refs[1]));
+    refs[1] = irt.Add(cookie, obj1);
+    ASSERT_TRUE(refs[1] != nullptr);
+    EXPECT_EQ(4U, irt.Capacity());
+    EXPECT_EQ(obj1, irt.Get(refs[1]));
+  }
+
+  // A hole below the current segment must not be reused by the new segment.
+  ASSERT_TRUE(irt.Remove(cookie, refs[2]));
+  const uint32_t segment_cookie = irt.GetSegmentState();
+  IndirectRef segment_ref = irt.Add(segment_cookie, obj1);
+  ASSERT_TRUE(segment_ref != nullptr);
+  EXPECT_EQ(5U, irt.Capacity());
+  irt.SetSegmentState(segment_cookie);
+  EXPECT_EQ(4U, irt.Capacity());
+
+  // The hole of the first segment can still be filled.
+  refs[2] = irt.Add(cookie, obj1);
+  ASSERT_TRUE(refs[2] != nullptr);
+  EXPECT_EQ(4U, irt.Capacity());
+  EXPECT_EQ(obj1, irt.Get(refs[2]));
+
+  // Trimming resets the high water mark to the top index.
+  EXPECT_EQ(5U, irt.GetHighWaterMark());
+  irt.Trim();
+  EXPECT_EQ(4U, irt.GetHighWaterMark());
+}
+
 }  // namespace art
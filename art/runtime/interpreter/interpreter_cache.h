@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_INTERPRETER_INTERPRETER_CACHE_H_
+#define ART_RUNTIME_INTERPRETER_INTERPRETER_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/macros.h"
+
+namespace art {
+namespace interpreter {
+
+// A small, thread-local, direct-mapped cache used by mterp to skip the dex cache resolution of
+// field accesses and invokes. It is keyed by the address of the dex instruction and the cached
+// value only depends on that instruction once it has been resolved (the byte offset of a
+// non-volatile instance field, or the resolved ArtMethod* of an invoke), so entries need no
+// receiver class guard. The cache is owned by a single thread and needs no synchronization.
+// Threads only allocate their own cache when they first fill it; until then they point to an
+// empty cache shared by all threads (see Thread::GetOrCreateInterpreterCache()).
+//
+// Entries are only valid while the code item they point into is alive, so the cache is cleared
+// whenever the GC visits the thread's roots. This happens before any class (and its dex file)
+// can be unloaded.
+//
+// The assembly fast paths depend on the layout: an array of kSize {key, value} pairs indexed
+// by bits [2, 2 + kSizeLog2) of the dex pc pointer.
+class InterpreterCache {
+ public:
+  static constexpr size_t kSizeLog2 = 8;
+  static constexpr size_t kSize = 1u << kSizeLog2;
+
+  struct Entry {
+    const void* key;
+    size_t value;
+  };
+
+  InterpreterCache() {
+    Clear();
+  }
+
+  void Clear() {
+    for (Entry& entry : data_) {
+      entry.key = nullptr;
+      entry.value = 0u;
+    }
+  }
+
+  ALWAYS_INLINE bool Get(const void* key, size_t* value) {
+    const Entry& entry = data_[IndexOf(key)];
+    if (LIKELY(entry.key == key)) {
+      *value = entry.value;
+      return true;
+    }
+    return false;
+  }
+
+  ALWAYS_INLINE void Set(const void* key, size_t value) {
+    Entry& entry = data_[IndexOf(key)];
+    entry.key = key;
+    entry.value = value;
+  }
+
+ private:
+  static size_t IndexOf(const void* key) {
+    // Dex instructions that use the cache are at least two code units long.
+    return (reinterpret_cast<uintptr_t>(key) >> 2) & (kSize - 1);
+  }
+
+  Entry data_[kSize];
+
+  DISALLOW_COPY_AND_ASSIGN(InterpreterCache);
+};
+
+}  // namespace interpreter
+}  // namespace art
+
+#endif  // ART_RUNTIME_INTERPRETER_INTERPRETER_CACHE_H_
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "interpreter_cache.h"
+
+#include "common_runtime_test.h"
+#include "gc/heap.h"
+#include "runtime.h"
+#include "scoped_thread_state_change.h"
+#include "thread.h"
+
+namespace art {
+namespace interpreter {
+
+class InterpreterCacheTest : public CommonRuntimeTest {
+ protected:
+  // Stands in for the code units of a method. Keys two code units apart use consecutive
+  // entries, keys 2 * kSize code units apart use the same entry.
+  uint16_t insns_[2 * InterpreterCache::kSize + 4];
+};
+
+class NoopRootVisitor : public SingleRootVisitor {
+ private:
+  void VisitRoot(mirror::Object* root ATTRIBUTE_UNUSED,
+                 const RootInfo& info ATTRIBUTE_UNUSED) OVERRIDE {}
+};
+
+TEST_F(InterpreterCacheTest, Hit) {
+  InterpreterCache cache;
+  size_t value = 0u;
+  EXPECT_FALSE(cache.Get(&insns_[0], &value));
+
+  cache.Set(&insns_[0], 42u);
+  cache.Set(&insns_[2], 43u);
+  ASSERT_TRUE(cache.Get(&insns_[0], &value));
+  EXPECT_EQ(42u, value);
+  ASSERT_TRUE(cache.Get(&insns_[2], &value));
+  EXPECT_EQ(43u, value);
+  EXPECT_FALSE(cache.Get(&insns_[4], &value));
+
+  cache.Set(&insns_[0], 44u);
+  ASSERT_TRUE(cache.Get(&insns_[0], &value));
+  EXPECT_EQ(44u, value);
+}
+
+TEST_F(InterpreterCacheTest, Collision) {
+  InterpreterCache cache;
+  const uint16_t* const first = &insns_[0];
+  const uint16_t* const second = &insns_[2 * InterpreterCache::kSize];
+  size_t value = 0u;
+
+  // The cache is direct-mapped, the second key evicts the first one and the other way round.
+  cache.Set(first, 1u);
+  cache.Set(second, 2u);
+  EXPECT_FALSE(cache.Get(first, &value));
+  ASSERT_TRUE(cache.Get(second, &value));
+  EXPECT_EQ(2u, value);
+
+  cache.Set(first, 3u);
+  EXPECT_FALSE(cache.Get(second, &value));
+  ASSERT_TRUE(cache.Get(first, &value));
+  EXPECT_EQ(3u, value);
+}
+
+TEST_F(InterpreterCacheTest, Clear) {
+  InterpreterCache cache;
+  for (size_t i = 0; i < InterpreterCache::kSize; ++i) {
+    cache.Set(&insns_[2 * i], i + 1u);
+  }
+  cache.Clear();
+  size_t value = 0u;
+  for (size_t i = 0; i < InterpreterCache::kSize; ++i) {
+    EXPECT_FALSE(cache.Get(&insns_[2 * i], &value)) << i;
+  }
+}
+
+TEST_F(InterpreterCacheTest, ThreadCache) {
+  Thread* const self = Thread::Current();
+  ScopedObjectAccess soa(self);
+  // The cache of a thread is only allocated once, later calls return the same cache.
+  InterpreterCache* const cache = self->GetOrCreateInterpreterCache();
+  EXPECT_EQ(cache, self->GetInterpreterCache());
+  EXPECT_EQ(cache, self->GetOrCreateInterpreterCache());
+
+  cache->Set(&insns_[0], 42u);
+  size_t value = 0u;
+  ASSERT_TRUE(self->GetInterpreterCache()->Get(&insns_[0], &value));
+  EXPECT_EQ(42u, value);
+}
+
+TEST_F(InterpreterCacheTest, ClearedWhenThreadRootsAreVisited) {
+  Thread* const self = Thread::Current();
+  ScopedObjectAccess soa(self);
+  InterpreterCache* const cache = self->GetOrCreateInterpreterCache();
+  cache->Set(&insns_[0], 42u);
+  size_t value = 0u;
+  ASSERT_TRUE(self->GetInterpreterCache()->Get(&insns_[0], &value));
+
+  // The GC visits the roots of a thread at a suspend point, after which the cached entries may
+  // point into unloaded dex files.
+  NoopRootVisitor visitor;
+  self->VisitRoots(&visitor);
+  EXPECT_FALSE(self->GetInterpreterCache()->Get(&insns_[0], &value));
+
+  cache->Set(&insns_[0], 42u);
+  Runtime::Current()->GetHeap()->CollectGarbage(/* clear_soft_references */ false);
+  EXPECT_FALSE(self->GetInterpreterCache()->Get(&insns_[0], &value));
+}
+
+}  // namespace interpreter
+}  // namespace art
@@ -622,17 +622,15 @@ static inline bool DoInvokeLambda(Thread* self, ShadowFrame& shadow_frame, const
                                               result);
 }
 
-// Handles invoke-XXX/range instructions (other than invoke-lambda[-range]).
-// Returns true on success, otherwise throws an exception and returns false.
+// Calls "called_method", found by an invoke-XXX/range instruction (other than
+// invoke-lambda[-range]) for "receiver". A null "called_method" means that the lookup failed
+// with a pending exception. Returns true on success, otherwise throws an exception and returns
+// false.
 template<InvokeType type, bool is_range, bool do_access_check>
-static inline bool DoInvoke(Thread* self, ShadowFrame& shadow_frame, const Instruction* inst,
-                            uint16_t inst_data, JValue* result) {
-  const uint32_t method_idx = (is_range) ? inst->VRegB_3rc() : inst->VRegB_35c();
-  const uint32_t vregC = (is_range) ? inst->VRegC_3rc() : inst->VRegC_35c();
-  Object* receiver = (type == kStatic) ? nullptr : shadow_frame.GetVRegReference(vregC);
+static inline bool DoInvokeMethod(ArtMethod* called_method, Object* receiver,
+                                  Thread* self, ShadowFrame& shadow_frame,
+                                  const Instruction* inst, uint16_t inst_data, JValue* result) {
   ArtMethod* sf_method = shadow_frame.GetMethod();
-  ArtMethod* const called_method = FindMethodFromCode<type, do_access_check>(
-      method_idx, &receiver, sf_method, self);
   // The shadow frame should already be pushed, so we don't need to update it.
   if (UNLIKELY(called_method == nullptr)) {
     CHECK(self->IsExceptionPending());
@@ -664,6 +662,65 @@ static inline bool DoInvoke(Thread* self, ShadowFrame& shadow_frame, const Instr
   }
 }
 
+// Handles invoke-XXX/range instructions (other than invoke-lambda[-range]).
+// Returns true on success, otherwise throws an exception and returns false.
+template<InvokeType type, bool is_range, bool do_access_check>
+static inline bool DoInvoke(Thread* self, ShadowFrame& shadow_frame, const Instruction* inst,
+                            uint16_t inst_data, JValue* result) {
+  const uint32_t method_idx = (is_range) ? inst->VRegB_3rc() : inst->VRegB_35c();
+  const uint32_t vregC = (is_range) ? inst->VRegC_3rc() : inst->VRegC_35c();
+  Object* receiver = (type == kStatic) ? nullptr : shadow_frame.GetVRegReference(vregC);
+  ArtMethod* sf_method = shadow_frame.GetMethod();
+  ArtMethod* called_method = nullptr;
+  // Virtual calls from verified code remember the resolved method of the instruction in the
+  // thread's interpreter cache, so that later executions only need the vtable lookup. The mterp
+  // handlers probe the cache themselves and call DoInvokeVirtualCached() on a hit.
+  constexpr bool kUseInterpreterCache = (type == kVirtual) && !do_access_check;
+  if (kUseInterpreterCache && LIKELY(receiver != nullptr)) {
+    size_t cached_method;
+    if (self->GetInterpreterCache()->Get(inst, &cached_method)) {
+      ArtMethod* resolved_method = reinterpret_cast<ArtMethod*>(cached_method);
+      called_method = receiver->GetClass()->GetVTableEntry(
+          resolved_method->GetMethodIndex(),
+          Runtime::Current()->GetClassLinker()->GetImagePointerSize());
+    }
+  }
+  if (called_method == nullptr) {
+    called_method = FindMethodFromCode<type, do_access_check>(
+        method_idx, &receiver, sf_method, self);
+    if (kUseInterpreterCache && called_method != nullptr) {
+      ArtMethod* resolved_method =
+          Runtime::Current()->GetClassLinker()->GetResolvedMethod(method_idx, sf_method);
+      if (resolved_method != nullptr) {
+        self->GetOrCreateInterpreterCache()->Set(inst,
+                                                 reinterpret_cast<size_t>(resolved_method));
+      }
+    }
+  }
+  return DoInvokeMethod<type, is_range, do_access_check>(called_method, receiver, self,
+                                                         shadow_frame, inst, inst_data, result);
+}
+
+// Handles invoke-virtual and invoke-virtual/range instructions from verified code, given the
+// "resolved_method" cached for the instruction in the thread's interpreter cache.
+// Returns true on success, otherwise throws an exception and returns false.
+template<bool is_range>
+static inline bool DoInvokeVirtualCached(Thread* self, ShadowFrame& shadow_frame,
+                                         const Instruction* inst, uint16_t inst_data,
+                                         ArtMethod* resolved_method, JValue* result) {
+  const uint32_t vregC = (is_range) ? inst->VRegC_3rc() : inst->VRegC_35c();
+  Object* receiver = shadow_frame.GetVRegReference(vregC);
+  if (UNLIKELY(receiver == nullptr)) {
+    // Let the slow path throw the NullPointerException.
+    return DoInvoke<kVirtual, is_range, false>(self, shadow_frame, inst, inst_data, result);
+  }
+  ArtMethod* called_method = receiver->GetClass()->GetVTableEntry(
+      resolved_method->GetMethodIndex(),
+      Runtime::Current()->GetClassLinker()->GetImagePointerSize());
+  return DoInvokeMethod<kVirtual, is_range, false>(called_method, receiver, self, shadow_frame,
+                                                   inst, inst_data, result);
+}
+
 // Handles invoke-virtual-quick and invoke-virtual-quick-range instructions.
 // Returns true on success, otherwise throws an exception and returns false.
 template<bool is_range>
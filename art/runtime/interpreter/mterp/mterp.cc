@@ -258,6 +258,28 @@ extern "C" bool MterpInvokeVirtualQuickRange(Thread* self, ShadowFrame* shadow_f
       self, *shadow_frame, inst, inst_data, result_register);
 }
 
+// Taken by the invoke-virtual{,/range} handlers when the interpreter cache holds the method
+// resolved by an earlier execution of the instruction at "dex_pc_ptr".
+extern "C" bool MterpInvokeVirtualCached(Thread* self, ShadowFrame* shadow_frame,
+                                         uint16_t* dex_pc_ptr,  uint16_t inst_data,
+                                         ArtMethod* resolved_method)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  JValue* result_register = shadow_frame->GetResultRegister();
+  const Instruction* inst = Instruction::At(dex_pc_ptr);
+  return DoInvokeVirtualCached<false>(
+      self, *shadow_frame, inst, inst_data, resolved_method, result_register);
+}
+
+extern "C" bool MterpInvokeVirtualCachedRange(Thread* self, ShadowFrame* shadow_frame,
+                                              uint16_t* dex_pc_ptr,  uint16_t inst_data,
+                                              ArtMethod* resolved_method)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  JValue* result_register = shadow_frame->GetResultRegister();
+  const Instruction* inst = Instruction::At(dex_pc_ptr);
+  return DoInvokeVirtualCached<true>(
+      self, *shadow_frame, inst, inst_data, resolved_method, result_register);
+}
+
 extern "C" void MterpThreadFenceForConstructor() {
   QuasiAtomic::ThreadFenceForConstructor();
 }
@@ -629,6 +651,53 @@ extern "C" mirror::Object* artAGetObjectFromMterp(mirror::Object* arr, int32_t i
   }
 }
 
+// Slow paths of the mterp iget handlers. On success, the offset of the resolved field is
+// recorded in the thread's interpreter cache, and the next execution of the instruction at
+// "dex_pc_ptr" loads the field directly from the assembly handler. Volatile fields are not
+// cached since the fast paths use plain loads.
+extern "C" int8_t artGetByteInstanceFromCode(uint32_t, mirror::Object*, ArtMethod*, Thread*);
+extern "C" uint8_t artGetBooleanInstanceFromCode(uint32_t, mirror::Object*, ArtMethod*, Thread*);
+extern "C" int16_t artGetShortInstanceFromCode(uint32_t, mirror::Object*, ArtMethod*, Thread*);
+extern "C" uint16_t artGetCharInstanceFromCode(uint32_t, mirror::Object*, ArtMethod*, Thread*);
+extern "C" uint32_t artGet32InstanceFromCode(uint32_t, mirror::Object*, ArtMethod*, Thread*);
+extern "C" uint64_t artGet64InstanceFromCode(uint32_t, mirror::Object*, ArtMethod*, Thread*);
+
+template <typename PrimType>
+ALWAYS_INLINE static void MterpCacheInstanceFieldOffset(uint32_t field_idx,
+                                                        ArtMethod* referrer,
+                                                        Thread* self,
+                                                        uint16_t* dex_pc_ptr)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  if (UNLIKELY(self->IsExceptionPending())) {
+    return;
+  }
+  ArtField* field = FindFieldFast(field_idx, referrer, InstancePrimitiveRead, sizeof(PrimType));
+  if (LIKELY(field != nullptr) && !field->IsVolatile()) {
+    self->GetOrCreateInterpreterCache()->Set(dex_pc_ptr, field->GetOffset().Uint32Value());
+  }
+}
+
+#define MTERP_IGET_WITH_CACHE(suffix, type, helper)                                          \
+  extern "C" type MterpIGet##suffix(uint32_t field_idx,                                      \
+                                    mirror::Object* obj,                                     \
+                                    ArtMethod* referrer,                                     \
+                                    Thread* self,                                            \
+                                    uint16_t* dex_pc_ptr)                                    \
+      SHARED_REQUIRES(Locks::mutator_lock_) {                                                \
+    type value = helper(field_idx, obj, referrer, self);                                     \
+    MterpCacheInstanceFieldOffset<type>(field_idx, referrer, self, dex_pc_ptr);              \
+    return value;                                                                            \
+  }
+
+MTERP_IGET_WITH_CACHE(I8, int8_t, artGetByteInstanceFromCode)
+MTERP_IGET_WITH_CACHE(U8, uint8_t, artGetBooleanInstanceFromCode)
+MTERP_IGET_WITH_CACHE(I16, int16_t, artGetShortInstanceFromCode)
+MTERP_IGET_WITH_CACHE(U16, uint16_t, artGetCharInstanceFromCode)
+MTERP_IGET_WITH_CACHE(U32, uint32_t, artGet32InstanceFromCode)
+MTERP_IGET_WITH_CACHE(U64, uint64_t, artGet64InstanceFromCode)
+
+#undef MTERP_IGET_WITH_CACHE
+
 extern "C" mirror::Object* artIGetObjectFromMterp(mirror::Object* obj, uint32_t field_offset)
     SHARED_REQUIRES(Locks::mutator_lock_) {
   if (UNLIKELY(obj == nullptr)) {
@@ -229,6 +229,11 @@ static void VMDebug_dumpHprofData(JNIEnv* env, jclass, jstring javaFilename, job
     }
   }
 
+  Runtime* runtime = Runtime::Current();
+  if (runtime->GetForkedHeapDump()) {
+    hprof::DumpHeapForked(filename.c_str(), fd, runtime->GetCompressHeapDump());
+    return;
+  }
   hprof::DumpHeap(filename.c_str(), fd, false);
 }
 
@@ -113,7 +113,11 @@ enum InlineMethodOpcode : uint16_t {
   kIntrinsicUnsafeFullFence,
 
   kIntrinsicSystemArrayCopyCharArray,
+  kIntrinsicSystemArrayCopyByteArray,
+  kIntrinsicSystemArrayCopyIntArray,
   kIntrinsicSystemArrayCopy,
+  kIntrinsicArraysFillByteArray,
+  kIntrinsicArraysFillIntArray,
 
   kInlineOpNop,
   kInlineOpReturnArg,
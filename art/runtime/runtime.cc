@@ -213,6 +213,8 @@ Runtime::Runtime()
       is_low_memory_mode_(false),
       safe_mode_(false),
       dump_native_stack_on_sig_quit_(true),
+      forked_heap_dump_(false),
+      compress_heap_dump_(false),
       pruned_dalvik_cache_(false),
       // Initially assume we perceive jank in case the process state is never updated.
       process_state_(kProcessStateJankPerceptible),
@@ -933,6 +935,8 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   dex2oat_enabled_ = runtime_options.GetOrDefault(Opt::Dex2Oat);
   image_dex2oat_enabled_ = runtime_options.GetOrDefault(Opt::ImageDex2Oat);
   dump_native_stack_on_sig_quit_ = runtime_options.GetOrDefault(Opt::DumpNativeStackOnSigQuit);
+  forked_heap_dump_ = runtime_options.GetOrDefault(Opt::ForkedHeapDump);
+  compress_heap_dump_ = runtime_options.GetOrDefault(Opt::CompressHeapDump);
 
   vfprintf_ = runtime_options.GetOrDefault(Opt::HookVfprintf);
   exit_ = runtime_options.GetOrDefault(Opt::HookExit);
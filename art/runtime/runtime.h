@@ -623,6 +623,14 @@ class Runtime {
     return dump_native_stack_on_sig_quit_;
   }
 
+  bool GetForkedHeapDump() const {
+    return forked_heap_dump_;
+  }
+
+  bool GetCompressHeapDump() const {
+    return compress_heap_dump_;
+  }
+
   bool GetPrunedDalvikCache() const {
     return pruned_dalvik_cache_;
   }
@@ -863,6 +871,11 @@ class Runtime {
   // Whether threads should dump their native stack on SIGQUIT.
   bool dump_native_stack_on_sig_quit_;
 
+  // Whether hprof heap dumps to files are taken from a forked child, and whether they are
+  // gzip-compressed.
+  bool forked_heap_dump_;
+  bool compress_heap_dump_;
+
   // Whether the dalvik cache was pruned when initializing the runtime.
   bool pruned_dalvik_cache_;
 
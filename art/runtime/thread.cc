@@ -101,6 +101,10 @@ constexpr size_t kStackOverflowProtectedSize = 4 * kMemoryToolStackGuardSizeScal
 
 static const char* kThreadNameDuringStartup = "<native thread without managed peer>";
 
+// The interpreter cache of threads which have not filled their own yet. It is never written to,
+// and its null keys match no dex pc, so mterp can probe it without checking for null.
+static interpreter::InterpreterCache empty_interpreter_cache;
+
 void Thread::InitCardTable() {
   tlsPtr_.card_table = Runtime::Current()->GetHeap()->GetCardTable()->GetBiasedBegin();
 }
@@ -1608,6 +1612,7 @@ Thread::Thread(bool daemon) : tls32_(daemon), wait_monitor_(nullptr), interrupte
   tlsPtr_.instrumentation_stack = new std::deque<instrumentation::InstrumentationStackFrame>;
   tlsPtr_.name = new std::string(kThreadNameDuringStartup);
   tlsPtr_.nested_signal_state = static_cast<jmp_buf*>(malloc(sizeof(jmp_buf)));
+  tlsPtr_.interpreter_cache = &empty_interpreter_cache;
 
   static_assert((sizeof(Thread) % 4) == 0U,
                 "art::Thread has a size which is not a multiple of 4.");
@@ -1628,6 +1633,13 @@ Thread::Thread(bool daemon) : tls32_(daemon), wait_monitor_(nullptr), interrupte
   tls32_.suspended_at_suspend_check = false;
 }
 
+interpreter::InterpreterCache* Thread::GetOrCreateInterpreterCache() {
+  if (UNLIKELY(tlsPtr_.interpreter_cache == &empty_interpreter_cache)) {
+    tlsPtr_.interpreter_cache = new interpreter::InterpreterCache();
+  }
+  return tlsPtr_.interpreter_cache;
+}
+
 bool Thread::IsStillStarting() const {
   // You might think you can check whether the state is kStarting, but for much of thread startup,
   // the thread is in kNative; it might also be in kVmWait.
@@ -1792,6 +1804,9 @@ Thread::~Thread() {
   delete tlsPtr_.name;
   delete tlsPtr_.stack_trace_sample;
   free(tlsPtr_.nested_signal_state);
+  if (tlsPtr_.interpreter_cache != &empty_interpreter_cache) {
+    delete tlsPtr_.interpreter_cache;
+  }
 
   Runtime::Current()->GetHeap()->AssertThreadLocalBuffersAreRevoked(this);
 
@@ -2822,6 +2837,10 @@ class RootCallbackVisitor {
 
 void Thread::VisitRoots(RootVisitor* visitor) {
   const uint32_t thread_id = GetThreadId();
+  // The interpreter cache may point into dex files of classes about to be unloaded.
+  if (tlsPtr_.interpreter_cache != &empty_interpreter_cache) {
+    tlsPtr_.interpreter_cache->Clear();
+  }
   visitor->VisitRootIfNonNull(&tlsPtr_.opeer, RootInfo(kRootThreadObject, thread_id));
   if (tlsPtr_.exception != nullptr && tlsPtr_.exception != GetDeoptimizationException()) {
     visitor->VisitRoot(reinterpret_cast<mirror::Object**>(&tlsPtr_.exception),
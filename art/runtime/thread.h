@@ -35,6 +35,7 @@
 #include "globals.h"
 #include "handle_scope.h"
 #include "instrumentation.h"
+#include "interpreter/interpreter_cache.h"
 #include "jvalue.h"
 #include "object_callbacks.h"
 #include "offsets.h"
@@ -620,6 +621,12 @@ class Thread {
         OFFSETOF_MEMBER(tls_ptr_sized_values, mterp_alt_ibase));
   }
 
+  template<size_t pointer_size>
+  static ThreadOffset<pointer_size> InterpreterCacheOffset() {
+    return ThreadOffsetFromTlsPtr<pointer_size>(
+        OFFSETOF_MEMBER(tls_ptr_sized_values, interpreter_cache));
+  }
+
   template<size_t pointer_size>
   static ThreadOffset<pointer_size> ExceptionOffset() {
     return ThreadOffsetFromTlsPtr<pointer_size>(OFFSETOF_MEMBER(tls_ptr_sized_values, exception));
@@ -1034,6 +1041,14 @@ class Thread {
     tlsPtr_.rosalloc_runs[index] = run;
   }
 
+  size_t GetAllocTrackerBytesUntilSample() const {
+    return tlsPtr_.alloc_tracker_bytes_until_sample;
+  }
+
+  void SetAllocTrackerBytesUntilSample(size_t bytes) {
+    tlsPtr_.alloc_tracker_bytes_until_sample = bytes;
+  }
+
   bool ProtectStack(bool fatal_on_error = true);
   bool UnprotectStack();
 
@@ -1061,6 +1076,15 @@ class Thread {
     return tlsPtr_.mterp_alt_ibase;
   }
 
+  // Returns the cache probed by mterp. Until the thread first fills its own cache, this is an
+  // empty cache shared by all threads, which must not be written to.
+  interpreter::InterpreterCache* GetInterpreterCache() {
+    return tlsPtr_.interpreter_cache;
+  }
+
+  // Returns the thread's own interpreter cache, allocating it on first use.
+  interpreter::InterpreterCache* GetOrCreateInterpreterCache();
+
   void NoteSignalBeingHandled() {
     if (tls32_.handling_signal_) {
       LOG(FATAL) << "Detected signal while processing a signal";
@@ -1356,7 +1380,9 @@ class Thread {
       last_no_thread_suspension_cause(nullptr), thread_local_objects(0),
       thread_local_start(nullptr), thread_local_pos(nullptr), thread_local_end(nullptr),
       mterp_current_ibase(nullptr), mterp_default_ibase(nullptr), mterp_alt_ibase(nullptr),
+      interpreter_cache(nullptr),
       thread_local_alloc_stack_top(nullptr), thread_local_alloc_stack_end(nullptr),
+      alloc_tracker_bytes_until_sample(0),
       nested_signal_state(nullptr), flip_function(nullptr), method_verifier(nullptr),
       thread_local_mark_stack(nullptr) {
       std::fill(held_mutexes, held_mutexes + kLockLevelCount, nullptr);
@@ -1481,6 +1507,9 @@ class Thread {
     void* mterp_default_ibase;
     void* mterp_alt_ibase;
 
+    // Mterp inline caches. Allocated lazily, as most threads never run the interpreter.
+    interpreter::InterpreterCache* interpreter_cache;
+
     // There are RosAlloc::kNumThreadLocalSizeBrackets thread-local size brackets per thread.
     void* rosalloc_runs[kNumRosAllocThreadLocalSizeBracketsInThread];
 
@@ -1488,6 +1517,10 @@ class Thread {
     StackReference<mirror::Object>* thread_local_alloc_stack_top;
     StackReference<mirror::Object>* thread_local_alloc_stack_end;
 
+    // Bytes left to allocate before the allocation tracker records the next sampled allocation
+    // of this thread, 0 when a new distance to the next sample must be drawn.
+    size_t alloc_tracker_bytes_until_sample;
+
     // Support for Mutex lock hierarchy bug detection.
     BaseMutex* held_mutexes[kLockLevelCount];
 
@@ -67,6 +67,7 @@ ThreadList::ThreadList()
       debug_suspend_all_count_(0),
       unregistering_count_(0),
       suspend_all_historam_("suspend all histogram", 16, 64),
+      safepoint_histograms_lock_("safepoint histograms lock"),
       long_suspend_(false) {
   CHECK(Monitor::IsValidLockWord(LockWord::FromThinLockId(kMaxThreadId, 1, 0U)));
 }
@@ -134,11 +135,72 @@ void ThreadList::DumpForSigQuit(std::ostream& os) {
       suspend_all_historam_.PrintConfidenceIntervals(os, 0.99, data);  // Dump time to suspend.
     }
   }
+  DumpTimeToSafepoint(os);
   bool dump_native_stack = Runtime::Current()->GetDumpNativeStackOnSigQuit();
   Dump(os, dump_native_stack);
   DumpUnattachedThreads(os, dump_native_stack);
 }
 
+void ThreadList::RecordTimeToSafepoint(const char* cause, uint64_t duration_ns) {
+  MutexLock mu(Thread::Current(), safepoint_histograms_lock_);
+  auto it = safepoint_histograms_.find(cause);
+  if (it == safepoint_histograms_.end()) {
+    std::string name = StringPrintf("time to safepoint for %s", cause);
+    it = safepoint_histograms_.Put(cause,
+                                   std::unique_ptr<Histogram<uint64_t>>(
+                                       new Histogram<uint64_t>(name.c_str(), 16, 64)));
+  }
+  it->second->AdjustAndAddValue(duration_ns);
+}
+
+void ThreadList::DumpTimeToSafepoint(std::ostream& os) {
+  MutexLock mu(Thread::Current(), safepoint_histograms_lock_);
+  for (const auto& pair : safepoint_histograms_) {
+    const Histogram<uint64_t>& histogram = *pair.second;
+    if (histogram.SampleSize() > 0) {
+      Histogram<uint64_t>::CumulativeData data;
+      histogram.CreateHistogram(&data);
+      histogram.PrintConfidenceIntervals(os, 0.99, data);
+    }
+  }
+}
+
+// Waits until all threads that have "pending_threads" installed as an active suspend barrier
+// have passed it, i.e. until they are all suspended.
+static void WaitForSuspendBarrier(AtomicInteger* pending_threads) {
+  // This wait is done with a timeout so that we can detect problems.
+#if ART_USE_FUTEXES
+  timespec wait_timeout;
+  InitTimeSpec(true, CLOCK_MONOTONIC, 10000, 0, &wait_timeout);
+#endif
+  while (true) {
+    int32_t cur_val = pending_threads->LoadRelaxed();
+    if (LIKELY(cur_val > 0)) {
+#if ART_USE_FUTEXES
+      if (futex(pending_threads->Address(), FUTEX_WAIT, cur_val, &wait_timeout, nullptr, 0) != 0) {
+        // EAGAIN and EINTR both indicate a spurious failure, try again from the beginning.
+        if ((errno != EAGAIN) && (errno != EINTR)) {
+          if (errno == ETIMEDOUT) {
+            LOG(kIsDebugBuild ? FATAL : ERROR) << "Unexpected time out during suspend all.";
+          } else {
+            PLOG(FATAL) << "futex wait failed for SuspendAllInternal()";
+          }
+        }
+      } else {
+        cur_val = pending_threads->LoadRelaxed();
+        CHECK_EQ(cur_val, 0);
+        break;
+      }
+#else
+      // Spin wait. This is likely to be slow, but on most architecture ART_USE_FUTEXES is set.
+#endif
+    } else {
+      CHECK_EQ(cur_val, 0);
+      break;
+    }
+  }
+}
+
 static void DumpUnattachedThread(std::ostream& os, pid_t tid, bool dump_native_stack)
     NO_THREAD_SAFETY_ANALYSIS {
   // TODO: No thread safety analysis as DumpState with a null thread won't access fields, should
@@ -284,7 +346,11 @@ size_t ThreadList::RunCheckpoint(Closure* checkpoint_function) {
   Locks::thread_list_lock_->AssertNotHeld(self);
   Locks::thread_suspend_count_lock_->AssertNotHeld(self);
 
+  const uint64_t start_time = NanoTime();
   std::vector<Thread*> suspended_count_modified_threads;
+  // Threads that raced back to runnable after we raised their suspend count pass this barrier
+  // once they suspend again, so we can wait for them without polling their state.
+  AtomicInteger pending_threads(0);
   size_t count = 0;
   {
     // Call a checkpoint function for each thread, threads which are suspend get their checkpoint
@@ -305,7 +371,17 @@ size_t ThreadList::RunCheckpoint(Closure* checkpoint_function) {
               // Spurious fail, try again.
               continue;
             }
-            thread->ModifySuspendCount(self, +1, nullptr, false);
+            pending_threads.FetchAndAddSequentiallyConsistent(1);
+            if (!thread->ModifySuspendCount(self, +1, &pending_threads, false)) {
+              // No free barrier slot, fall back to polling the thread state below.
+              pending_threads.FetchAndSubSequentiallyConsistent(1);
+              thread->ModifySuspendCount(self, +1, nullptr, false);
+            } else if (thread->IsSuspended()) {
+              // As in SuspendAllInternal, the barrier must be installed before checking the
+              // state to not race with Thread::TransitionFromRunnableToSuspended().
+              thread->ClearSuspendBarrier(&pending_threads);
+              pending_threads.FetchAndSubSequentiallyConsistent(1);
+            }
             suspended_count_modified_threads.push_back(thread);
             break;
           }
@@ -317,6 +393,11 @@ size_t ThreadList::RunCheckpoint(Closure* checkpoint_function) {
   // Run the checkpoint on ourself while we wait for threads to suspend.
   checkpoint_function->Run(self);
 
+  WaitForSuspendBarrier(&pending_threads);
+  if (!suspended_count_modified_threads.empty()) {
+    RecordTimeToSafepoint("checkpoint", NanoTime() - start_time);
+  }
+
   // Run the checkpoint on the suspended threads.
   for (const auto& thread : suspended_count_modified_threads) {
     if (!thread->IsSuspended()) {
@@ -401,6 +482,7 @@ size_t ThreadList::FlipThreadRoots(Closure* thread_flip_visitor,
   CHECK_NE(self->GetState(), kRunnable);
 
   SuspendAllInternal(self, self, nullptr);
+  RecordTimeToSafepoint("thread flip", NanoTime() - start_time);
 
   // Run the flip callback for the collector.
   Locks::mutator_lock_->ExclusiveLock(self);
@@ -496,6 +578,7 @@ void ThreadList::SuspendAll(const char* cause, bool long_suspend) {
     const uint64_t end_time = NanoTime();
     const uint64_t suspend_time = end_time - start_time;
     suspend_all_historam_.AdjustAndAddValue(suspend_time);
+    RecordTimeToSafepoint(cause, suspend_time);
     if (suspend_time > kLongThreadSuspendThreshold) {
       LOG(WARNING) << "Suspending all threads took: " << PrettyDuration(suspend_time);
     }
@@ -590,38 +673,8 @@ void ThreadList::SuspendAllInternal(Thread* self,
     }
   }
 
-  // Wait for the barrier to be passed by all runnable threads. This wait
-  // is done with a timeout so that we can detect problems.
-#if ART_USE_FUTEXES
-  timespec wait_timeout;
-  InitTimeSpec(true, CLOCK_MONOTONIC, 10000, 0, &wait_timeout);
-#endif
-  while (true) {
-    int32_t cur_val = pending_threads.LoadRelaxed();
-    if (LIKELY(cur_val > 0)) {
-#if ART_USE_FUTEXES
-      if (futex(pending_threads.Address(), FUTEX_WAIT, cur_val, &wait_timeout, nullptr, 0) != 0) {
-        // EAGAIN and EINTR both indicate a spurious failure, try again from the beginning.
-        if ((errno != EAGAIN) && (errno != EINTR)) {
-          if (errno == ETIMEDOUT) {
-            LOG(kIsDebugBuild ? FATAL : ERROR) << "Unexpected time out during suspend all.";
-          } else {
-            PLOG(FATAL) << "futex wait failed for SuspendAllInternal()";
-          }
-        }
-      } else {
-        cur_val = pending_threads.LoadRelaxed();
-        CHECK_EQ(cur_val, 0);
-        break;
-      }
-#else
-      // Spin wait. This is likely to be slow, but on most architecture ART_USE_FUTEXES is set.
-#endif
-    } else {
-      CHECK_EQ(cur_val, 0);
-      break;
-    }
-  }
+  // Wait for the barrier to be passed by all runnable threads.
+  WaitForSuspendBarrier(&pending_threads);
 }
 
 void ThreadList::ResumeAll() {
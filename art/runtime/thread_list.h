@@ -23,9 +23,12 @@
 #include "gc_root.h"
 #include "jni.h"
 #include "object_callbacks.h"
+#include "safe_map.h"
 
 #include <bitset>
 #include <list>
+#include <memory>
+#include <string>
 
 namespace art {
 namespace gc {
@@ -178,6 +181,11 @@ class ThreadList {
   void AssertThreadsAreSuspended(Thread* self, Thread* ignore1, Thread* ignore2 = nullptr)
       REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
 
+  // Record the time it took for all threads to reach a safepoint, and dump the recorded times.
+  void RecordTimeToSafepoint(const char* cause, uint64_t duration_ns)
+      REQUIRES(!safepoint_histograms_lock_);
+  void DumpTimeToSafepoint(std::ostream& os) REQUIRES(!safepoint_histograms_lock_);
+
   std::bitset<kMaxThreadId> allocated_ids_ GUARDED_BY(Locks::allocated_thread_ids_lock_);
 
   // The actual list of all threads.
@@ -194,6 +202,12 @@ class ThreadList {
   // by mutator lock ensures no thread can read when another thread is modifying it.
   Histogram<uint64_t> suspend_all_historam_ GUARDED_BY(Locks::mutator_lock_);
 
+  // Time-to-safepoint histograms, keyed by the suspend all cause. Checkpoints and thread flips
+  // are recorded under their own keys.
+  Mutex safepoint_histograms_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  SafeMap<std::string, std::unique_ptr<Histogram<uint64_t>>> safepoint_histograms_
+      GUARDED_BY(safepoint_histograms_lock_);
+
   // Whether or not the current thread suspension is long.
   bool long_suspend_;
 
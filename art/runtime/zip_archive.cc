@@ -17,12 +17,15 @@
 #include "zip_archive.h"
 
 #include <fcntl.h>
+#include <inttypes.h>
 #include <stdio.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 #include <vector>
 
+#include "base/bit_utils.h"
 #include "base/stringprintf.h"
 #include "base/unix_file/fd_file.h"
 
@@ -74,6 +77,65 @@ MemMap* ZipEntry::ExtractToMemMap(const char* zip_filename, const char* entry_fi
   return map.release();
 }
 
+MemMap* ZipEntry::MapDirectlyFromFile(const char* zip_filename, const char* entry_filename,
+                                      std::string* error_msg) {
+  if (!IsUncompressed()) {
+    *error_msg = StringPrintf("Cannot map '%s' (in zip '%s') directly because it is compressed.",
+                              entry_filename,
+                              zip_filename);
+    return nullptr;
+  }
+  if (zip_entry_->uncompressed_length != zip_entry_->compressed_length) {
+    *error_msg = StringPrintf("Cannot map '%s' (in zip '%s') directly because the entry has bad "
+                              "size (%u != %u).",
+                              entry_filename,
+                              zip_filename,
+                              zip_entry_->uncompressed_length,
+                              zip_entry_->compressed_length);
+    return nullptr;
+  }
+  const int zip_fd = GetFileDescriptor(handle_);
+  const off64_t offset = zip_entry_->offset;
+  if (zip_fd < 0 || offset < 0) {
+    *error_msg = StringPrintf("Cannot map '%s' (in zip '%s') directly because of bad offset "
+                              "%" PRId64 " or fd %d.",
+                              entry_filename,
+                              zip_filename,
+                              static_cast<int64_t>(offset),
+                              zip_fd);
+    return nullptr;
+  }
+
+  std::string name(entry_filename);
+  name += " mapped directly in memory from ";
+  name += zip_filename;
+  // MemMap takes care of the offset not being page aligned.
+  std::unique_ptr<MemMap> map(MemMap::MapFileAtAddress(nullptr,
+                                                       GetUncompressedLength(),
+                                                       PROT_READ,
+                                                       MAP_PRIVATE,
+                                                       zip_fd,
+                                                       offset,
+                                                       /* low_4gb */ false,
+                                                       /* reuse */ false,
+                                                       name.c_str(),
+                                                       error_msg));
+  if (map.get() == nullptr) {
+    DCHECK(!error_msg->empty());
+    return nullptr;
+  }
+  return map.release();
+}
+
+bool ZipEntry::IsUncompressed() {
+  return zip_entry_->method == kCompressStored;
+}
+
+bool ZipEntry::IsAlignedTo(size_t alignment) {
+  DCHECK(IsPowerOfTwo(alignment)) << alignment;
+  return IsAlignedParam(zip_entry_->offset, static_cast<int>(alignment));
+}
+
 static void SetCloseOnExec(int fd) {
   // This dance is more portable than Linux's O_CLOEXEC open(2) flag.
   int flags = fcntl(fd, F_GETFD);
@@ -39,11 +39,22 @@ class ZipEntry {
   bool ExtractToFile(File& file, std::string* error_msg);
   MemMap* ExtractToMemMap(const char* zip_filename, const char* entry_filename,
                           std::string* error_msg);
+  // Create a read only, file backed mapping of the entry instead of extracting it. Only valid for
+  // uncompressed (stored) entries. The pages are shared with the page cache, so they are clean
+  // and do not count towards the private dirty memory of the process.
+  MemMap* MapDirectlyFromFile(const char* zip_filename, const char* entry_filename,
+                              std::string* error_msg);
   virtual ~ZipEntry();
 
   uint32_t GetUncompressedLength();
   uint32_t GetCrc32();
 
+  // Return true if the entry is stored without compression.
+  bool IsUncompressed();
+  // Return true if the data of the entry starts at an offset in the zip file that is a multiple
+  // of alignment.
+  bool IsAlignedTo(size_t alignment);
+
  private:
   ZipEntry(ZipArchiveHandle handle,
            ::ZipEntry* zip_entry) : handle_(handle), zip_entry_(zip_entry) {}
@@ -21,14 +21,129 @@
 #include <sys/types.h>
 #include <zlib.h>
 #include <memory>
+#include <vector>
 
 #include "base/unix_file/fd_file.h"
 #include "common_runtime_test.h"
+#include "dex_file.h"
+#include "mem_map.h"
 #include "os.h"
 
 namespace art {
 
-class ZipArchiveTest : public CommonRuntimeTest {};
+static constexpr const char* kEntryName = "classes.dex";
+
+class ZipArchiveTest : public CommonRuntimeTest {
+ protected:
+  static void PutU16(std::vector<uint8_t>* out, uint16_t value) {
+    out->push_back(value & 0xff);
+    out->push_back(value >> 8);
+  }
+
+  static void PutU32(std::vector<uint8_t>* out, uint32_t value) {
+    PutU16(out, value & 0xffff);
+    PutU16(out, value >> 16);
+  }
+
+  static std::vector<uint8_t> Deflate(const std::vector<uint8_t>& data) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    CHECK_EQ(Z_OK, deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+                                Z_DEFAULT_STRATEGY));
+    std::vector<uint8_t> out(deflateBound(&zs, data.size()));
+    zs.next_in = const_cast<uint8_t*>(data.data());
+    zs.avail_in = data.size();
+    zs.next_out = out.data();
+    zs.avail_out = out.size();
+    CHECK_EQ(Z_STREAM_END, deflate(&zs, Z_FINISH));
+    out.resize(zs.total_out);
+    CHECK_EQ(Z_OK, deflateEnd(&zs));
+    return out;
+  }
+
+  // Write a zip file holding kEntryName with the given contents. The data of a stored entry
+  // starts at an offset that is a multiple of 4 if and only if `aligned` is true, which is what
+  // zipalign arranges by padding the extra field of the local file header.
+  static void WriteZip(const std::string& filename,
+                       const std::vector<uint8_t>& data,
+                       bool compressed,
+                       bool aligned) {
+    const uint16_t method = compressed ? 8 /* deflated */ : 0 /* stored */;
+    const std::vector<uint8_t> payload = compressed ? Deflate(data) : data;
+    const uint32_t crc = crc32(crc32(0L, Z_NULL, 0), data.data(), data.size());
+    const uint16_t name_length = strlen(kEntryName);
+    const size_t kLocalHeaderSize = 30;
+    size_t extra_length = (4 - (kLocalHeaderSize + name_length) % 4) % 4;
+    if (!aligned) {
+      extra_length = (extra_length + 1) % 4;
+    }
+
+    std::vector<uint8_t> zip;
+    PutU32(&zip, 0x04034b50);  // Local file header signature.
+    PutU16(&zip, 20);  // Version needed to extract.
+    PutU16(&zip, 0);  // Flags.
+    PutU16(&zip, method);
+    PutU16(&zip, 0);  // Modification time.
+    PutU16(&zip, 0);  // Modification date.
+    PutU32(&zip, crc);
+    PutU32(&zip, payload.size());
+    PutU32(&zip, data.size());
+    PutU16(&zip, name_length);
+    PutU16(&zip, extra_length);
+    zip.insert(zip.end(), kEntryName, kEntryName + name_length);
+    zip.insert(zip.end(), extra_length, 0);
+    zip.insert(zip.end(), payload.begin(), payload.end());
+
+    const uint32_t central_directory_offset = zip.size();
+    PutU32(&zip, 0x02014b50);  // Central directory file header signature.
+    PutU16(&zip, 20);  // Version made by.
+    PutU16(&zip, 20);  // Version needed to extract.
+    PutU16(&zip, 0);  // Flags.
+    PutU16(&zip, method);
+    PutU16(&zip, 0);  // Modification time.
+    PutU16(&zip, 0);  // Modification date.
+    PutU32(&zip, crc);
+    PutU32(&zip, payload.size());
+    PutU32(&zip, data.size());
+    PutU16(&zip, name_length);
+    PutU16(&zip, 0);  // Extra field length.
+    PutU16(&zip, 0);  // Comment length.
+    PutU16(&zip, 0);  // Disk number.
+    PutU16(&zip, 0);  // Internal attributes.
+    PutU32(&zip, 0);  // External attributes.
+    PutU32(&zip, 0);  // Offset of the local file header.
+    zip.insert(zip.end(), kEntryName, kEntryName + name_length);
+    const uint32_t central_directory_size = zip.size() - central_directory_offset;
+
+    PutU32(&zip, 0x06054b50);  // End of central directory signature.
+    PutU16(&zip, 0);  // Disk number.
+    PutU16(&zip, 0);  // Disk with the central directory.
+    PutU16(&zip, 1);  // Entries on this disk.
+    PutU16(&zip, 1);  // Total entries.
+    PutU32(&zip, central_directory_size);
+    PutU32(&zip, central_directory_offset);
+    PutU16(&zip, 0);  // Comment length.
+
+    std::unique_ptr<File> file(OS::CreateEmptyFile(filename.c_str()));
+    ASSERT_TRUE(file.get() != nullptr);
+    ASSERT_TRUE(file->WriteFully(zip.data(), zip.size()));
+    ASSERT_EQ(0, file->FlushCloseOrErase());
+  }
+
+  static std::vector<uint8_t> TestData() {
+    // Compressible, so that the deflated entry is really smaller than the stored one.
+    std::vector<uint8_t> data(3 * kPageSize + 17);
+    for (size_t i = 0; i < data.size(); ++i) {
+      data[i] = static_cast<uint8_t>(i % 61);
+    }
+    return data;
+  }
+
+  static void ExpectContents(const std::vector<uint8_t>& expected, const MemMap& map) {
+    ASSERT_EQ(expected.size(), map.Size());
+    EXPECT_EQ(0, memcmp(expected.data(), map.Begin(), expected.size()));
+  }
+};
 
 TEST_F(ZipArchiveTest, FindAndExtract) {
   std::string error_msg;
@@ -63,4 +178,71 @@ TEST_F(ZipArchiveTest, FindAndExtract) {
   EXPECT_EQ(zip_entry->GetCrc32(), computed_crc);
 }
 
+TEST_F(ZipArchiveTest, MapDirectlyStoredAlignedEntry) {
+  ScratchFile tmp;
+  const std::vector<uint8_t> data = TestData();
+  WriteZip(tmp.GetFilename(), data, /* compressed */ false, /* aligned */ true);
+
+  std::string error_msg;
+  std::unique_ptr<ZipArchive> zip_archive(ZipArchive::Open(tmp.GetFilename().c_str(), &error_msg));
+  ASSERT_TRUE(zip_archive.get() != nullptr) << error_msg;
+  std::unique_ptr<ZipEntry> zip_entry(zip_archive->Find(kEntryName, &error_msg));
+  ASSERT_TRUE(zip_entry.get() != nullptr) << error_msg;
+  EXPECT_TRUE(zip_entry->IsUncompressed());
+  EXPECT_TRUE(zip_entry->IsAlignedTo(alignof(DexFile::Header)));
+
+  std::unique_ptr<MemMap> map(zip_entry->MapDirectlyFromFile(tmp.GetFilename().c_str(),
+                                                             kEntryName,
+                                                             &error_msg));
+  ASSERT_TRUE(map.get() != nullptr) << error_msg;
+  EXPECT_NE(std::string::npos, map->GetName().find("mapped directly")) << map->GetName();
+  ExpectContents(data, *map);
+}
+
+TEST_F(ZipArchiveTest, MapDirectlyCompressedEntryFallsBackToExtraction) {
+  ScratchFile tmp;
+  const std::vector<uint8_t> data = TestData();
+  WriteZip(tmp.GetFilename(), data, /* compressed */ true, /* aligned */ true);
+
+  std::string error_msg;
+  std::unique_ptr<ZipArchive> zip_archive(ZipArchive::Open(tmp.GetFilename().c_str(), &error_msg));
+  ASSERT_TRUE(zip_archive.get() != nullptr) << error_msg;
+  std::unique_ptr<ZipEntry> zip_entry(zip_archive->Find(kEntryName, &error_msg));
+  ASSERT_TRUE(zip_entry.get() != nullptr) << error_msg;
+  EXPECT_FALSE(zip_entry->IsUncompressed());
+
+  std::unique_ptr<MemMap> map(zip_entry->MapDirectlyFromFile(tmp.GetFilename().c_str(),
+                                                             kEntryName,
+                                                             &error_msg));
+  EXPECT_TRUE(map.get() == nullptr);
+  EXPECT_FALSE(error_msg.empty());
+
+  error_msg.clear();
+  map.reset(zip_entry->ExtractToMemMap(tmp.GetFilename().c_str(), kEntryName, &error_msg));
+  ASSERT_TRUE(map.get() != nullptr) << error_msg;
+  EXPECT_NE(std::string::npos, map->GetName().find("extracted in memory")) << map->GetName();
+  ExpectContents(data, *map);
+}
+
+TEST_F(ZipArchiveTest, MapDirectlyMisalignedEntryFallsBackToExtraction) {
+  ScratchFile tmp;
+  const std::vector<uint8_t> data = TestData();
+  WriteZip(tmp.GetFilename(), data, /* compressed */ false, /* aligned */ false);
+
+  std::string error_msg;
+  std::unique_ptr<ZipArchive> zip_archive(ZipArchive::Open(tmp.GetFilename().c_str(), &error_msg));
+  ASSERT_TRUE(zip_archive.get() != nullptr) << error_msg;
+  std::unique_ptr<ZipEntry> zip_entry(zip_archive->Find(kEntryName, &error_msg));
+  ASSERT_TRUE(zip_entry.get() != nullptr) << error_msg;
+  EXPECT_TRUE(zip_entry->IsUncompressed());
+  // DexFile::Open only maps entries that are aligned for its header and extracts the others.
+  EXPECT_FALSE(zip_entry->IsAlignedTo(alignof(DexFile::Header)));
+
+  std::unique_ptr<MemMap> map(zip_entry->ExtractToMemMap(tmp.GetFilename().c_str(),
+                                                         kEntryName,
+                                                         &error_msg));
+  ASSERT_TRUE(map.get() != nullptr) << error_msg;
+  ExpectContents(data, *map);
+}
+
 }  // namespace art
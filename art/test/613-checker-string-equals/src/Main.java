@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+
+  /// CHECK-START: boolean Main.stringEquals(java.lang.String, java.lang.Object) intrinsics_recognition (after)
+  /// CHECK-DAG: <<Result:z\d+>> InvokeStaticOrDirect intrinsic:StringEquals
+  /// CHECK-DAG:                 Return [<<Result>>]
+
+  /// CHECK-START-X86_64: boolean Main.stringEquals(java.lang.String, java.lang.Object) disassembly (after)
+  /// CHECK:                     InvokeStaticOrDirect intrinsic:StringEquals
+  /// CHECK-NOT:                 call
+  /// CHECK:                     pcmpeqw
+  /// CHECK:                     pmovmskb
+  private static boolean stringEquals(String s, Object o) {
+    return s.equals(o);
+  }
+
+  public static void main(String args[]) {
+    expectEquals(false, stringEquals("", null));
+    expectEquals(false, stringEquals("", new Object()));
+    expectEquals(true, stringEquals("", ""));
+    expectEquals(false, stringEquals("a", ""));
+    expectEquals(false, stringEquals("", "a"));
+
+    // Strings shorter than, as long as, and longer than one or several blocks of
+    // eight characters, which differ in a single character or in their length.
+    StringBuilder builder = new StringBuilder();
+    for (int length = 1; length <= 40; ++length) {
+      builder.append((char) ('a' + length % 26));
+      String s = builder.toString();
+      String copy = new String(s.toCharArray());
+      expectEquals(true, stringEquals(s, s));
+      expectEquals(true, stringEquals(s, copy));
+      expectEquals(false, stringEquals(s, s.substring(1)));
+      expectEquals(false, stringEquals(s.substring(1), s));
+      for (int i = 0; i < length; ++i) {
+        char[] chars = s.toCharArray();
+        chars[i] = (char) (chars[i] ^ 0x100);
+        expectEquals(false, stringEquals(s, new String(chars)));
+        chars[i] = (char) (s.charAt(i) ^ 1);
+        expectEquals(false, stringEquals(s, new String(chars)));
+      }
+    }
+
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(boolean expected, boolean result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.util.Arrays;
+
+public class Main {
+
+  /// CHECK-START: void Main.copyBytes(byte[], int, byte[], int, int) intrinsics_recognition (after)
+  /// CHECK:                     InvokeStaticOrDirect intrinsic:SystemArrayCopyByte
+
+  /// CHECK-START-X86_64: void Main.copyBytes(byte[], int, byte[], int, int) disassembly (after)
+  /// CHECK:                     InvokeStaticOrDirect intrinsic:SystemArrayCopyByte
+  /// CHECK-NOT:                 call
+  /// CHECK:                     movsb
+  private static void copyBytes(byte[] src, int srcPos, byte[] dest, int destPos, int length) {
+    System.arraycopy(src, srcPos, dest, destPos, length);
+  }
+
+  /// CHECK-START: void Main.copyInts(int[], int, int[], int, int) intrinsics_recognition (after)
+  /// CHECK:                     InvokeStaticOrDirect intrinsic:SystemArrayCopyInt
+
+  /// CHECK-START-X86_64: void Main.copyInts(int[], int, int[], int, int) disassembly (after)
+  /// CHECK:                     InvokeStaticOrDirect intrinsic:SystemArrayCopyInt
+  /// CHECK-NOT:                 call
+  /// CHECK:                     movsl
+  private static void copyInts(int[] src, int srcPos, int[] dest, int destPos, int length) {
+    System.arraycopy(src, srcPos, dest, destPos, length);
+  }
+
+  /// CHECK-START: void Main.fillBytes(byte[], byte) intrinsics_recognition (after)
+  /// CHECK:                     InvokeStaticOrDirect intrinsic:ArraysFillByte
+
+  /// CHECK-START-X86_64: void Main.fillBytes(byte[], byte) disassembly (after)
+  /// CHECK:                     InvokeStaticOrDirect intrinsic:ArraysFillByte
+  /// CHECK-NOT:                 call
+  /// CHECK:                     stosb
+  private static void fillBytes(byte[] array, byte value) {
+    Arrays.fill(array, value);
+  }
+
+  /// CHECK-START: void Main.fillInts(int[], int) intrinsics_recognition (after)
+  /// CHECK:                     InvokeStaticOrDirect intrinsic:ArraysFillInt
+
+  /// CHECK-START-X86_64: void Main.fillInts(int[], int) disassembly (after)
+  /// CHECK:                     InvokeStaticOrDirect intrinsic:ArraysFillInt
+  /// CHECK-NOT:                 call
+  /// CHECK:                     stosl
+  private static void fillInts(int[] array, int value) {
+    Arrays.fill(array, value);
+  }
+
+  public static void main(String args[]) {
+    for (int length = 0; length <= 40; ++length) {
+      byte[] bytes = new byte[length];
+      int[] ints = new int[length];
+      for (int i = 0; i < length; ++i) {
+        bytes[i] = (byte) (i * 7);
+        ints[i] = i * 0x01010101;
+      }
+
+      // Copy every sub-range into a fresh array, leaving the neighbours untouched.
+      for (int pos = 0; pos <= length; ++pos) {
+        int count = length - pos;
+        byte[] byteCopy = new byte[length + 2];
+        copyBytes(bytes, pos, byteCopy, 1, count);
+        int[] intCopy = new int[length + 2];
+        copyInts(ints, pos, intCopy, 1, count);
+        expectEquals(0, byteCopy[0]);
+        expectEquals(0, byteCopy[count + 1]);
+        expectEquals(0, intCopy[0]);
+        expectEquals(0, intCopy[count + 1]);
+        for (int i = 0; i < count; ++i) {
+          expectEquals(bytes[pos + i], byteCopy[i + 1]);
+          expectEquals(ints[pos + i], intCopy[i + 1]);
+        }
+      }
+
+      // Overlapping copies go through the slow path and must behave like memmove.
+      if (length >= 2) {
+        byte[] byteCopy = bytes.clone();
+        copyBytes(byteCopy, 0, byteCopy, 1, length - 1);
+        int[] intCopy = ints.clone();
+        copyInts(intCopy, 1, intCopy, 0, length - 1);
+        for (int i = 0; i < length - 1; ++i) {
+          expectEquals(bytes[i], byteCopy[i + 1]);
+          expectEquals(ints[i + 1], intCopy[i]);
+        }
+      }
+
+      fillBytes(bytes, (byte) -3);
+      fillInts(ints, 0x12345678);
+      for (int i = 0; i < length; ++i) {
+        expectEquals((byte) -3, bytes[i]);
+        expectEquals(0x12345678, ints[i]);
+      }
+    }
+
+    byte[] bytes = new byte[4];
+    int[] ints = new int[4];
+    try {
+      copyBytes(null, 0, bytes, 0, 1);
+      throw new Error("Expected NullPointerException");
+    } catch (NullPointerException expected) {
+    }
+    try {
+      copyInts(ints, 0, null, 0, 1);
+      throw new Error("Expected NullPointerException");
+    } catch (NullPointerException expected) {
+    }
+    try {
+      copyBytes(bytes, 1, bytes, 0, 4);
+      throw new Error("Expected ArrayIndexOutOfBoundsException");
+    } catch (ArrayIndexOutOfBoundsException expected) {
+    }
+    try {
+      copyInts(ints, 0, ints, 0, -1);
+      throw new Error("Expected ArrayIndexOutOfBoundsException");
+    } catch (ArrayIndexOutOfBoundsException expected) {
+    }
+    try {
+      fillBytes(null, (byte) 0);
+      throw new Error("Expected NullPointerException");
+    } catch (NullPointerException expected) {
+    }
+    try {
+      fillInts(null, 0);
+      throw new Error("Expected NullPointerException");
+    } catch (NullPointerException expected) {
+    }
+
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
@@ -27,6 +27,7 @@ benchmark_cflags := \
 benchmark_cppflags := \
 
 benchmark_src_files := \
+    malloc_benchmark.cpp \
     math_benchmark.cpp \
     property_benchmark.cpp \
     pthread_benchmark.cpp \
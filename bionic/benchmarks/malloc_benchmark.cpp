@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+
+#include <benchmark/benchmark.h>
+
+// These run against whichever allocator libc was built with, so compare a
+// MALLOC_THREAD_CACHE := true build against a default one.
+
+#define MALLOC_SIZES(name) \
+    BENCHMARK(name)->Arg(16)->Arg(64)->Arg(256)->Arg(4096)->ThreadRange(1, 8)
+
+static constexpr size_t kBatchSize = 64;
+
+static void BM_malloc_free(benchmark::State& state) {
+  const size_t size = state.range_x();
+  while (state.KeepRunning()) {
+    free(malloc(size));
+  }
+}
+MALLOC_SIZES(BM_malloc_free);
+
+// Keeps several blocks live at once, so the allocator can't simply hand the
+// same block back every time.
+static void BM_malloc_free_batch(benchmark::State& state) {
+  const size_t size = state.range_x();
+  void* ptrs[kBatchSize];
+  while (state.KeepRunning()) {
+    for (size_t i = 0; i < kBatchSize; ++i) {
+      ptrs[i] = malloc(size);
+    }
+    for (size_t i = 0; i < kBatchSize; ++i) {
+      free(ptrs[i]);
+    }
+  }
+}
+MALLOC_SIZES(BM_malloc_free_batch);
+
+static void BM_calloc_free(benchmark::State& state) {
+  const size_t size = state.range_x();
+  while (state.KeepRunning()) {
+    free(calloc(1, size));
+  }
+}
+MALLOC_SIZES(BM_calloc_free);
+
+// Allocates from call stacks of several different depths, so that with
+// libc.debug.malloc.options=backtrace set, malloc debug records a few
+// distinct backtraces many times over from every thread. Comparing this
+// against a run without the property shows the cost of the option.
+static void* __attribute__((noinline)) MallocAtDepth(size_t depth, size_t size) {
+  void* ptr = (depth == 0) ? malloc(size) : MallocAtDepth(depth - 1, size);
+  // Stop the recursion from becoming a loop.
+  asm volatile("" : : "r"(ptr) : "memory");
+  return ptr;
+}
+
+static void BM_malloc_free_call_stacks(benchmark::State& state) {
+  const size_t size = state.range_x();
+  void* ptrs[kBatchSize];
+  while (state.KeepRunning()) {
+    for (size_t i = 0; i < kBatchSize; ++i) {
+      ptrs[i] = MallocAtDepth(i % 8, size);
+    }
+    for (size_t i = 0; i < kBatchSize; ++i) {
+      free(ptrs[i]);
+    }
+  }
+}
+MALLOC_SIZES(BM_malloc_free_call_stacks);
@@ -17,6 +17,12 @@
 #include <fenv.h>
 #include <math.h>
 
+#include <vector>
+
+#if defined(__BIONIC__)
+#include <android/vmath.h>
+#endif
+
 #include <benchmark/benchmark.h>
 
 static const double values[] = { 1234.0, nan(""), HUGE_VAL, 0.0 };
@@ -227,3 +233,81 @@ static void BM_math_fabs(benchmark::State& state) {
   SetLabel(state);
 }
 BENCHMARK_COMMON_VALS(BM_math_fabs);
+
+#if defined(__BIONIC__)
+// The batch functions against a loop calling the scalar function, over the same inputs.
+#define BENCHMARK_BATCH_SIZES(name) BENCHMARK(name)->Arg(16)->Arg(256)->Arg(4096)
+
+static std::vector<double> BatchInputs(size_t n, double lo, double hi) {
+  std::vector<double> in(n);
+  for (size_t i = 0; i < n; ++i) {
+    in[i] = lo + (hi - lo) * (i + 0.5) / n;
+  }
+  return in;
+}
+
+#define BENCHMARK_BATCH(name, lo, hi) \
+  static void BM_math_##name##_loop(benchmark::State& state) { \
+    std::vector<double> in = BatchInputs(state.range_x(), lo, hi); \
+    std::vector<double> out(in.size()); \
+    while (state.KeepRunning()) { \
+      for (size_t i = 0; i < in.size(); ++i) { \
+        out[i] = name(in[i]); \
+      } \
+    } \
+    d = out[0]; \
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(in.size())); \
+  } \
+  \
+  static void BM_math_v##name(benchmark::State& state) { \
+    std::vector<double> in = BatchInputs(state.range_x(), lo, hi); \
+    std::vector<double> out(in.size()); \
+    while (state.KeepRunning()) { \
+      v##name(&out[0], &in[0], in.size()); \
+    } \
+    d = out[0]; \
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(in.size())); \
+  }
+
+BENCHMARK_BATCH(exp, -10.0, 10.0)
+BENCHMARK_BATCH_SIZES(BM_math_exp_loop);
+BENCHMARK_BATCH_SIZES(BM_math_vexp);
+
+BENCHMARK_BATCH(log, 0.001, 1000.0)
+BENCHMARK_BATCH_SIZES(BM_math_log_loop);
+BENCHMARK_BATCH_SIZES(BM_math_vlog);
+
+BENCHMARK_BATCH(sin, -10.0, 10.0)
+BENCHMARK_BATCH_SIZES(BM_math_sin_loop);
+BENCHMARK_BATCH_SIZES(BM_math_vsin);
+
+BENCHMARK_BATCH(cos, -10.0, 10.0)
+BENCHMARK_BATCH_SIZES(BM_math_cos_loop);
+BENCHMARK_BATCH_SIZES(BM_math_vcos);
+
+static void BM_math_pow_loop(benchmark::State& state) {
+  std::vector<double> x = BatchInputs(state.range_x(), 0.001, 10.0);
+  std::vector<double> y = BatchInputs(state.range_x(), 10.0, -10.0);
+  std::vector<double> out(x.size());
+  while (state.KeepRunning()) {
+    for (size_t i = 0; i < x.size(); ++i) {
+      out[i] = pow(x[i], y[i]);
+    }
+  }
+  d = out[0];
+  state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(x.size()));
+}
+BENCHMARK_BATCH_SIZES(BM_math_pow_loop);
+
+static void BM_math_vpow(benchmark::State& state) {
+  std::vector<double> x = BatchInputs(state.range_x(), 0.001, 10.0);
+  std::vector<double> y = BatchInputs(state.range_x(), 10.0, -10.0);
+  std::vector<double> out(x.size());
+  while (state.KeepRunning()) {
+    vpow(&out[0], &x[0], &y[0], x.size());
+  }
+  d = out[0];
+  state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(x.size()));
+}
+BENCHMARK_BATCH_SIZES(BM_math_vpow);
+#endif
@@ -166,6 +166,51 @@ static void BM_property_find(benchmark::State& state) {
 }
 BENCHMARK(BM_property_find)->TEST_NUM_PROPS;
 
+// Looks up the same property over and over, so every lookup after the first
+// is answered by the lookup cache.
+static void BM_property_find_cached(benchmark::State& state) {
+  const size_t nprops = state.range_x();
+
+  LocalPropertyTestState pa(nprops);
+  if (!pa.valid) return;
+
+  while (state.KeepRunning()) {
+    __system_property_find(pa.names[0]);
+  }
+}
+BENCHMARK(BM_property_find_cached)->TEST_NUM_PROPS;
+
+// Cycles through every property in turn. Once there are more properties than
+// the lookup cache has slots, they keep evicting each other and nearly every
+// lookup walks the prefix list and the trie.
+static void BM_property_find_uncached(benchmark::State& state) {
+  const size_t nprops = state.range_x();
+
+  LocalPropertyTestState pa(nprops);
+  if (!pa.valid) return;
+
+  size_t i = 0;
+  while (state.KeepRunning()) {
+    __system_property_find(pa.names[i]);
+    i = (i + 1) % nprops;
+  }
+}
+BENCHMARK(BM_property_find_uncached)->Arg(128)->Arg(256)->Arg(512);
+
+// Polls a property that doesn't exist, which is the common case for debug
+// properties. The miss stays cached until a property is added.
+static void BM_property_find_missing(benchmark::State& state) {
+  const size_t nprops = state.range_x();
+
+  LocalPropertyTestState pa(nprops);
+  if (!pa.valid) return;
+
+  while (state.KeepRunning()) {
+    __system_property_find("debug.bionic.benchmark.missing");
+  }
+}
+BENCHMARK(BM_property_find_missing)->TEST_NUM_PROPS;
+
 static void BM_property_read(benchmark::State& state) {
   const size_t nprops = state.range_x();
 
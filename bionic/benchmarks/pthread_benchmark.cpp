@@ -95,6 +95,23 @@ static void BM_pthread_mutex_lock_RECURSIVE(benchmark::State& state) {
 }
 BENCHMARK(BM_pthread_mutex_lock_RECURSIVE);
 
+// Shared by all the threads of the contended benchmarks.
+static pthread_mutex_t g_contended_mutex = PTHREAD_MUTEX_INITIALIZER;
+static volatile int g_contended_counter;
+
+// range_x is the length of the critical section, in loop iterations.
+static void BM_pthread_mutex_lock_contended(benchmark::State& state) {
+  const int critical_section = state.range_x();
+  while (state.KeepRunning()) {
+    pthread_mutex_lock(&g_contended_mutex);
+    for (int i = 0; i <= critical_section; ++i) {
+      g_contended_counter = g_contended_counter + 1;
+    }
+    pthread_mutex_unlock(&g_contended_mutex);
+  }
+}
+BENCHMARK(BM_pthread_mutex_lock_contended)->Arg(0)->Arg(100)->Threads(2)->Threads(4)->Threads(8);
+
 static void BM_pthread_rwlock_read(benchmark::State& state) {
   pthread_rwlock_t lock;
   pthread_rwlock_init(&lock, NULL);
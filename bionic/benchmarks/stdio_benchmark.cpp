@@ -17,6 +17,7 @@
 #include <stdio.h>
 #include <stdio_ext.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 #include <benchmark/benchmark.h>
 
@@ -87,3 +88,92 @@ void BM_stdio_fopen_fgets_fclose_no_locking(benchmark::State& state) {
   FopenFgetsFclose(state, true);
 }
 BENCHMARK(BM_stdio_fopen_fgets_fclose_no_locking);
+
+// A temporary file of 80-column lines, for the whole-file reading benchmarks.
+class LineFile {
+ public:
+  LineFile(size_t size) : size_(size) {
+    fp_ = tmpfile();
+    if (fp_ == nullptr) abort();
+    for (size_t i = 0; i < size_; ++i) {
+      putc((i % 80 == 79) ? '\n' : 'a' + (i % 26), fp_);
+    }
+    if (fflush(fp_) != 0) abort();
+  }
+
+  ~LineFile() {
+    fclose(fp_);
+  }
+
+  // Returns a new stream reading the file from the start.
+  FILE* Open() {
+    int fd = dup(fileno(fp_));
+    if (fd == -1 || lseek(fd, 0, SEEK_SET) == -1) abort();
+    FILE* fp = fdopen(fd, "r");
+    if (fp == nullptr) abort();
+    return fp;
+  }
+
+  size_t size() { return size_; }
+
+ private:
+  FILE* fp_;
+  size_t size_;
+};
+
+static void ReadLines(benchmark::State& state, bool no_locking) {
+  LineFile file(4*MB);
+  char buf[1024];
+  while (state.KeepRunning()) {
+    FILE* fp = file.Open();
+    if (no_locking) __fsetlocking(fp, FSETLOCKING_BYCALLER);
+    while (fgets(buf, sizeof(buf), fp) != nullptr) {
+    }
+    fclose(fp);
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(file.size()));
+}
+
+static void BM_stdio_read_lines_locking(benchmark::State& state) {
+  ReadLines(state, false);
+}
+BENCHMARK(BM_stdio_read_lines_locking);
+
+static void BM_stdio_read_lines_no_locking(benchmark::State& state) {
+  ReadLines(state, true);
+}
+BENCHMARK(BM_stdio_read_lines_no_locking);
+
+static void ReadBytes(benchmark::State& state, bool no_locking) {
+  LineFile file(4*MB);
+  while (state.KeepRunning()) {
+    FILE* fp = file.Open();
+    if (no_locking) __fsetlocking(fp, FSETLOCKING_BYCALLER);
+    while (getc(fp) != EOF) {
+    }
+    fclose(fp);
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(file.size()));
+}
+
+static void BM_stdio_read_bytes_locking(benchmark::State& state) {
+  ReadBytes(state, false);
+}
+BENCHMARK(BM_stdio_read_bytes_locking);
+
+static void BM_stdio_read_bytes_no_locking(benchmark::State& state) {
+  ReadBytes(state, true);
+}
+BENCHMARK(BM_stdio_read_bytes_no_locking);
+
+static void BM_stdio_read_bytes_unlocked(benchmark::State& state) {
+  LineFile file(4*MB);
+  while (state.KeepRunning()) {
+    FILE* fp = file.Open();
+    while (getc_unlocked(fp) != EOF) {
+    }
+    fclose(fp);
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(file.size()));
+}
+BENCHMARK(BM_stdio_read_bytes_unlocked);
@@ -15,6 +15,7 @@
  */
 
 #include <stdint.h>
+#include <stdio.h>
 #include <string.h>
 
 #include <benchmark/benchmark.h>
@@ -25,7 +26,34 @@
 #define AT_COMMON_SIZES \
     Arg(8)->Arg(64)->Arg(512)->Arg(1*KB)->Arg(8*KB)->Arg(16*KB)->Arg(32*KB)->Arg(64*KB)
 
-// TODO: test unaligned operation too? (currently everything will be 8-byte aligned by malloc.)
+// Sizes on and just off the vector and threshold boundaries of the
+// optimized implementations, to see every small-size path and the switch
+// to the large copy loops.
+#define AT_SWEEP_SIZES \
+    Arg(1)->Arg(3)->Arg(7)->Arg(15)->Arg(16)->Arg(31)->Arg(32)->Arg(33)->Arg(63)->Arg(64)-> \
+    Arg(65)->Arg(127)->Arg(128)->Arg(129)->Arg(255)->Arg(256)->Arg(257)->Arg(511)-> \
+    Arg(1*KB)->Arg(2*KB - 1)->Arg(2*KB)->Arg(4*KB)->Arg(128*KB)->Arg(1*MB)
+
+// range_y encodes the source and destination misalignment as (src << 8) | dst.
+#define ALIGNMENTS(size) \
+    ArgPair(size, 0x0000)->ArgPair(size, 0x0100)->ArgPair(size, 0x0001)-> \
+    ArgPair(size, 0x0307)->ArgPair(size, 0x1000)->ArgPair(size, 0x001f)
+
+#define AT_ALIGNMENT_SIZES \
+    ALIGNMENTS(64)->ALIGNMENTS(512)->ALIGNMENTS(4*KB)->ALIGNMENTS(64*KB)
+
+// Returns a pointer misaligned by offset bytes from a 64-byte boundary
+// within buf, which needs nbytes + 128 bytes.
+static char* GetMisalignedPtr(char* buf, size_t offset) {
+  uintptr_t aligned = (reinterpret_cast<uintptr_t>(buf) + 63) & ~uintptr_t(63);
+  return reinterpret_cast<char*>(aligned + offset);
+}
+
+static void SetAlignmentLabel(benchmark::State& state, size_t src_offset, size_t dst_offset) {
+  char label[32];
+  snprintf(label, sizeof(label), "src+%zu/dst+%zu", src_offset, dst_offset);
+  state.SetLabel(label);
+}
 
 static void BM_string_memcmp(benchmark::State& state) {
   const size_t nbytes = state.range_x();
@@ -101,3 +129,116 @@ static void BM_string_strlen(benchmark::State& state) {
   delete[] s;
 }
 BENCHMARK(BM_string_strlen)->AT_COMMON_SIZES;
+
+static void BM_string_memcpy_sweep(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  char* src = new char[nbytes]; char* dst = new char[nbytes];
+  memset(src, 'x', nbytes);
+
+  while (state.KeepRunning()) {
+    memcpy(dst, src, nbytes);
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] src;
+  delete[] dst;
+}
+BENCHMARK(BM_string_memcpy_sweep)->AT_SWEEP_SIZES;
+
+static void BM_string_memmove_sweep(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  char* buf = new char[nbytes + 64];
+  memset(buf, 'x', nbytes + 64);
+
+  while (state.KeepRunning()) {
+    memmove(buf + 1, buf, nbytes); // Overlapping, has to copy backwards.
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] buf;
+}
+BENCHMARK(BM_string_memmove_sweep)->AT_SWEEP_SIZES;
+
+static void BM_string_memset_sweep(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  char* dst = new char[nbytes];
+
+  while (state.KeepRunning()) {
+    memset(dst, 0, nbytes);
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] dst;
+}
+BENCHMARK(BM_string_memset_sweep)->AT_SWEEP_SIZES;
+
+static void BM_string_strlen_sweep(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  char* s = new char[nbytes];
+  memset(s, 'x', nbytes);
+  s[nbytes - 1] = 0;
+
+  volatile int c __attribute__((unused)) = 0;
+  while (state.KeepRunning()) {
+    c += strlen(s);
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] s;
+}
+BENCHMARK(BM_string_strlen_sweep)->AT_SWEEP_SIZES;
+
+static void BM_string_memcpy_alignment(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  const size_t src_offset = state.range_y() >> 8;
+  const size_t dst_offset = state.range_y() & 0xff;
+  char* src_buf = new char[nbytes + 128]; char* dst_buf = new char[nbytes + 128];
+  char* src = GetMisalignedPtr(src_buf, src_offset);
+  char* dst = GetMisalignedPtr(dst_buf, dst_offset);
+  memset(src, 'x', nbytes);
+
+  while (state.KeepRunning()) {
+    memcpy(dst, src, nbytes);
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  SetAlignmentLabel(state, src_offset, dst_offset);
+  delete[] src_buf;
+  delete[] dst_buf;
+}
+BENCHMARK(BM_string_memcpy_alignment)->AT_ALIGNMENT_SIZES;
+
+static void BM_string_memset_alignment(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  const size_t dst_offset = state.range_y() & 0xff;
+  char* dst_buf = new char[nbytes + 128];
+  char* dst = GetMisalignedPtr(dst_buf, dst_offset);
+
+  while (state.KeepRunning()) {
+    memset(dst, 0, nbytes);
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  SetAlignmentLabel(state, 0, dst_offset);
+  delete[] dst_buf;
+}
+BENCHMARK(BM_string_memset_alignment)->AT_ALIGNMENT_SIZES;
+
+static void BM_string_strlen_alignment(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  const size_t src_offset = state.range_y() >> 8;
+  char* buf = new char[nbytes + 128];
+  char* s = GetMisalignedPtr(buf, src_offset);
+  memset(s, 'x', nbytes);
+  s[nbytes - 1] = 0;
+
+  volatile int c __attribute__((unused)) = 0;
+  while (state.KeepRunning()) {
+    c += strlen(s);
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  SetAlignmentLabel(state, src_offset, 0);
+  delete[] buf;
+}
+BENCHMARK(BM_string_strlen_alignment)->AT_ALIGNMENT_SIZES;
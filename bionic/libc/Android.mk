@@ -54,6 +54,7 @@ libc_common_src_files := \
     bionic/sigsetmask.c \
     bionic/system_properties_compat.c \
     stdio/fread.c \
+    stdio/makebuf.c \
     stdio/refill.c \
     stdio/snprintf.c\
     stdio/sprintf.c \
@@ -474,7 +475,6 @@ libc_upstream_openbsd_ndk_src_files := \
     upstream-openbsd/lib/libc/stdio/gets.c \
     upstream-openbsd/lib/libc/stdio/getwc.c \
     upstream-openbsd/lib/libc/stdio/getwchar.c \
-    upstream-openbsd/lib/libc/stdio/makebuf.c \
     upstream-openbsd/lib/libc/stdio/mktemp.c \
     upstream-openbsd/lib/libc/stdio/open_memstream.c \
     upstream-openbsd/lib/libc/stdio/open_wmemstream.c \
@@ -636,7 +636,21 @@ ifeq ($(strip $(DEBUG_BIONIC_LIBC)),true)
   libc_common_cflags += -DDEBUG
 endif
 
+# Count contended locks and futex waits in each pthread_mutex_t (LP64 only), so
+# that profiling builds can see which mutexes are hot from a debugger or dump.
+ifeq ($(strip $(BIONIC_MUTEX_CONTENTION_STATS)),true)
+  libc_common_cflags += -DBIONIC_MUTEX_CONTENTION_STATS
+endif
+
 libc_malloc_src := bionic/jemalloc_wrapper.cpp
+
+# Put a per-thread cache of small freed blocks in front of the native
+# allocator (see bionic/malloc_thread_cache.h). Off by default: jemalloc
+# already has its own thread caches.
+ifeq ($(strip $(MALLOC_THREAD_CACHE)),true)
+  libc_common_cflags += -DUSE_MALLOC_THREAD_CACHE
+  libc_malloc_src += bionic/malloc_thread_cache.cpp
+endif
 libc_common_c_includes += external/jemalloc/include
 
 # Define some common conlyflags
@@ -1213,6 +1227,8 @@ LOCAL_CXX_STL := none
 $(eval $(call patch-up-arch-specific-flags,LOCAL_CFLAGS,libc_common_cflags))
 $(eval $(call patch-up-arch-specific-flags,LOCAL_SRC_FILES,libc_common_src_files))
 $(eval $(call patch-up-arch-specific-flags,LOCAL_SRC_FILES,libc_arch_dynamic_src_files))
+# libc_ndk has none of the x86_64 string routines that libc.so picks at load time.
+LOCAL_SRC_FILES_EXCLUDE_x86_64 := $(libc_arch_dynamic_src_files_x86_64)
 $(eval $(call patch-up-arch-specific-flags,LOCAL_ASFLAGS,LOCAL_CFLAGS))
 
 LOCAL_ADDITIONAL_DEPENDENCIES := $(libc_common_additional_dependencies)
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <stddef.h>
+
+#include "private/bionic_x86_cpu_features.h"
+
+// The resolvers below run from libc.so's own IRELATIVE relocations, before
+// the rest of libc is relocated or initialized, so they must not call into
+// libc or touch any of its globals.
+
+extern "C" {
+
+#define DEFINE_IFUNC(name) \
+    name##_func name __attribute__((ifunc(#name "_resolver"))); \
+    __attribute__((visibility("hidden"))) name##_func* name##_resolver()
+
+#define DECLARE_FUNC(type, name) \
+    __attribute__((visibility("hidden"))) type name
+
+typedef void* memcpy_func(void*, const void*, size_t);
+typedef void* memmove_func(void*, const void*, size_t);
+typedef void* memset_func(void*, int, size_t);
+typedef size_t strlen_func(const char*);
+
+DECLARE_FUNC(memcpy_func, memcpy_generic);
+DECLARE_FUNC(memmove_func, memmove_generic);
+DECLARE_FUNC(memmove_func, memmove_avx2);
+DECLARE_FUNC(memmove_func, memmove_avx2_erms);
+DECLARE_FUNC(memset_func, memset_generic);
+DECLARE_FUNC(memset_func, memset_avx2);
+DECLARE_FUNC(memset_func, memset_avx2_erms);
+DECLARE_FUNC(strlen_func, strlen_generic);
+DECLARE_FUNC(strlen_func, strlen_avx2);
+
+// The AVX2 memmove is as fast as a plain copy, so memcpy uses it too.
+DEFINE_IFUNC(memcpy) {
+  x86_cpu_features features = get_x86_cpu_features();
+  if (features.avx2) {
+    return features.erms ? memmove_avx2_erms : memmove_avx2;
+  }
+  return memcpy_generic;
+}
+
+DEFINE_IFUNC(memmove) {
+  x86_cpu_features features = get_x86_cpu_features();
+  if (features.avx2) {
+    return features.erms ? memmove_avx2_erms : memmove_avx2;
+  }
+  return memmove_generic;
+}
+
+DEFINE_IFUNC(memset) {
+  x86_cpu_features features = get_x86_cpu_features();
+  if (features.avx2) {
+    return features.erms ? memset_avx2_erms : memset_avx2;
+  }
+  return memset_generic;
+}
+
+DEFINE_IFUNC(strlen) {
+  return get_x86_cpu_features().avx2 ? strlen_avx2 : strlen_generic;
+}
+
+}  // extern "C"
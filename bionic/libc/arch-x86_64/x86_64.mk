@@ -49,6 +49,22 @@ libc_bionic_src_files_x86_64 += \
     arch-x86_64/string/ssse3-strcmp-slm.S \
     arch-x86_64/string/ssse3-strncmp-slm.S \
 
+#
+# memcpy, memmove, memset and strlen are picked at load time in libc.so. The
+# static libraries always use the generic (slm) versions above.
+#
+
+libc_arch_dynamic_src_files_x86_64 += \
+    arch-x86_64/string/avx2-memmove.S \
+    arch-x86_64/string/avx2-memmove-erms.S \
+    arch-x86_64/string/avx2-memset.S \
+    arch-x86_64/string/avx2-memset-erms.S \
+    arch-x86_64/string/avx2-strlen.S \
+    arch-x86_64/string/dynamic_function_dispatch.cpp \
+
+libc_arch_static_src_files_x86_64 += \
+    arch-x86_64/string/static_function_dispatch.S \
+
 libc_crt_target_cflags_x86_64 += \
     -m64 \
     -I$(LOCAL_PATH)/arch-x86_64/include \
@@ -49,6 +49,15 @@
 #include "jemalloc.h"
 #define Malloc(function)  je_ ## function
 
+// The allocation fast paths optionally go through a per-thread cache first.
+// The dispatch table below always points at the allocator itself.
+#if defined(USE_MALLOC_THREAD_CACHE)
+#include "malloc_thread_cache.h"
+#define MallocFront(function)  tc_ ## function
+#else
+#define MallocFront(function)  Malloc(function)
+#endif
+
 static constexpr MallocDispatch __libc_malloc_default_dispatch
   __attribute__((unused)) = {
     Malloc(calloc),
@@ -81,7 +90,7 @@ extern "C" void* calloc(size_t n_elements, size_t elem_size) {
   if (__predict_false(_calloc != nullptr)) {
     return _calloc(n_elements, elem_size);
   }
-  return Malloc(calloc)(n_elements, elem_size);
+  return MallocFront(calloc)(n_elements, elem_size);
 }
 
 extern "C" void free(void* mem) {
@@ -89,7 +98,7 @@ extern "C" void free(void* mem) {
   if (__predict_false(_free != nullptr)) {
     _free(mem);
   } else {
-    Malloc(free)(mem);
+    MallocFront(free)(mem);
   }
 }
 
@@ -106,7 +115,7 @@ extern "C" void* malloc(size_t bytes) {
   if (__predict_false(_malloc != nullptr)) {
     return _malloc(bytes);
   }
-  return Malloc(malloc)(bytes);
+  return MallocFront(malloc)(bytes);
 }
 
 extern "C" size_t malloc_usable_size(const void* mem) {
@@ -184,6 +193,7 @@ static void (*g_debug_finalize_func)();
 static void (*g_debug_get_malloc_leak_info_func)(uint8_t**, size_t*, size_t*, size_t*, size_t*);
 static void (*g_debug_free_malloc_leak_info_func)(uint8_t*);
 static ssize_t (*g_debug_malloc_backtrace_func)(void*, uintptr_t*, size_t);
+static bool (*g_debug_dump_heap_profile_func)(int);
 
 // =============================================================================
 // Log functions
@@ -374,6 +384,14 @@ static void malloc_init_impl(libc_globals* globals) {
     return;
   }
 
+  void* dump_heap_profile_sym = dlsym(malloc_impl_handle, "debug_dump_heap_profile");
+  if (dump_heap_profile_sym == nullptr) {
+    error_log("%s: debug_dump_heap_profile routine not found in %s", getprogname(),
+              DEBUG_SHARED_LIB);
+    dlclose(malloc_impl_handle);
+    return;
+  }
+
   if (!init_func(&__libc_malloc_default_dispatch, &gMallocLeakZygoteChild)) {
     dlclose(malloc_impl_handle);
     return;
@@ -393,6 +411,7 @@ static void malloc_init_impl(libc_globals* globals) {
   g_debug_free_malloc_leak_info_func = reinterpret_cast<void (*)(uint8_t*)>(free_leak_info_sym);
   g_debug_malloc_backtrace_func = reinterpret_cast<ssize_t (*)(
       void*, uintptr_t*, size_t)>(malloc_backtrace_sym);
+  g_debug_dump_heap_profile_func = reinterpret_cast<bool (*)(int)>(dump_heap_profile_sym);
 
   globals->malloc_dispatch = malloc_dispatch_table;
   libc_malloc_impl_handle = malloc_impl_handle;
@@ -462,3 +481,22 @@ extern "C" ssize_t malloc_backtrace(void*, uintptr_t*, size_t) {
   return 0;
 }
 #endif
+
+// =============================================================================
+// Exported for use by heap profiling tools.
+// =============================================================================
+
+// Writes a heap profile of the allocations sampled by malloc debug's
+// sample_rate option to fd. Returns false if sampling isn't enabled.
+#ifndef LIBC_STATIC
+extern "C" bool malloc_dump_heap_profile(int fd) {
+  if (g_debug_dump_heap_profile_func == nullptr) {
+    return false;
+  }
+  return g_debug_dump_heap_profile_func(fd);
+}
+#else
+extern "C" bool malloc_dump_heap_profile(int) {
+  return false;
+}
+#endif
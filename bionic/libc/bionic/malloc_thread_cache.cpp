@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "malloc_thread_cache.h"
+
+#include <string.h>
+
+#include "jemalloc.h"
+#include "pthread_internal.h"
+
+// The allocator behind the cache.
+#define Backend(function)  je_ ## function
+
+// Every block in bins[i] has a usable size of at least ClassSize(i), so any of
+// them can satisfy a request that rounds up to that class.
+static constexpr size_t ClassSize(size_t index) {
+  return (index + 1) * MallocThreadCache::kQuantum;
+}
+
+static constexpr uint32_t MaxBinCount(size_t index) {
+  return MallocThreadCache::kMaxBinBytes / ClassSize(index);
+}
+
+static inline MallocThreadCache* GetCache() {
+  // malloc can be called before the main thread's TLS is set up.
+  pthread_internal_t* thread = __get_thread();
+  return __predict_true(thread != nullptr) ? &thread->malloc_cache : nullptr;
+}
+
+static void ReleaseBlocks(MallocThreadCacheBin* bin, uint32_t count) {
+  for (uint32_t i = 0; i < count; ++i) {
+    void* block = bin->head;
+    bin->head = *reinterpret_cast<void**>(block);
+    Backend(free)(block);
+  }
+  bin->count -= count;
+}
+
+void* tc_malloc(size_t bytes) {
+  MallocThreadCache* cache = GetCache();
+  if (__predict_false(bytes > MallocThreadCache::kMaxSize || cache == nullptr)) {
+    return Backend(malloc)(bytes);
+  }
+  size_t index = (bytes == 0) ? 0 : (bytes - 1) / MallocThreadCache::kQuantum;
+  MallocThreadCacheBin* bin = &cache->bins[index];
+  void* block = bin->head;
+  if (block != nullptr) {
+    bin->head = *reinterpret_cast<void**>(block);
+    --bin->count;
+    return block;
+  }
+  // Ask for the whole class so that the block comes back to this bin when freed.
+  return Backend(malloc)(ClassSize(index));
+}
+
+void* tc_calloc(size_t n_elements, size_t elem_size) {
+  size_t bytes;
+  if (__builtin_mul_overflow(n_elements, elem_size, &bytes) ||
+      bytes > MallocThreadCache::kMaxSize) {
+    return Backend(calloc)(n_elements, elem_size);
+  }
+  void* block = tc_malloc(bytes);
+  if (block != nullptr) {
+    memset(block, 0, bytes);
+  }
+  return block;
+}
+
+void tc_free(void* mem) {
+  if (mem == nullptr) {
+    return;
+  }
+  MallocThreadCache* cache = GetCache();
+  size_t usable_size = Backend(malloc_usable_size)(mem);
+  if (__predict_false(usable_size < MallocThreadCache::kQuantum ||
+                      usable_size > MallocThreadCache::kMaxSize || cache == nullptr)) {
+    Backend(free)(mem);
+    return;
+  }
+  // File the block under the largest class it can satisfy.
+  size_t index = usable_size / MallocThreadCache::kQuantum - 1;
+  MallocThreadCacheBin* bin = &cache->bins[index];
+  if (__predict_false(bin->count >= MaxBinCount(index))) {
+    // Trim the bin first so that the block being freed, the most likely to
+    // still be in the CPU caches, is the next one handed out.
+    ReleaseBlocks(bin, bin->count / 2);
+  }
+  *reinterpret_cast<void**>(mem) = bin->head;
+  bin->head = mem;
+  ++bin->count;
+}
+
+void __malloc_thread_cache_flush(MallocThreadCache* cache) {
+  for (size_t i = 0; i < MallocThreadCache::kClassCount; ++i) {
+    ReleaseBlocks(&cache->bins[i], cache->bins[i].count);
+  }
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef LIBC_BIONIC_MALLOC_THREAD_CACHE_H_
+#define LIBC_BIONIC_MALLOC_THREAD_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+// An optional per-thread cache of small freed blocks that sits in front of the
+// native allocator, enabled by building with MALLOC_THREAD_CACHE := true. A
+// malloc or free that hits the cache doesn't touch the allocator (or its lock)
+// at all. The cached blocks are ordinary allocator blocks, so everything else
+// (realloc, malloc_usable_size, malloc_iterate, ...) keeps calling straight
+// through. Blocks sitting in a cache still count as allocated in mallinfo.
+
+struct MallocThreadCacheBin {
+  void* head;
+  uint32_t count;
+};
+
+struct MallocThreadCache {
+  // Blocks up to kMaxSize bytes are cached, in size classes kQuantum apart.
+  static constexpr size_t kQuantum = 16;
+  static constexpr size_t kClassCount = 16;
+  static constexpr size_t kMaxSize = kQuantum * kClassCount;
+  // A bin that grows past this many bytes returns half of its blocks to the
+  // allocator in one go.
+  static constexpr size_t kMaxBinBytes = 1024;
+
+  MallocThreadCacheBin bins[kClassCount];
+};
+
+__LIBC_HIDDEN__ void* tc_calloc(size_t n_elements, size_t elem_size);
+__LIBC_HIDDEN__ void tc_free(void* mem);
+__LIBC_HIDDEN__ void* tc_malloc(size_t bytes);
+
+// Returns all the blocks cached by an exiting thread to the allocator.
+__LIBC_HIDDEN__ void __malloc_thread_cache_flush(MallocThreadCache* cache);
+
+#endif  // LIBC_BIONIC_MALLOC_THREAD_CACHE_H_
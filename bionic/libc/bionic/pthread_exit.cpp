@@ -79,6 +79,11 @@ void pthread_exit(void* return_value) {
   // space (see pthread_key_delete).
   pthread_key_clean_all();
 
+#if defined(USE_MALLOC_THREAD_CACHE)
+  // Nothing below allocates, so this thread's cached blocks can go back now.
+  __malloc_thread_cache_flush(&thread->malloc_cache);
+#endif
+
   if (thread->alternate_signal_stack != NULL) {
     // Tell the kernel to stop using the alternate signal stack.
     stack_t ss;
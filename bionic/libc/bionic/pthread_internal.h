@@ -34,6 +34,10 @@
 #include "private/bionic_lock.h"
 #include "private/bionic_tls.h"
 
+#if defined(USE_MALLOC_THREAD_CACHE)
+#include "malloc_thread_cache.h"
+#endif
+
 /* Has the thread been detached by a pthread_join or pthread_detach call? */
 #define PTHREAD_ATTR_FLAG_DETACHED 0x00000001
 
@@ -104,6 +108,10 @@ class pthread_internal_t {
 
   pthread_key_data_t key_data[BIONIC_PTHREAD_KEY_COUNT];
 
+#if defined(USE_MALLOC_THREAD_CACHE)
+  MallocThreadCache malloc_cache;
+#endif
+
   /*
    * The dynamic linker implements dlerror(3), which makes it hard for us to implement this
    * per-thread buffer by simply using malloc(3) and free(3).
@@ -220,7 +220,18 @@ struct pthread_mutex_internal_t {
 #if defined(__LP64__)
   uint16_t __pad;
   atomic_int owner_tid;
-  char __reserved[32];
+  // Recent number of spins needed to get the mutex, in eighths of a spin, see
+  // __pthread_normal_mutex_spin.
+  _Atomic(uint16_t) spin_estimate;
+  uint16_t __pad2;
+#if defined(BIONIC_MUTEX_CONTENTION_STATS)
+  // Number of lock calls that found the mutex held, and how many times they slept.
+  atomic_uint contended_count;
+  atomic_uint sleep_count;
+  char __reserved[20];
+#else
+  char __reserved[28];
+#endif
 #else
   _Atomic(uint16_t) owner_tid;
 #endif
@@ -285,6 +296,72 @@ static inline __always_inline int __pthread_normal_mutex_trylock(pthread_mutex_i
     return EBUSY;
 }
 
+static inline __always_inline void __cpu_relax() {
+#if defined(__i386__) || defined(__x86_64__)
+    __asm__ __volatile__("pause" ::: "memory");
+#elif defined(__arm__) || defined(__aarch64__)
+    __asm__ __volatile__("yield" ::: "memory");
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+// Bounds for the number of __cpu_relax() iterations spent waiting for a contended normal mutex
+// before sleeping in the kernel.
+#define MUTEX_MIN_SPINS 10
+#define MUTEX_MAX_SPINS 100
+
+/*
+ * Spin for a while waiting for the owner of a normal mutex to release it, since a
+ * short critical section ends long before a futex wait and wake would. On LP64 the
+ * bound follows how long lockers recently had to spin for this mutex (like glibc's
+ * adaptive mutexes); on 32-bit there is no room in the mutex for that, so the
+ * minimum is used.
+ *
+ * Returns true if the mutex was acquired.
+ */
+static inline __always_inline bool __pthread_normal_mutex_spin(pthread_mutex_internal_t* mutex,
+                                                               uint16_t shared) {
+    const uint16_t unlocked           = shared | MUTEX_STATE_BITS_UNLOCKED;
+    const uint16_t locked_uncontended = shared | MUTEX_STATE_BITS_LOCKED_UNCONTENDED;
+
+#if defined(__LP64__)
+    // The estimate is kept in fixed point, with 3 fractional bits.
+    int estimate = atomic_load_explicit(&mutex->spin_estimate, memory_order_relaxed);
+    int max_spins = (estimate >> 2) + MUTEX_MIN_SPINS;
+    if (max_spins > MUTEX_MAX_SPINS) {
+        max_spins = MUTEX_MAX_SPINS;
+    }
+#else
+    int max_spins = MUTEX_MIN_SPINS;
+#endif
+
+    bool acquired = false;
+    int spins = 0;
+    while (spins < max_spins) {
+        ++spins;
+        __cpu_relax();
+        // Only try the CAS once the mutex looks free, to keep its cache line shared meanwhile.
+        uint16_t old_state = atomic_load_explicit(&mutex->state, memory_order_relaxed);
+        if (old_state == unlocked &&
+            atomic_compare_exchange_weak_explicit(&mutex->state, &old_state, locked_uncontended,
+                                                  memory_order_acquire, memory_order_relaxed)) {
+            acquired = true;
+            break;
+        }
+    }
+
+#if defined(__LP64__)
+    // Move the estimate an eighth of the way to this attempt. A failed attempt raises it, in
+    // case the owner was only slightly slower than the current bound. Thanks to the fixed point
+    // the estimate does not get stuck below a steady number of spins, as a truncating
+    // integer division would let it.
+    atomic_store_explicit(&mutex->spin_estimate, estimate - (estimate >> 3) + spins,
+                          memory_order_relaxed);
+#endif
+    return acquired;
+}
+
 /*
  * Lock a mutex of type NORMAL.
  *
@@ -309,6 +386,14 @@ static inline __always_inline int __pthread_normal_mutex_lock(pthread_mutex_inte
         return result;
     }
 
+#if defined(__LP64__) && defined(BIONIC_MUTEX_CONTENTION_STATS)
+    atomic_fetch_add_explicit(&mutex->contended_count, 1, memory_order_relaxed);
+#endif
+
+    if (__pthread_normal_mutex_spin(mutex, shared)) {
+        return 0;
+    }
+
     ScopedTrace trace("Contending for pthread mutex");
 
     const uint16_t unlocked           = shared | MUTEX_STATE_BITS_UNLOCKED;
@@ -324,6 +409,9 @@ static inline __always_inline int __pthread_normal_mutex_lock(pthread_mutex_inte
     // made by other threads visible to the current CPU.
     while (atomic_exchange_explicit(&mutex->state, locked_contended,
                                     memory_order_acquire) != unlocked) {
+#if defined(__LP64__) && defined(BIONIC_MUTEX_CONTENTION_STATS)
+        atomic_fetch_add_explicit(&mutex->sleep_count, 1, memory_order_relaxed);
+#endif
         if (__futex_wait_ex(&mutex->state, shared, locked_contended, use_realtime_clock,
                             abs_timeout_or_null) == -ETIMEDOUT) {
             return ETIMEDOUT;
@@ -56,6 +56,7 @@
 #include "private/bionic_futex.h"
 #include "private/bionic_lock.h"
 #include "private/bionic_macros.h"
+#include "private/bionic_property_contexts.h"
 #include "private/libc_logging.h"
 
 static const char property_service_socket[] = "/dev/socket/" PROP_SERVICE_NAME;
@@ -672,39 +673,11 @@ private:
     bool no_access_;
 };
 
-struct prefix_node {
-    prefix_node(struct prefix_node* next, const char* prefix, context_node* context)
-        : prefix(strdup(prefix)), prefix_len(strlen(prefix)), context(context), next(next) {
-    }
-    ~prefix_node() {
-        free(prefix);
-    }
-    char* prefix;
-    const size_t prefix_len;
-    context_node* context;
-    struct prefix_node* next;
-};
-
 template <typename List, typename... Args>
 static inline void list_add(List** list, Args... args) {
     *list = new List(*list, args...);
 }
 
-static void list_add_after_len(prefix_node** list, const char* prefix, context_node* context) {
-    size_t prefix_len = strlen(prefix);
-
-    auto next_list = list;
-
-    while (*next_list) {
-        if ((*next_list)->prefix_len < prefix_len || (*next_list)->prefix[0] == '*') {
-            list_add(next_list, prefix, context);
-            return;
-        }
-        next_list = &(*next_list)->next;
-    }
-    list_add(next_list, prefix, context);
-}
-
 template <typename List, typename Func>
 static void list_foreach(List* list, Func func) {
     while (list) {
@@ -713,17 +686,6 @@ static void list_foreach(List* list, Func func) {
     }
 }
 
-template <typename List, typename Func>
-static List* list_find(List* list, Func func) {
-    while (list) {
-        if (func(list)) {
-            return list;
-        }
-        list = list->next;
-    }
-    return nullptr;
-}
-
 template <typename List>
 static void list_free(List** list) {
     while (*list) {
@@ -733,8 +695,11 @@ static void list_free(List** list) {
     }
 }
 
-static prefix_node* prefixes = nullptr;
+static contexts_table* prop_contexts = nullptr;
+static bool prop_contexts_mapped = false;
 static context_node* contexts = nullptr;
+// The context_node for each of the table's contexts, by index.
+static context_node** context_nodes = nullptr;
 
 /*
  * pthread_mutex_lock() calls into system_properties in the case of contention.
@@ -829,14 +794,15 @@ static bool map_system_property_area(bool access_rw, bool* fsetxattr_failed) {
 }
 
 static prop_area* get_prop_area_for_name(const char* name) {
-    auto entry = list_find(prefixes, [name](prefix_node* l) {
-        return l->prefix[0] == '*' || !strncmp(l->prefix, name, l->prefix_len);
-    });
-    if (!entry) {
+    if (!prop_contexts) {
+        return nullptr;
+    }
+    uint32_t context = find_context(prop_contexts, name);
+    if (context == CONTEXTS_TABLE_NONE) {
         return nullptr;
     }
 
-    auto cnode = entry->context;
+    auto cnode = context_nodes[context];
     if (!cnode->pa()) {
         /*
          * We explicitly do not check no_access_ in this case because unlike the
@@ -848,6 +814,100 @@ static prop_area* get_prop_area_for_name(const char* name) {
     return cnode->pa();
 }
 
+/*
+ * A small direct-mapped cache in front of __system_property_find(), so that
+ * code polling a property in a loop doesn't walk the prefix list and the trie
+ * on every call. Slots are picked by a hash of the name and keep a copy of it.
+ *
+ * A cached prop_info* stays good for as long as its area is mapped, because
+ * properties are never removed. A cached miss is only good while the global
+ * area serial, which every add bumps, is unchanged.
+ *
+ * Like a prop_info, each slot is guarded by a sequence number that is odd
+ * while the slot is being written, so readers never block (see the comment
+ * about pthread_mutex_lock() above). A writer that finds its slot busy just
+ * doesn't cache its result.
+ */
+#define PROP_CACHE_SIZE 64
+
+struct prop_cache_entry {
+    atomic_uint_least32_t seq;
+    atomic_uint_least32_t area_serial;
+    _Atomic(const prop_info*) pi;
+    char name[PROP_NAME_MAX];
+};
+
+static prop_cache_entry prop_cache[PROP_CACHE_SIZE];
+
+// FNV-1a, which also hands back the length of the name.
+static uint32_t prop_name_hash(const char* name, size_t* namelen) {
+    uint32_t hash = 2166136261u;
+    const char* p = name;
+    while (*p) {
+        hash = (hash ^ static_cast<uint8_t>(*p++)) * 16777619u;
+    }
+    *namelen = p - name;
+    return hash;
+}
+
+static bool prop_cache_find(const char* name, uint32_t hash, const prop_info** pi) {
+    prop_cache_entry* entry = &prop_cache[hash % PROP_CACHE_SIZE];
+    uint_least32_t seq = atomic_load_explicit(&entry->seq, memory_order_acquire);
+    if (seq & 1) {
+        return false;
+    }
+    // The name can be torn by a concurrent writer, but then seq changes too.
+    bool match = strncmp(entry->name, name, PROP_NAME_MAX) == 0;
+    const prop_info* cached_pi = atomic_load_explicit(&entry->pi, memory_order_relaxed);
+    uint32_t area_serial = atomic_load_explicit(&entry->area_serial, memory_order_relaxed);
+    atomic_thread_fence(memory_order_acquire);
+    if (!match || seq != atomic_load_explicit(&entry->seq, memory_order_relaxed)) {
+        return false;
+    }
+    if (cached_pi == nullptr && area_serial != __system_property_area_serial()) {
+        return false;
+    }
+    *pi = cached_pi;
+    return true;
+}
+
+static void prop_cache_fill(prop_cache_entry* entry, const char* name, size_t namelen,
+                            const prop_info* pi, uint32_t area_serial, uint_least32_t seq) {
+    // Pretend, as __system_property_update() does, that the memcpy uses
+    // relaxed atomics.
+    atomic_thread_fence(memory_order_release);
+    memcpy(entry->name, name, namelen + 1);
+    atomic_store_explicit(&entry->pi, pi, memory_order_relaxed);
+    atomic_store_explicit(&entry->area_serial, area_serial, memory_order_relaxed);
+    atomic_store_explicit(&entry->seq, seq + 2, memory_order_release);
+}
+
+static void prop_cache_add(const char* name, size_t namelen, uint32_t hash,
+                           const prop_info* pi, uint32_t area_serial) {
+    prop_cache_entry* entry = &prop_cache[hash % PROP_CACHE_SIZE];
+    uint_least32_t seq = atomic_load_explicit(&entry->seq, memory_order_relaxed);
+    if ((seq & 1) || !atomic_compare_exchange_strong_explicit(&entry->seq, &seq, seq + 1,
+                                                              memory_order_relaxed,
+                                                              memory_order_relaxed)) {
+        return;
+    }
+    prop_cache_fill(entry, name, namelen, pi, area_serial, seq);
+}
+
+// Called whenever an area might be unmapped, since that leaves cached
+// prop_info pointers dangling.
+static void prop_cache_clear() {
+    for (prop_cache_entry& entry : prop_cache) {
+        uint_least32_t seq;
+        do {
+            seq = atomic_load_explicit(&entry.seq, memory_order_relaxed) & ~1u;
+        } while (!atomic_compare_exchange_weak_explicit(&entry.seq, &seq, seq + 1,
+                                                        memory_order_relaxed,
+                                                        memory_order_relaxed));
+        prop_cache_fill(&entry, "", 0, nullptr, 0, seq);
+    }
+}
+
 /*
  * The below two functions are duplicated from label_support.c in libselinux.
  * TODO: Find a location suitable for these functions such that both libc and
@@ -941,7 +1001,7 @@ static int read_spec_entries(char *line_buf, int num_args, ...)
     return items;
 }
 
-static bool initialize_properties() {
+static bool parse_property_contexts() {
     FILE* file = fopen("/property_contexts", "re");
 
     if (!file) {
@@ -952,6 +1012,10 @@ static bool initialize_properties() {
     size_t line_len;
     char* prop_prefix = nullptr;
     char* context = nullptr;
+    context_spec* specs = nullptr;
+    size_t num_specs = 0;
+    size_t capacity = 0;
+    bool ok = true;
 
     while (getline(&buffer, &line_len, file) > 0) {
         int items = read_spec_entries(buffer, 2, &prop_prefix, &context);
@@ -973,20 +1037,95 @@ static bool initialize_properties() {
             continue;
         }
 
-        auto old_context = list_find(
-            contexts, [context](context_node* l) { return !strcmp(l->context(), context); });
-        if (old_context) {
-            list_add_after_len(&prefixes, prop_prefix, old_context);
-        } else {
-            list_add(&contexts, context, nullptr);
-            list_add_after_len(&prefixes, prop_prefix, contexts);
+        if (num_specs == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            void* new_specs = realloc(specs, capacity * sizeof(context_spec));
+            if (!new_specs) {
+                free(prop_prefix);
+                free(context);
+                ok = false;
+                break;
+            }
+            specs = static_cast<context_spec*>(new_specs);
         }
-        free(prop_prefix);
-        free(context);
+        specs[num_specs].prefix = prop_prefix;
+        specs[num_specs].context = context;
+        specs[num_specs].line = num_specs;
+        ++num_specs;
     }
 
     free(buffer);
     fclose(file);
+
+    if (ok) {
+        prop_contexts = build_contexts_table(specs, num_specs);
+        prop_contexts_mapped = false;
+        ok = prop_contexts != nullptr;
+    }
+    for (size_t i = 0; i < num_specs; ++i) {
+        free(specs[i].prefix);
+        free(specs[i].context);
+    }
+    free(specs);
+    return ok;
+}
+
+// Maps in the table written by init, if there is one.
+static bool map_contexts_table() {
+    char filename[PROP_FILENAME_MAX];
+    int len = __libc_format_buffer(filename, sizeof(filename),
+                                   "%s/property_contexts", property_filename);
+    if (len < 0 || len > PROP_FILENAME_MAX) {
+        return false;
+    }
+
+    contexts_table* table = map_contexts_table_file(filename, 0, 0);
+    if (!table) {
+        return false;
+    }
+    prop_contexts = table;
+    prop_contexts_mapped = true;
+    return true;
+}
+
+/*
+ * Writes prop_contexts out for other processes to map. It gets the same label
+ * as properties_serial, which every process can already read.
+ */
+static bool write_contexts_table(bool* fsetxattr_failed) {
+    char filename[PROP_FILENAME_MAX];
+    char tmp_filename[PROP_FILENAME_MAX];
+    int len = __libc_format_buffer(filename, sizeof(filename),
+                                   "%s/property_contexts", property_filename);
+    int tmp_len = __libc_format_buffer(tmp_filename, sizeof(tmp_filename),
+                                       "%s/property_contexts.tmp", property_filename);
+    if (len < 0 || len > PROP_FILENAME_MAX || tmp_len < 0 || tmp_len > PROP_FILENAME_MAX) {
+        return false;
+    }
+
+    const char* context = "u:object_r:properties_serial:s0";
+    bool label_failed = false;
+    bool result = write_contexts_table_file(prop_contexts, filename, tmp_filename, context,
+                                            &label_failed);
+    if (label_failed) {
+        __libc_format_log(ANDROID_LOG_ERROR, "libc",
+                          "fsetxattr failed to set context (%s) for \"%s\"", context, tmp_filename);
+        *fsetxattr_failed = true;
+    }
+    return result;
+}
+
+static bool create_context_nodes(prop_area* pa) {
+    uint32_t num_contexts = prop_contexts->num_contexts;
+    context_nodes = static_cast<context_node**>(calloc(num_contexts, sizeof(context_node*)));
+    if (!context_nodes && num_contexts != 0) {
+        return false;
+    }
+    const uint32_t* names = table_context_names(prop_contexts);
+    for (uint32_t i = num_contexts; i-- > 0;) {
+        list_add(&contexts, table_string(prop_contexts, names[i]), pa);
+        context_nodes[i] = contexts;
+    }
     return true;
 }
 
@@ -999,8 +1138,16 @@ static bool is_dir(const char* pathname) {
 }
 
 static void free_and_unmap_contexts() {
-    list_free(&prefixes);
+    prop_cache_clear();
     list_free(&contexts);
+    free(context_nodes);
+    context_nodes = nullptr;
+    if (prop_contexts_mapped) {
+        munmap(prop_contexts, prop_contexts->size);
+    } else {
+        free(prop_contexts);
+    }
+    prop_contexts = nullptr;
     if (__system_property_area__) {
         munmap(__system_property_area__, pa_size);
         __system_property_area__ = nullptr;
@@ -1011,13 +1158,14 @@ int __system_properties_init()
 {
     if (initialized) {
         list_foreach(contexts, [](context_node* l) { l->reset_access(); });
+        prop_cache_clear();
         return 0;
     }
     if (is_dir(property_filename)) {
-        if (!initialize_properties()) {
+        if (!map_contexts_table() && !parse_property_contexts()) {
             return -1;
         }
-        if (!map_system_property_area(false, nullptr)) {
+        if (!create_context_nodes(nullptr) || !map_system_property_area(false, nullptr)) {
             free_and_unmap_contexts();
             return -1;
         }
@@ -1026,8 +1174,14 @@ int __system_properties_init()
         if (!__system_property_area__) {
             return -1;
         }
-        list_add(&contexts, "legacy_system_prop_area", __system_property_area__);
-        list_add_after_len(&prefixes, "*", contexts);
+        context_spec spec = { const_cast<char*>("*"),
+                              const_cast<char*>("legacy_system_prop_area"), 0 };
+        prop_contexts = build_contexts_table(&spec, 1);
+        prop_contexts_mapped = false;
+        if (!prop_contexts || !create_context_nodes(__system_property_area__)) {
+            free_and_unmap_contexts();
+            return -1;
+        }
     }
     initialized = true;
     return 0;
@@ -1047,7 +1201,11 @@ int __system_property_area_init()
 {
     free_and_unmap_contexts();
     mkdir(property_filename, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
-    if (!initialize_properties()) {
+    if (!parse_property_contexts()) {
+        return -1;
+    }
+    if (!create_context_nodes(nullptr)) {
+        free_and_unmap_contexts();
         return -1;
     }
     bool open_failed = false;
@@ -1061,6 +1219,10 @@ int __system_property_area_init()
         free_and_unmap_contexts();
         return -1;
     }
+    // Not fatal: without the table, other processes parse /property_contexts.
+    if (!write_contexts_table(&fsetxattr_failed)) {
+        __libc_format_log(ANDROID_LOG_ERROR, "libc", "Failed to write the property contexts table");
+    }
     initialized = true;
     return fsetxattr_failed ? -2 : 0;
 }
@@ -1085,13 +1247,27 @@ const prop_info *__system_property_find(const char *name)
         return __system_property_find_compat(name);
     }
 
+    size_t namelen;
+    uint32_t hash = prop_name_hash(name, &namelen);
+    bool cacheable = namelen > 0 && namelen < PROP_NAME_MAX;
+    const prop_info* pi;
+    if (cacheable && prop_cache_find(name, hash, &pi)) {
+        return pi;
+    }
+
+    // Read the serial first, so that a concurrent add can't be missed.
+    uint32_t area_serial = __system_property_area_serial();
     prop_area* pa = get_prop_area_for_name(name);
     if (!pa) {
         __libc_format_log(ANDROID_LOG_ERROR, "libc", "Access denied finding property \"%s\"", name);
         return nullptr;
     }
 
-    return pa->find(name);
+    pi = pa->find(name);
+    if (cacheable) {
+        prop_cache_add(name, namelen, hash, pi, area_serial);
+    }
+    return pi;
 }
 
 // The C11 standard doesn't allow atomic loads from const fields,
@@ -30,6 +30,7 @@
 
 #include <stddef.h>
 #include <sys/cdefs.h>
+#include <time.h>
 
 struct __res_state;
 
@@ -73,4 +74,10 @@ _resolv_cache_query_failed( unsigned     netid,
                    const void* query,
                    int         querylen);
 
+/* replaces the clock that expires and refreshes cache entries, so that tests
+ * don't have to wait for TTLs to run out. A NULL clock restores the real one.
+ */
+extern void
+_resolv_cache_set_clock_for_test( time_t (*clock)( void ) );
+
 #endif /* _RESOLV_CACHE_H_ */
@@ -30,6 +30,7 @@
 
 #include <resolv.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -137,6 +138,17 @@
  * *****************************************
  */
 #define  CONFIG_MAX_ENTRIES    64 * 2 * 5
+
+/* popular answers are queried again shortly before they expire, so that
+ * they don't drop out of the cache under their users. An entry counts as
+ * popular once it has been found this many times since it was added.
+ */
+#define  CONFIG_PREFETCH_MIN_HITS  2
+
+/* the refresh is done during the last 1/CONFIG_PREFETCH_DIVISOR of the TTL
+ * (but at least the last second of it, for TTLs of 2 seconds and more).
+ */
+#define  CONFIG_PREFETCH_DIVISOR   10
 /* name of the system property that can be used to set the cache size */
 
 /****************************************************************************/
@@ -352,7 +364,7 @@ void XLOG_BYTES( const void*  base, int  len )
 } __DEBUG__
 
 static time_t
-_time_now( void )
+_real_time_now( void )
 {
     struct timeval  tv;
 
@@ -360,6 +372,21 @@ _time_now( void )
     return tv.tv_sec;
 }
 
+/* the clock used for expiry and refreshes, tests replace it with their own */
+static time_t (*_time_source)( void ) = _real_time_now;
+
+static time_t
+_time_now( void )
+{
+    return _time_source();
+}
+
+void
+_resolv_cache_set_clock_for_test( time_t (*clock)( void ) )
+{
+    _time_source = clock ? clock : _real_time_now;
+}
+
 /* reminder: the general format of a DNS packet is the following:
  *
  *    HEADER  (12 bytes)
@@ -1001,6 +1028,9 @@ typedef struct Entry {
     const uint8_t*   answer;
     int              answerlen;
     time_t           expires;   /* time_t when the entry isn't valid any more */
+    time_t           refresh_at; /* time_t from which a popular entry is refreshed */
+    int              hits;      /* number of lookups answered since added */
+    int              refreshing; /* a refresh query has been handed out */
     int              id;        /* for debugging purpose */
 } Entry;
 
@@ -1220,6 +1250,11 @@ typedef struct pending_req_info {
     struct pending_req_info*    next;
 } PendingReqInfo;
 
+/* Each network has its own cache with its own lock, so lookups on different
+ * networks don't contend, and the list lock is only held for reading while a
+ * cache is found. A cache is reference counted, so that it stays around for
+ * the threads using it even if its network is deleted in the meantime.
+ */
 typedef struct resolv_cache {
     int              max_entries;
     int              num_entries;
@@ -1227,6 +1262,9 @@ typedef struct resolv_cache {
     int              last_id;
     Entry*           entries;
     PendingReqInfo   pending_requests;
+    int              deleted;   /* the network is gone, don't add anything */
+    pthread_mutex_t  lock;      /* protects all of the above */
+    atomic_int       refs;      /* one for the list, plus one per user */
 } Cache;
 
 struct resolv_cache_info {
@@ -1248,8 +1286,9 @@ struct resolv_cache_info {
 static pthread_once_t        _res_cache_once = PTHREAD_ONCE_INIT;
 static void _res_cache_init(void);
 
-// lock protecting everything in the _resolve_cache_info structs (next ptr, etc)
-static pthread_mutex_t _res_cache_list_lock;
+// lock protecting everything in the _resolve_cache_info structs (next ptr, etc),
+// except for the contents of the caches themselves
+static pthread_rwlock_t _res_cache_list_lock;
 
 /* gets cache associated with a network, or NULL if none exists */
 static struct resolv_cache* _find_named_cache_locked(unsigned netid);
@@ -1276,16 +1315,17 @@ _cache_flush_pending_requests_locked( struct resolv_cache* cache )
 
 /* Return 0 if no pending request is found matching the key.
  * If a matching request is found the calling thread will wait until
- * the matching request completes, then update *cache and return 1. */
+ * the matching request completes, then return 1. The cache may have
+ * been deleted meanwhile. */
 static int
-_cache_check_pending_request_locked( struct resolv_cache** cache, Entry* key, unsigned netid )
+_cache_check_pending_request_locked( struct resolv_cache* cache, Entry* key )
 {
     struct pending_req_info *ri, *prev;
     int exist = 0;
 
-    if (*cache && key) {
-        ri = (*cache)->pending_requests.next;
-        prev = &(*cache)->pending_requests;
+    if (cache && key) {
+        ri = cache->pending_requests.next;
+        prev = &cache->pending_requests;
         while (ri) {
             if (ri->hash == key->hash) {
                 exist = 1;
@@ -1305,10 +1345,8 @@ _cache_check_pending_request_locked( struct resolv_cache** cache, Entry* key, un
         } else {
             struct timespec ts = {0,0};
             XLOG("Waiting for previous request");
-            ts.tv_sec = _time_now() + PENDING_REQUEST_TIMEOUT;
-            pthread_cond_timedwait(&ri->cond, &_res_cache_list_lock, &ts);
-            /* Must update *cache as it could have been deleted. */
-            *cache = _find_named_cache_locked(netid);
+            ts.tv_sec = _real_time_now() + PENDING_REQUEST_TIMEOUT;
+            pthread_cond_timedwait(&ri->cond, &cache->lock, &ts);
         }
     }
 
@@ -1343,6 +1381,34 @@ _cache_notify_waiting_tid_locked( struct resolv_cache* cache, Entry* key )
     }
 }
 
+/* gets a reference to the cache associated with a network, or NULL if none exists */
+static Cache*
+_get_cache_for_net(unsigned netid)
+{
+    Cache*  cache;
+
+    pthread_rwlock_rdlock(&_res_cache_list_lock);
+
+    cache = _find_named_cache_locked(netid);
+    if (cache) {
+        atomic_fetch_add_explicit(&cache->refs, 1, memory_order_relaxed);
+    }
+
+    pthread_rwlock_unlock(&_res_cache_list_lock);
+    return cache;
+}
+
+static void _resolv_cache_free(Cache* cache);
+
+/* drops a reference obtained from _get_cache_for_net() */
+static void
+_put_cache(Cache* cache)
+{
+    if (atomic_fetch_sub_explicit(&cache->refs, 1, memory_order_acq_rel) == 1) {
+        _resolv_cache_free(cache);
+    }
+}
+
 /* notify the cache that the query failed */
 void
 _resolv_cache_query_failed( unsigned    netid,
@@ -1355,15 +1421,15 @@ _resolv_cache_query_failed( unsigned    netid,
     if (!entry_init_key(key, query, querylen))
         return;
 
-    pthread_mutex_lock(&_res_cache_list_lock);
-
-    cache = _find_named_cache_locked(netid);
+    pthread_once(&_res_cache_once, _res_cache_init);
+    cache = _get_cache_for_net(netid);
 
     if (cache) {
+        pthread_mutex_lock(&cache->lock);
         _cache_notify_waiting_tid_locked(cache, key);
+        pthread_mutex_unlock(&cache->lock);
+        _put_cache(cache);
     }
-
-    pthread_mutex_unlock(&_res_cache_list_lock);
 }
 
 static struct resolv_cache_info* _find_cache_info_locked(unsigned netid);
@@ -1422,6 +1488,8 @@ _resolv_cache_create( void )
         cache->entries = calloc(sizeof(*cache->entries), cache->max_entries);
         if (cache->entries) {
             cache->mru_list.mru_prev = cache->mru_list.mru_next = &cache->mru_list;
+            pthread_mutex_init(&cache->lock, NULL);
+            atomic_init(&cache->refs, 1);
             XLOG("%s: cache created\n", __FUNCTION__);
         } else {
             free(cache);
@@ -1431,6 +1499,18 @@ _resolv_cache_create( void )
     return cache;
 }
 
+static void
+_resolv_cache_free( Cache*  cache )
+{
+    pthread_mutex_lock(&cache->lock);
+    _cache_flush_locked(cache);
+    pthread_mutex_unlock(&cache->lock);
+
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->entries);
+    free(cache);
+}
+
 
 #if DEBUG
 static void
@@ -1640,10 +1720,13 @@ _resolv_cache_lookup( unsigned              netid,
     }
     /* lookup cache */
     pthread_once(&_res_cache_once, _res_cache_init);
-    pthread_mutex_lock(&_res_cache_list_lock);
-
-    cache = _find_named_cache_locked(netid);
+    cache = _get_cache_for_net(netid);
     if (cache == NULL) {
+        return RESOLV_CACHE_UNSUPPORTED;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    if (cache->deleted) {
         result = RESOLV_CACHE_UNSUPPORTED;
         goto Exit;
     }
@@ -1658,7 +1741,7 @@ _resolv_cache_lookup( unsigned              netid,
         XLOG( "NOT IN CACHE");
         // calling thread will wait if an outstanding request is found
         // that matching this query
-        if (!_cache_check_pending_request_locked(&cache, key, netid) || cache == NULL) {
+        if (!_cache_check_pending_request_locked(cache, key) || cache->deleted) {
             goto Exit;
         } else {
             lookup = _cache_lookup_p(cache, key);
@@ -1679,6 +1762,16 @@ _resolv_cache_lookup( unsigned              netid,
         goto Exit;
     }
 
+    e->hits += 1;
+
+    /* let a single caller refresh a popular entry that is about to expire,
+     * while everybody else keeps getting the cached answer */
+    if (now >= e->refresh_at && !e->refreshing && e->hits >= CONFIG_PREFETCH_MIN_HITS) {
+        XLOG( " REFRESHING ENTRY %p AHEAD OF EXPIRY", e );
+        e->refreshing = 1;
+        goto Exit;
+    }
+
     *answerlen = e->answerlen;
     if (e->answerlen > answersize) {
         /* NOTE: we return UNSUPPORTED if the answer buffer is too short */
@@ -1699,7 +1792,8 @@ _resolv_cache_lookup( unsigned              netid,
     result = RESOLV_CACHE_FOUND;
 
 Exit:
-    pthread_mutex_unlock(&_res_cache_list_lock);
+    pthread_mutex_unlock(&cache->lock);
+    _put_cache(cache);
     return result;
 }
 
@@ -1724,10 +1818,14 @@ _resolv_cache_add( unsigned              netid,
         return;
     }
 
-    pthread_mutex_lock(&_res_cache_list_lock);
-
-    cache = _find_named_cache_locked(netid);
+    pthread_once(&_res_cache_once, _res_cache_init);
+    cache = _get_cache_for_net(netid);
     if (cache == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    if (cache->deleted) {
         goto Exit;
     }
 
@@ -1742,10 +1840,15 @@ _resolv_cache_add( unsigned              netid,
     lookup = _cache_lookup_p(cache, key);
     e      = *lookup;
 
-    if (e != NULL) { /* should not happen */
-        XLOG("%s: ALREADY IN CACHE (%p) ? IGNORING ADD",
-             __FUNCTION__, e);
-        goto Exit;
+    if (e != NULL) {
+        if (!e->refreshing) { /* should not happen */
+            XLOG("%s: ALREADY IN CACHE (%p) ? IGNORING ADD",
+                 __FUNCTION__, e);
+            goto Exit;
+        }
+        /* this is the answer to a refresh, it replaces the old entry */
+        _cache_remove_p(cache, lookup);
+        lookup = _cache_lookup_p(cache, key);
     }
 
     if (cache->num_entries >= cache->max_entries) {
@@ -1767,7 +1870,12 @@ _resolv_cache_add( unsigned              netid,
     if (ttl > 0) {
         e = entry_alloc(key, answer, answerlen);
         if (e != NULL) {
-            e->expires = ttl + _time_now();
+            u_long window = ttl / CONFIG_PREFETCH_DIVISOR;
+            if (window == 0 && ttl >= 2) {
+                window = 1;
+            }
+            e->expires    = ttl + _time_now();
+            e->refresh_at = e->expires - window;
             _cache_add_p(cache, lookup, e);
         }
     }
@@ -1775,10 +1883,9 @@ _resolv_cache_add( unsigned              netid,
     _cache_dump_mru(cache);
 #endif
 Exit:
-    if (cache != NULL) {
-      _cache_notify_waiting_tid_locked(cache, key);
-    }
-    pthread_mutex_unlock(&_res_cache_list_lock);
+    _cache_notify_waiting_tid_locked(cache, key);
+    pthread_mutex_unlock(&cache->lock);
+    _put_cache(cache);
 }
 
 /****************************************************************************/
@@ -1822,7 +1929,7 @@ _res_cache_init(void)
     }
 
     memset(&_res_cache_list, 0, sizeof(_res_cache_list));
-    pthread_mutex_init(&_res_cache_list_lock, NULL);
+    pthread_rwlock_init(&_res_cache_list_lock, NULL);
 }
 
 static struct resolv_cache*
@@ -1849,11 +1956,11 @@ void
 _resolv_flush_cache_for_net(unsigned netid)
 {
     pthread_once(&_res_cache_once, _res_cache_init);
-    pthread_mutex_lock(&_res_cache_list_lock);
+    pthread_rwlock_wrlock(&_res_cache_list_lock);
 
     _flush_cache_for_net_locked(netid);
 
-    pthread_mutex_unlock(&_res_cache_list_lock);
+    pthread_rwlock_unlock(&_res_cache_list_lock);
 }
 
 static void
@@ -1861,7 +1968,9 @@ _flush_cache_for_net_locked(unsigned netid)
 {
     struct resolv_cache* cache = _find_named_cache_locked(netid);
     if (cache) {
+        pthread_mutex_lock(&cache->lock);
         _cache_flush_locked(cache);
+        pthread_mutex_unlock(&cache->lock);
     }
 
     // Also clear the NS statistics.
@@ -1871,8 +1980,10 @@ _flush_cache_for_net_locked(unsigned netid)
 
 void _resolv_delete_cache_for_net(unsigned netid)
 {
+    struct resolv_cache* cache = NULL;
+
     pthread_once(&_res_cache_once, _res_cache_init);
-    pthread_mutex_lock(&_res_cache_list_lock);
+    pthread_rwlock_wrlock(&_res_cache_list_lock);
 
     struct resolv_cache_info* prev_cache_info = &_res_cache_list;
 
@@ -1881,9 +1992,7 @@ void _resolv_delete_cache_for_net(unsigned netid)
 
         if (cache_info->netid == netid) {
             prev_cache_info->next = cache_info->next;
-            _cache_flush_locked(cache_info->cache);
-            free(cache_info->cache->entries);
-            free(cache_info->cache);
+            cache = cache_info->cache;
             _free_nameservers_locked(cache_info);
             free(cache_info);
             break;
@@ -1892,7 +2001,18 @@ void _resolv_delete_cache_for_net(unsigned netid)
         prev_cache_info = prev_cache_info->next;
     }
 
-    pthread_mutex_unlock(&_res_cache_list_lock);
+    pthread_rwlock_unlock(&_res_cache_list_lock);
+
+    if (cache) {
+        // Threads still using the cache see it's deleted and stop using it
+        // (flushing wakes up any waiting for a pending request). The last
+        // one out frees it.
+        pthread_mutex_lock(&cache->lock);
+        cache->deleted = 1;
+        _cache_flush_locked(cache);
+        pthread_mutex_unlock(&cache->lock);
+        _put_cache(cache);
+    }
 }
 
 static struct resolv_cache_info*
@@ -1984,7 +2104,7 @@ _resolv_set_nameservers_for_net(unsigned netid, const char** servers, unsigned n
     }
 
     pthread_once(&_res_cache_once, _res_cache_init);
-    pthread_mutex_lock(&_res_cache_list_lock);
+    pthread_rwlock_wrlock(&_res_cache_list_lock);
 
     // creates the cache if not created
     _get_res_cache_for_net_locked(netid);
@@ -2056,7 +2176,7 @@ _resolv_set_nameservers_for_net(unsigned netid, const char** servers, unsigned n
         *offset = -1; /* cache_info->dnsrch_offset has MAXDNSRCH+1 items */
     }
 
-    pthread_mutex_unlock(&_res_cache_list_lock);
+    pthread_rwlock_unlock(&_res_cache_list_lock);
     return 0;
 }
 
@@ -2115,7 +2235,7 @@ _resolv_populate_res_for_net(res_state statp)
     }
 
     pthread_once(&_res_cache_once, _res_cache_init);
-    pthread_mutex_lock(&_res_cache_list_lock);
+    pthread_rwlock_rdlock(&_res_cache_list_lock);
 
     struct resolv_cache_info* info = _find_cache_info_locked(statp->netid);
     if (info != NULL) {
@@ -2156,7 +2276,7 @@ _resolv_populate_res_for_net(res_state statp)
             *pp++ = &statp->defdname[0] + *p++;
         }
     }
-    pthread_mutex_unlock(&_res_cache_list_lock);
+    pthread_rwlock_unlock(&_res_cache_list_lock);
 }
 
 /* Resolver reachability statistics. */
@@ -2191,12 +2311,12 @@ android_net_res_stats_get_info_for_net(unsigned netid, int* nscount,
         struct sockaddr_storage servers[MAXNS], int* dcount, char domains[MAXDNSRCH][MAXDNSRCHPATH],
         struct __res_params* params, struct __res_stats stats[MAXNS]) {
     int revision_id = -1;
-    pthread_mutex_lock(&_res_cache_list_lock);
+    pthread_rwlock_rdlock(&_res_cache_list_lock);
 
     struct resolv_cache_info* info = _find_cache_info_locked(netid);
     if (info) {
         if (info->nscount > MAXNS) {
-            pthread_mutex_unlock(&_res_cache_list_lock);
+            pthread_rwlock_unlock(&_res_cache_list_lock);
             XLOG("%s: nscount %d > MAXNS %d", __FUNCTION__, info->nscount, MAXNS);
             errno = EFAULT;
             return -1;
@@ -2210,19 +2330,19 @@ android_net_res_stats_get_info_for_net(unsigned netid, int* nscount,
             int addrlen = info->nsaddrinfo[i]->ai_addrlen;
             if (addrlen < (int) sizeof(struct sockaddr) ||
                     addrlen > (int) sizeof(servers[0])) {
-                pthread_mutex_unlock(&_res_cache_list_lock);
+                pthread_rwlock_unlock(&_res_cache_list_lock);
                 XLOG("%s: nsaddrinfo[%d].ai_addrlen == %d", __FUNCTION__, i, addrlen);
                 errno = EMSGSIZE;
                 return -1;
             }
             if (info->nsaddrinfo[i]->ai_addr == NULL) {
-                pthread_mutex_unlock(&_res_cache_list_lock);
+                pthread_rwlock_unlock(&_res_cache_list_lock);
                 XLOG("%s: nsaddrinfo[%d].ai_addr == NULL", __FUNCTION__, i);
                 errno = ENOENT;
                 return -1;
             }
             if (info->nsaddrinfo[i]->ai_next != NULL) {
-                pthread_mutex_unlock(&_res_cache_list_lock);
+                pthread_rwlock_unlock(&_res_cache_list_lock);
                 XLOG("%s: nsaddrinfo[%d].ai_next != NULL", __FUNCTION__, i);
                 errno = ENOTUNIQ;
                 return -1;
@@ -2250,7 +2370,7 @@ android_net_res_stats_get_info_for_net(unsigned netid, int* nscount,
         revision_id = info->revision_id;
     }
 
-    pthread_mutex_unlock(&_res_cache_list_lock);
+    pthread_rwlock_unlock(&_res_cache_list_lock);
     return revision_id;
 }
 
@@ -2258,7 +2378,7 @@ int
 _resolv_cache_get_resolver_stats( unsigned netid, struct __res_params* params,
         struct __res_stats stats[MAXNS]) {
     int revision_id = -1;
-    pthread_mutex_lock(&_res_cache_list_lock);
+    pthread_rwlock_rdlock(&_res_cache_list_lock);
 
     struct resolv_cache_info* info = _find_cache_info_locked(netid);
     if (info) {
@@ -2267,7 +2387,7 @@ _resolv_cache_get_resolver_stats( unsigned netid, struct __res_params* params,
         revision_id = info->revision_id;
     }
 
-    pthread_mutex_unlock(&_res_cache_list_lock);
+    pthread_rwlock_unlock(&_res_cache_list_lock);
     return revision_id;
 }
 
@@ -2276,7 +2396,7 @@ _resolv_cache_add_resolver_stats_sample( unsigned netid, int revision_id, int ns
        const struct __res_sample* sample, int max_samples) {
     if (max_samples <= 0) return;
 
-    pthread_mutex_lock(&_res_cache_list_lock);
+    pthread_rwlock_wrlock(&_res_cache_list_lock);
 
     struct resolv_cache_info* info = _find_cache_info_locked(netid);
 
@@ -2284,6 +2404,6 @@ _resolv_cache_add_resolver_stats_sample( unsigned netid, int revision_id, int ns
         _res_cache_add_stats_sample_locked(&info->nsstats[ns], sample, max_samples);
     }
 
-    pthread_mutex_unlock(&_res_cache_list_lock);
+    pthread_rwlock_unlock(&_res_cache_list_lock);
 }
 
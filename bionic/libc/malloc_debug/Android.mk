@@ -2,12 +2,14 @@ LOCAL_PATH := $(call my-dir)
 
 libc_malloc_debug_src_files := \
     BacktraceData.cpp \
+    BacktraceTable.cpp \
     Config.cpp \
     DebugData.cpp \
     debug_disable.cpp \
     FreeTrackData.cpp \
     GuardData.cpp \
     malloc_debug.cpp \
+    SampleData.cpp \
     TrackData.cpp \
 
 # ==============================================================
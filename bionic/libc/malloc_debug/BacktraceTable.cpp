@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <atomic>
+
+#include <private/bionic_macros.h>
+
+#include "BacktraceTable.h"
+#include "debug_log.h"
+
+constexpr size_t BacktraceTable::kNumSlots;
+constexpr size_t BacktraceTable::kMaxEntries;
+constexpr size_t BacktraceTable::kChunkSize;
+
+static uint32_t HashFrames(const uintptr_t* frames, size_t num_frames) {
+  uint64_t hash = num_frames;
+  for (size_t i = 0; i < num_frames; i++) {
+    hash = (hash ^ frames[i]) * 0x9e3779b97f4a7c15ULL;
+    hash ^= hash >> 29;
+  }
+  return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+BacktraceTable::~BacktraceTable() {
+  if (slots_ != nullptr) {
+    munmap(slots_, kNumSlots * sizeof(*slots_));
+  }
+  Chunk* chunk = chunks_.load(std::memory_order_relaxed);
+  while (chunk != nullptr) {
+    Chunk* next = chunk->next;
+    munmap(chunk, kChunkSize);
+    chunk = next;
+  }
+}
+
+bool BacktraceTable::Initialize() {
+  // Only the pages of slots that are used get backed by memory.
+  void* map = mmap(nullptr, kNumSlots * sizeof(*slots_), PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (map == MAP_FAILED) {
+    error_log("Unable to allocate the backtrace table: %s", strerror(errno));
+    return false;
+  }
+  slots_ = reinterpret_cast<std::atomic<Entry*>*>(map);
+  return true;
+}
+
+BacktraceTable::Entry* BacktraceTable::NewEntry(uint32_t hash, const uintptr_t* frames,
+                                                size_t num_frames) {
+  size_t bytes = BIONIC_ALIGN(sizeof(Entry) + num_frames * sizeof(uintptr_t), sizeof(uintptr_t));
+  Entry* entry = nullptr;
+  while (entry == nullptr) {
+    Chunk* chunk = chunks_.load(std::memory_order_acquire);
+    if (chunk != nullptr) {
+      size_t offset = chunk->used.fetch_add(bytes, std::memory_order_relaxed);
+      if (offset + bytes <= kChunkSize - sizeof(Chunk)) {
+        entry = reinterpret_cast<Entry*>(&chunk->data[offset]);
+        break;
+      }
+    }
+
+    // The chunk is full, start a new one. If another thread beats us to
+    // it, use theirs instead.
+    void* map = mmap(nullptr, kChunkSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                     -1, 0);
+    if (map == MAP_FAILED) {
+      return nullptr;
+    }
+    Chunk* new_chunk = reinterpret_cast<Chunk*>(map);
+    new_chunk->next = chunk;
+    new_chunk->used.store(0, std::memory_order_relaxed);
+    if (!chunks_.compare_exchange_strong(chunk, new_chunk, std::memory_order_acq_rel)) {
+      munmap(map, kChunkSize);
+    }
+  }
+
+  entry->hash = hash;
+  entry->num_frames = num_frames;
+  memcpy(entry->frames, frames, num_frames * sizeof(uintptr_t));
+  return entry;
+}
+
+uint32_t BacktraceTable::Add(const uintptr_t* frames, size_t num_frames) {
+  if (num_frames == 0) {
+    return 0;
+  }
+
+  uint32_t hash = HashFrames(frames, num_frames);
+  Entry* new_entry = nullptr;
+  for (size_t i = 0; i < kNumSlots; i++) {
+    size_t index = (hash + i) & (kNumSlots - 1);
+    Entry* entry = slots_[index].load(std::memory_order_acquire);
+    if (entry == nullptr) {
+      if (size_.load(std::memory_order_relaxed) >= kMaxEntries) {
+        if (!full_logged_.exchange(true)) {
+          error_log("The backtrace table is full, new backtraces will not be recorded.");
+        }
+        return 0;
+      }
+      if (new_entry == nullptr) {
+        new_entry = NewEntry(hash, frames, num_frames);
+        if (new_entry == nullptr) {
+          return 0;
+        }
+      }
+      if (slots_[index].compare_exchange_strong(entry, new_entry, std::memory_order_acq_rel)) {
+        size_.fetch_add(1, std::memory_order_relaxed);
+        return index + 1;
+      }
+      // Another thread filled this slot first, possibly with this same
+      // backtrace. If so, the entry we made is wasted, but that's rare.
+    }
+    if (entry->hash == hash && entry->num_frames == num_frames &&
+        memcmp(entry->frames, frames, num_frames * sizeof(uintptr_t)) == 0) {
+      return index + 1;
+    }
+  }
+  return 0;
+}
+
+const uintptr_t* BacktraceTable::Get(uint32_t id, size_t* num_frames) {
+  if (id == 0 || id > kNumSlots) {
+    *num_frames = 0;
+    return nullptr;
+  }
+  Entry* entry = slots_[id - 1].load(std::memory_order_acquire);
+  if (entry == nullptr) {
+    *num_frames = 0;
+    return nullptr;
+  }
+  *num_frames = entry->num_frames;
+  return entry->frames;
+}
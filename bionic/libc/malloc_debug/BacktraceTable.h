@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+#ifndef DEBUG_MALLOC_BACKTRACETABLE_H
+#define DEBUG_MALLOC_BACKTRACETABLE_H
+
+#include <stdint.h>
+
+#include <atomic>
+
+#include <private/bionic_macros.h>
+
+// A table of unique backtraces. Each one is stored once and referred to by
+// a 32 bit id, so an allocation only needs to record the id of the backtrace
+// it was made from. Backtraces are never removed.
+//
+// Lookups and inserts don't take any locks: the table is open addressed with
+// linear probing, and a new backtrace is published by a compare and swap on
+// an empty slot.
+class BacktraceTable {
+ public:
+  BacktraceTable() = default;
+  virtual ~BacktraceTable();
+
+  bool Initialize();
+
+  // Returns the id of the given backtrace, adding it to the table if it
+  // isn't there already. Returns 0 if there are no frames or the table
+  // is full.
+  uint32_t Add(const uintptr_t* frames, size_t num_frames);
+
+  // Returns the frames for the given id, or nullptr if the id is 0.
+  const uintptr_t* Get(uint32_t id, size_t* num_frames);
+
+  size_t size() { return size_.load(std::memory_order_relaxed); }
+
+  static constexpr size_t kNumSlots = 1 << 18;
+  // Keep some slots free so that the probe sequences stay short.
+  static constexpr size_t kMaxEntries = kNumSlots / 4 * 3;
+
+ private:
+  struct Entry {
+    uint32_t hash;
+    uint32_t num_frames;
+    uintptr_t frames[0];
+  };
+
+  struct Chunk {
+    Chunk* next;
+    std::atomic<size_t> used;
+    uint8_t data[0];
+  };
+
+  static constexpr size_t kChunkSize = 64 * 1024;
+
+  Entry* NewEntry(uint32_t hash, const uintptr_t* frames, size_t num_frames);
+
+  std::atomic<Entry*>* slots_ = nullptr;
+  std::atomic<size_t> size_{0};
+  std::atomic<Chunk*> chunks_{nullptr};
+  std::atomic<bool> full_logged_{false};
+
+  DISALLOW_COPY_AND_ASSIGN(BacktraceTable);
+};
+
+#endif // DEBUG_MALLOC_BACKTRACETABLE_H
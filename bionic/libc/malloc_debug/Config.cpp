@@ -56,7 +56,9 @@ static constexpr size_t DEFAULT_GUARD_BYTES = 32;
 static constexpr size_t MAX_GUARD_BYTES = 16384;
 
 static constexpr size_t DEFAULT_BACKTRACE_FRAMES = 16;
-static constexpr size_t MAX_BACKTRACE_FRAMES = 256;
+
+static constexpr size_t DEFAULT_SAMPLE_RATE = 512 * 1024;
+static constexpr size_t MAX_SAMPLE_RATE = 1024 * 1024 * 1024;
 
 static constexpr size_t DEFAULT_EXPAND_BYTES = 16;
 static constexpr size_t MAX_EXPAND_BYTES = 16384;
@@ -184,6 +186,12 @@ void PropertyParser::LogUsage() {
   error_log("    frames. The default is %zu frames, the max number of frames is %zu.",
             DEFAULT_BACKTRACE_FRAMES, MAX_BACKTRACE_FRAMES);
   error_log("");
+  error_log("  sample_rate[=XX]");
+  error_log("    Capture the backtrace of a random sample of allocations, on");
+  error_log("    average one for every XX bytes allocated. The live sampled");
+  error_log("    allocations can be dumped as a heap profile. The default is");
+  error_log("    %zu bytes, the max is %zu.", DEFAULT_SAMPLE_RATE, MAX_SAMPLE_RATE);
+  error_log("");
   error_log("  fill_on_alloc[=XX]");
   error_log("    On first allocation, fill with the value 0x%02x.", DEFAULT_FILL_ALLOC_VALUE);
   error_log("    If XX is set it will only fill up to XX bytes of the");
@@ -297,6 +305,10 @@ bool Config::SetFromProperties() {
     Feature("backtrace_enable_on_signal", DEFAULT_BACKTRACE_FRAMES, 1, MAX_BACKTRACE_FRAMES,
             BACKTRACE | TRACK_ALLOCS, &this->backtrace_frames, &this->backtrace_enable_on_signal,
             false),
+    // Only capture backtraces for a sample of the allocations. Value is the
+    // average number of bytes allocated between two samples.
+    Feature("sample_rate", DEFAULT_SAMPLE_RATE, 1, MAX_SAMPLE_RATE, BACKTRACE | SAMPLE,
+            &this->sample_rate, &this->backtrace_enabled, false),
 
     Feature("fill", SIZE_MAX, 1, SIZE_MAX, 0, nullptr, nullptr, true),
     // Fill the allocation with an arbitrary pattern on allocation.
@@ -383,6 +395,12 @@ bool Config::SetFromProperties() {
     if ((options & FILL_ON_FREE) && fill_on_free_bytes == 0) {
       fill_on_free_bytes = SIZE_MAX;
     }
+
+    // The sample_rate option uses the number of frames from one of the
+    // backtrace options when they are also set.
+    if ((options & SAMPLE) && backtrace_frames == 0) {
+      backtrace_frames = DEFAULT_BACKTRACE_FRAMES;
+    }
   } else {
     parser.LogUsage();
   }
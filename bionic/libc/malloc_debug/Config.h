@@ -40,6 +40,7 @@ constexpr uint64_t EXPAND_ALLOC = 0x20;
 constexpr uint64_t FREE_TRACK = 0x40;
 constexpr uint64_t TRACK_ALLOCS = 0x80;
 constexpr uint64_t LEAK_TRACK = 0x100;
+constexpr uint64_t SAMPLE = 0x200;
 
 // In order to guarantee posix compliance, set the minimum alignment
 // to 8 bytes for 32 bit systems and 16 bytes for 64 bit systems.
@@ -49,6 +50,9 @@ constexpr size_t MINIMUM_ALIGNMENT_BYTES = 16;
 constexpr size_t MINIMUM_ALIGNMENT_BYTES = 8;
 #endif
 
+// The largest number of frames that any of the backtrace options can capture.
+constexpr size_t MAX_BACKTRACE_FRAMES = 256;
+
 // If only one or more of these options is set, then no special header is needed.
 constexpr uint64_t NO_HEADER_OPTIONS = FILL_ON_ALLOC | FILL_ON_FREE | EXPAND_ALLOC;
 
@@ -63,6 +67,8 @@ struct Config {
   bool backtrace_enabled = false;
   size_t backtrace_frames = 0;
 
+  size_t sample_rate = 0;
+
   size_t fill_on_alloc_bytes = 0;
   size_t fill_on_free_bytes = 0;
 
@@ -29,12 +29,14 @@
 #include <stdint.h>
 
 #include "BacktraceData.h"
+#include "BacktraceTable.h"
 #include "Config.h"
 #include "DebugData.h"
 #include "debug_disable.h"
 #include "FreeTrackData.h"
 #include "GuardData.h"
 #include "malloc_debug.h"
+#include "SampleData.h"
 #include "TrackData.h"
 
 bool DebugData::Initialize() {
@@ -56,6 +58,15 @@ bool DebugData::Initialize() {
       }
     }
 
+    // Allocation and free backtraces are both kept in the same table.
+    if ((config_.options & BACKTRACE) ||
+        ((config_.options & FREE_TRACK) && config_.free_track_backtrace_num_frames > 0)) {
+      backtrace_table.reset(new BacktraceTable());
+      if (!backtrace_table->Initialize()) {
+        return false;
+      }
+    }
+
     if (config_.options & FRONT_GUARD) {
       front_guard.reset(new FrontGuardData(config_, &pointer_offset_));
     }
@@ -75,6 +86,13 @@ bool DebugData::Initialize() {
     if (config_.options & TRACK_ALLOCS) {
       track.reset(new TrackData());
     }
+
+    if (config_.options & SAMPLE) {
+      sample.reset(new SampleData(config_));
+      if (!sample->Initialize()) {
+        return false;
+      }
+    }
   }
 
   if (config_.options & EXPAND_ALLOC) {
@@ -87,16 +105,25 @@ void DebugData::PrepareFork() {
   if (track != nullptr) {
     track->PrepareFork();
   }
+  if (sample != nullptr) {
+    sample->PrepareFork();
+  }
 }
 
 void DebugData::PostForkParent() {
   if (track != nullptr) {
     track->PostForkParent();
   }
+  if (sample != nullptr) {
+    sample->PostForkParent();
+  }
 }
 
 void DebugData::PostForkChild() {
   if (track != nullptr) {
     track->PostForkChild();
   }
+  if (sample != nullptr) {
+    sample->PostForkChild();
+  }
 }
@@ -37,10 +37,12 @@
 #include <private/bionic_macros.h>
 
 #include "BacktraceData.h"
+#include "BacktraceTable.h"
 #include "Config.h"
 #include "FreeTrackData.h"
 #include "GuardData.h"
 #include "malloc_debug.h"
+#include "SampleData.h"
 #include "TrackData.h"
 
 class DebugData {
@@ -87,10 +89,12 @@ class DebugData {
   void PostForkChild();
 
   std::unique_ptr<BacktraceData> backtrace;
+  std::unique_ptr<BacktraceTable> backtrace_table;
   std::unique_ptr<TrackData> track;
   std::unique_ptr<FrontGuardData> front_guard;
   std::unique_ptr<RearGuardData> rear_guard;
   std::unique_ptr<FreeTrackData> free_track;
+  std::unique_ptr<SampleData> sample;
 
  private:
   size_t extra_bytes_ = 0;
@@ -56,9 +56,10 @@ void FreeTrackData::LogFreeError(DebugData& debug, const Header* header,
   }
   auto back_iter = backtraces_.find(header);
   if (back_iter != backtraces_.end()) {
-    const BacktraceHeader* back_header = back_iter->second;
+    size_t num_frames;
+    const uintptr_t* frames = debug.backtrace_table->Get(back_iter->second, &num_frames);
     error_log("Backtrace at time of free:");
-    backtrace_log(&back_header->frames[0], back_header->num_frames);
+    backtrace_log(frames, num_frames);
   }
   error_log(LOG_DIVIDER);
 }
@@ -86,11 +87,7 @@ void FreeTrackData::VerifyAndFree(DebugData& debug, const Header* header,
     }
   }
 
-  auto back_iter = backtraces_.find(header);
-  if (back_iter != backtraces_.end()) {
-    g_dispatch->free(reinterpret_cast<void*>(back_iter->second));
-    backtraces_.erase(header);
-  }
+  backtraces_.erase(header);
   g_dispatch->free(header->orig_pointer);
 }
 
@@ -106,12 +103,9 @@ void FreeTrackData::Add(DebugData& debug, const Header* header) {
   }
 
   if (backtrace_num_frames_ > 0) {
-    BacktraceHeader* back_header = reinterpret_cast<BacktraceHeader*>(
-      g_dispatch->malloc(sizeof(BacktraceHeader) + backtrace_num_frames_ * sizeof(uintptr_t)));
-    if (back_header) {
-      back_header->num_frames = backtrace_get(&back_header->frames[0], backtrace_num_frames_);
-      backtraces_[header] = back_header;
-    }
+    uintptr_t frames[MAX_BACKTRACE_FRAMES];
+    size_t num_frames = backtrace_get(frames, backtrace_num_frames_);
+    backtraces_[header] = debug.backtrace_table->Add(frames, num_frames);
   }
   list_.push_front(header);
 
@@ -128,7 +122,7 @@ void FreeTrackData::VerifyAll(DebugData& debug) {
   list_.clear();
 }
 
-void FreeTrackData::LogBacktrace(const Header* header) {
+void FreeTrackData::LogBacktrace(DebugData& debug, const Header* header) {
   ScopedDisableDebugCalls disable;
 
   auto back_iter = backtraces_.find(header);
@@ -136,6 +130,8 @@ void FreeTrackData::LogBacktrace(const Header* header) {
     return;
   }
 
+  size_t num_frames;
+  const uintptr_t* frames = debug.backtrace_table->Get(back_iter->second, &num_frames);
   error_log("Backtrace of original free:");
-  backtrace_log(&back_iter->second->frames[0], back_iter->second->num_frames);
+  backtrace_log(frames, num_frames);
 }
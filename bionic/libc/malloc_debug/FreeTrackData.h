@@ -42,7 +42,6 @@
 struct Header;
 class DebugData;
 struct Config;
-struct BacktraceHeader;
 
 class FreeTrackData {
  public:
@@ -53,7 +52,7 @@ class FreeTrackData {
 
   void VerifyAll(DebugData& debug);
 
-  void LogBacktrace(const Header* header);
+  void LogBacktrace(DebugData& debug, const Header* header);
 
  private:
   void LogFreeError(DebugData& debug, const Header* header, const uint8_t* pointer);
@@ -62,7 +61,8 @@ class FreeTrackData {
   pthread_mutex_t mutex_ = PTHREAD_MUTEX_INITIALIZER;
   std::deque<const Header*> list_;
   std::vector<uint8_t> cmp_mem_;
-  std::unordered_map<const Header*, BacktraceHeader*> backtraces_;
+  // The id of each allocation's free backtrace in DebugData::backtrace_table.
+  std::unordered_map<const Header*, uint32_t> backtraces_;
   size_t backtrace_num_frames_;
 
   DISALLOW_COPY_AND_ASSIGN(FreeTrackData);
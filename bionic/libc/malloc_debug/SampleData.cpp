@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "Config.h"
+#include "DebugData.h"
+#include "debug_disable.h"
+#include "debug_log.h"
+#include "SampleData.h"
+
+// Returns -log(u) for u = (random + 1) / 2^53, which is uniform in (0, 1]
+// when random is a uniform 53 bit value. This only spaces out the samples,
+// so a handful of digits is enough, and it keeps libm out of this library.
+static double NegLog(uint64_t random) {
+  double u = static_cast<double>(random + 1) / 9007199254740992.0;
+
+  // Split u into 2^exponent * mantissa, with the mantissa in [1, 2).
+  uint64_t bits;
+  memcpy(&bits, &u, sizeof(bits));
+  int exponent = static_cast<int>((bits >> 52) & 0x7ff) - 1023;
+  bits = (bits & ((1ULL << 52) - 1)) | (1023ULL << 52);
+  double mantissa;
+  memcpy(&mantissa, &bits, sizeof(mantissa));
+
+  // log(m) = 2 * atanh(s) where s = (m - 1) / (m + 1), and s <= 1/3 here.
+  double s = (mantissa - 1) / (mantissa + 1);
+  double s2 = s * s;
+  double log_mantissa = 2 * s * (1 + s2 * (1.0 / 3 + s2 * (1.0 / 5 + s2 * (1.0 / 7 + s2 / 9))));
+  return -(exponent * 0.6931471805599453 + log_mantissa);
+}
+
+SampleData::SampleData(const Config& config) : rate_(config.sample_rate) {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  random_state_ = (static_cast<uint64_t>(getpid()) << 32) ^ ts.tv_sec ^ ts.tv_nsec;
+}
+
+SampleData::~SampleData() {
+  if (key_created_) {
+    pthread_key_delete(bytes_left_key_);
+  }
+}
+
+bool SampleData::Initialize() {
+  int error = pthread_key_create(&bytes_left_key_, nullptr);
+  if (error != 0) {
+    error_log("pthread_key_create failed: %s", strerror(error));
+    return false;
+  }
+  key_created_ = true;
+  return true;
+}
+
+size_t SampleData::NextSampleBytes() {
+  // splitmix64, stepped atomically so that threads never get the same value.
+  uint64_t value = random_state_.fetch_add(0x9e3779b97f4a7c15ULL, std::memory_order_relaxed);
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  value ^= value >> 31;
+
+  double bytes = NegLog(value >> 11) * rate_;
+  if (bytes >= static_cast<double>(SIZE_MAX - 1)) {
+    return SIZE_MAX;
+  }
+  return static_cast<size_t>(bytes) + 1;
+}
+
+bool SampleData::ShouldSample(size_t size) {
+  uintptr_t bytes_left = reinterpret_cast<uintptr_t>(pthread_getspecific(bytes_left_key_));
+  if (bytes_left == 0) {
+    // The first allocation on this thread.
+    bytes_left = NextSampleBytes();
+  }
+
+  bool sample = size >= bytes_left;
+  if (sample) {
+    bytes_left = NextSampleBytes();
+  } else {
+    bytes_left -= size;
+  }
+  pthread_setspecific(bytes_left_key_, reinterpret_cast<void*>(bytes_left));
+  return sample;
+}
+
+void SampleData::Add(uint32_t id, size_t size) {
+  // Make sure the stl calls below don't call the debug_XXX functions.
+  ScopedDisableDebugCalls disable;
+
+  pthread_mutex_lock(&mutex_);
+  Totals& totals = totals_[id];
+  totals.live_allocs++;
+  totals.live_bytes += size;
+  totals.total_allocs++;
+  totals.total_bytes += size;
+  pthread_mutex_unlock(&mutex_);
+}
+
+void SampleData::Remove(uint32_t id, size_t size) {
+  ScopedDisableDebugCalls disable;
+
+  pthread_mutex_lock(&mutex_);
+  Totals& totals = totals_[id];
+  totals.live_allocs--;
+  totals.live_bytes -= size;
+  pthread_mutex_unlock(&mutex_);
+}
+
+void SampleData::Resize(uint32_t id, size_t old_size, size_t new_size) {
+  ScopedDisableDebugCalls disable;
+
+  pthread_mutex_lock(&mutex_);
+  Totals& totals = totals_[id];
+  totals.live_bytes = totals.live_bytes - old_size + new_size;
+  pthread_mutex_unlock(&mutex_);
+}
+
+static bool CopyMaps(int fd) {
+  int maps_fd = open("/proc/self/maps", O_RDONLY | O_CLOEXEC);
+  if (maps_fd == -1) {
+    return false;
+  }
+  char buffer[4096];
+  ssize_t bytes;
+  while ((bytes = TEMP_FAILURE_RETRY(read(maps_fd, buffer, sizeof(buffer)))) > 0) {
+    for (ssize_t written = 0; written < bytes; ) {
+      ssize_t result = TEMP_FAILURE_RETRY(write(fd, buffer + written, bytes - written));
+      if (result <= 0) {
+        close(maps_fd);
+        return false;
+      }
+      written += result;
+    }
+  }
+  close(maps_fd);
+  return bytes == 0;
+}
+
+bool SampleData::Dump(DebugData& debug, int fd) {
+  ScopedDisableDebugCalls disable;
+
+  std::vector<std::pair<uint32_t, Totals>> list;
+  pthread_mutex_lock(&mutex_);
+  list.assign(totals_.begin(), totals_.end());
+  pthread_mutex_unlock(&mutex_);
+
+  // Sort by the number of live bytes.
+  std::sort(list.begin(), list.end(),
+            [](const std::pair<uint32_t, Totals>& a, const std::pair<uint32_t, Totals>& b) {
+    if (a.second.live_bytes == b.second.live_bytes) return a.first < b.first;
+    return a.second.live_bytes > b.second.live_bytes;
+  });
+
+  Totals sum;
+  for (const auto& entry : list) {
+    sum.live_allocs += entry.second.live_allocs;
+    sum.live_bytes += entry.second.live_bytes;
+    sum.total_allocs += entry.second.total_allocs;
+    sum.total_bytes += entry.second.total_bytes;
+  }
+
+  // The heap_v2 header tells pprof the sampling rate, so that it can
+  // estimate the real totals from the sampled ones.
+  if (dprintf(fd, "heap profile: %6zu: %8zu [%6zu: %8zu] @ heap_v2/%zu\n",
+              sum.live_allocs, sum.live_bytes, sum.total_allocs, sum.total_bytes, rate_) < 0) {
+    return false;
+  }
+  for (const auto& entry : list) {
+    const Totals& totals = entry.second;
+    if (dprintf(fd, "%6zu: %8zu [%6zu: %8zu] @", totals.live_allocs, totals.live_bytes,
+                totals.total_allocs, totals.total_bytes) < 0) {
+      return false;
+    }
+    size_t num_frames;
+    const uintptr_t* frames = debug.backtrace_table->Get(entry.first, &num_frames);
+    for (size_t i = 0; i < num_frames; i++) {
+      if (dprintf(fd, " %#" PRIxPTR, frames[i]) < 0) {
+        return false;
+      }
+    }
+    if (dprintf(fd, "\n") < 0) {
+      return false;
+    }
+  }
+
+  // pprof uses the maps to symbolize the frames.
+  if (dprintf(fd, "\nMAPPED_LIBRARIES:\n") < 0) {
+    return false;
+  }
+  return CopyMaps(fd);
+}
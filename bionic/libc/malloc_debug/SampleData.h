@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef DEBUG_MALLOC_SAMPLEDATA_H
+#define DEBUG_MALLOC_SAMPLEDATA_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <unordered_map>
+
+#include <private/bionic_macros.h>
+
+// Forward declarations.
+struct Config;
+class DebugData;
+
+// Picks which allocations have their backtrace captured when the sample_rate
+// option is set, and keeps the totals for each sampled backtrace.
+//
+// The samples are spread out the same way as in tcmalloc's heap profiler:
+// each thread counts down a random number of bytes, drawn from an exponential
+// distribution with a mean of the sample rate, and the allocation that
+// reaches zero is sampled. Large allocations are therefore more likely to be
+// sampled than small ones, and pprof can scale the totals back up.
+class SampleData {
+ public:
+  SampleData(const Config& config);
+  virtual ~SampleData();
+
+  bool Initialize();
+
+  // Returns true if the allocation should be sampled.
+  bool ShouldSample(size_t size);
+
+  // Update the totals for the backtrace of a sampled allocation.
+  void Add(uint32_t id, size_t size);
+  void Remove(uint32_t id, size_t size);
+  void Resize(uint32_t id, size_t old_size, size_t new_size);
+
+  // Writes the live sampled allocations, grouped by backtrace, to fd in
+  // the legacy pprof heap profile format.
+  bool Dump(DebugData& debug, int fd);
+
+  void PrepareFork() { pthread_mutex_lock(&mutex_); }
+  void PostForkParent() { pthread_mutex_unlock(&mutex_); }
+  void PostForkChild() { pthread_mutex_init(&mutex_, NULL); }
+
+ private:
+  struct Totals {
+    size_t live_allocs = 0;
+    size_t live_bytes = 0;
+    size_t total_allocs = 0;
+    size_t total_bytes = 0;
+  };
+
+  size_t NextSampleBytes();
+
+  size_t rate_;
+  // The number of bytes left until the next sample on each thread.
+  pthread_key_t bytes_left_key_;
+  bool key_created_ = false;
+  std::atomic<uint64_t> random_state_;
+
+  pthread_mutex_t mutex_ = PTHREAD_MUTEX_INITIALIZER;
+  std::unordered_map<uint32_t, Totals> totals_;
+
+  DISALLOW_COPY_AND_ASSIGN(SampleData);
+};
+
+#endif // DEBUG_MALLOC_SAMPLEDATA_H
@@ -33,8 +33,6 @@
 #include <algorithm>
 #include <vector>
 
-#include <private/ScopedPthreadMutexLocker.h>
-
 #include "backtrace.h"
 #include "BacktraceData.h"
 #include "Config.h"
@@ -47,8 +45,10 @@
 void TrackData::GetList(std::vector<const Header*>* list) {
   ScopedDisableDebugCalls disable;
 
-  for (const auto& header : headers_) {
-    list->push_back(header);
+  for (size_t i = 0; i < kNumShards; i++) {
+    for (const auto& header : shards_[i].headers) {
+      list->push_back(header);
+    }
   }
 
   // Sort by the size of the allocation.
@@ -61,31 +61,34 @@ void TrackData::GetList(std::vector<const Header*>* list) {
 void TrackData::Add(const Header* header, bool backtrace_found) {
   ScopedDisableDebugCalls disable;
 
-  pthread_mutex_lock(&mutex_);
+  Shard& shard = GetShard(header);
+  pthread_mutex_lock(&shard.mutex);
   if (backtrace_found) {
-    total_backtrace_allocs_++;
+    shard.backtrace_allocs++;
   }
-  headers_.insert(header);
-  pthread_mutex_unlock(&mutex_);
+  shard.headers.insert(header);
+  pthread_mutex_unlock(&shard.mutex);
 }
 
 void TrackData::Remove(const Header* header, bool backtrace_found) {
   ScopedDisableDebugCalls disable;
 
-  pthread_mutex_lock(&mutex_);
-  headers_.erase(header);
+  Shard& shard = GetShard(header);
+  pthread_mutex_lock(&shard.mutex);
+  shard.headers.erase(header);
   if (backtrace_found) {
-    total_backtrace_allocs_--;
+    shard.backtrace_allocs--;
   }
-  pthread_mutex_unlock(&mutex_);
+  pthread_mutex_unlock(&shard.mutex);
 }
 
 bool TrackData::Contains(const Header* header) {
   ScopedDisableDebugCalls disable;
 
-  pthread_mutex_lock(&mutex_);
-  bool found = headers_.count(header);
-  pthread_mutex_unlock(&mutex_);
+  Shard& shard = GetShard(header);
+  pthread_mutex_lock(&shard.mutex);
+  bool found = shard.headers.count(header);
+  pthread_mutex_unlock(&shard.mutex);
   return found;
 }
 
@@ -101,9 +104,11 @@ void TrackData::DisplayLeaks(DebugData& debug) {
               header->real_size(), debug.GetPointer(header), ++track_count, list.size());
     if (debug.config().options & BACKTRACE) {
       BacktraceHeader* back_header = debug.GetAllocBacktrace(header);
-      if (back_header->num_frames > 0) {
+      size_t num_frames;
+      const uintptr_t* frames = debug.backtrace_table->Get(back_header->id, &num_frames);
+      if (num_frames > 0) {
         error_log("Backtrace at time of allocation:");
-        backtrace_log(&back_header->frames[0], back_header->num_frames);
+        backtrace_log(frames, num_frames);
       }
     }
     g_dispatch->free(header->orig_pointer);
@@ -112,19 +117,27 @@ void TrackData::DisplayLeaks(DebugData& debug) {
 
 void TrackData::GetInfo(DebugData& debug, uint8_t** info, size_t* overall_size,
                         size_t* info_size, size_t* total_memory, size_t* backtrace_size) {
-  ScopedPthreadMutexLocker scoped(&mutex_);
+  LockAll();
 
-  if (headers_.size() == 0 || total_backtrace_allocs_ == 0) {
+  size_t num_headers = 0;
+  size_t total_backtrace_allocs = 0;
+  for (size_t i = 0; i < kNumShards; i++) {
+    num_headers += shards_[i].headers.size();
+    total_backtrace_allocs += shards_[i].backtrace_allocs;
+  }
+  if (num_headers == 0 || total_backtrace_allocs == 0) {
+    UnlockAll();
     return;
   }
 
   *backtrace_size = debug.config().backtrace_frames;
   *info_size = sizeof(size_t) * 2 + sizeof(uintptr_t) * *backtrace_size;
-  *info = reinterpret_cast<uint8_t*>(g_dispatch->calloc(*info_size, total_backtrace_allocs_));
+  *info = reinterpret_cast<uint8_t*>(g_dispatch->calloc(*info_size, total_backtrace_allocs));
   if (*info == nullptr) {
+    UnlockAll();
     return;
   }
-  *overall_size = *info_size * total_backtrace_allocs_;
+  *overall_size = *info_size * total_backtrace_allocs;
 
   std::vector<const Header*> list;
   GetList(&list);
@@ -132,15 +145,17 @@ void TrackData::GetInfo(DebugData& debug, uint8_t** info, size_t* overall_size,
   uint8_t* data = *info;
   for (const auto& header : list) {
     BacktraceHeader* back_header = debug.GetAllocBacktrace(header);
-    if (back_header->num_frames > 0) {
+    size_t num_frames;
+    const uintptr_t* frames = debug.backtrace_table->Get(back_header->id, &num_frames);
+    if (num_frames > 0) {
       memcpy(data, &header->size, sizeof(size_t));
-      memcpy(&data[sizeof(size_t)], &back_header->num_frames, sizeof(size_t));
-      memcpy(&data[2 * sizeof(size_t)], &back_header->frames[0],
-            back_header->num_frames * sizeof(uintptr_t));
+      memcpy(&data[sizeof(size_t)], &num_frames, sizeof(size_t));
+      memcpy(&data[2 * sizeof(size_t)], frames, num_frames * sizeof(uintptr_t));
 
       *total_memory += header->real_size();
 
       data += *info_size;
     }
   }
+  UnlockAll();
 }
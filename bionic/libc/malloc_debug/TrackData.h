@@ -60,14 +60,43 @@ class TrackData {
 
   void DisplayLeaks(DebugData& debug);
 
-  void PrepareFork() { pthread_mutex_lock(&mutex_); }
-  void PostForkParent() { pthread_mutex_unlock(&mutex_); }
-  void PostForkChild() { pthread_mutex_init(&mutex_, NULL); }
+  void PrepareFork() { LockAll(); }
+  void PostForkParent() { UnlockAll(); }
+  void PostForkChild() {
+    for (size_t i = 0; i < kNumShards; i++) {
+      pthread_mutex_init(&shards_[i].mutex, NULL);
+    }
+  }
 
  private:
-  pthread_mutex_t mutex_ = PTHREAD_MUTEX_INITIALIZER;
-  std::unordered_set<const Header*> headers_;
-  size_t total_backtrace_allocs_ = 0;
+  // The headers are split across several sets, each with its own lock, so
+  // that threads allocating at the same time rarely wait for each other.
+  struct Shard {
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    std::unordered_set<const Header*> headers;
+    size_t backtrace_allocs = 0;
+  };
+
+  static constexpr size_t kNumShards = 16;
+
+  Shard& GetShard(const Header* header) {
+    uintptr_t value = reinterpret_cast<uintptr_t>(header);
+    return shards_[((value >> 4) ^ (value >> 12)) % kNumShards];
+  }
+
+  // Locks are always taken in shard order.
+  void LockAll() {
+    for (size_t i = 0; i < kNumShards; i++) {
+      pthread_mutex_lock(&shards_[i].mutex);
+    }
+  }
+  void UnlockAll() {
+    for (size_t i = kNumShards; i > 0; i--) {
+      pthread_mutex_unlock(&shards_[i - 1].mutex);
+    }
+  }
+
+  Shard shards_[kNumShards];
 
   DISALLOW_COPY_AND_ASSIGN(TrackData);
 };
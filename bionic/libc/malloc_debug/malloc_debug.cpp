@@ -68,6 +68,7 @@ void debug_get_malloc_leak_info(
     uint8_t** info, size_t* overall_size, size_t* info_size, size_t* total_memory,
     size_t* backtrace_size);
 ssize_t debug_malloc_backtrace(void* pointer, uintptr_t* frames, size_t frame_count);
+bool debug_dump_heap_profile(int fd);
 void debug_free_malloc_leak_info(uint8_t* info);
 size_t debug_malloc_usable_size(void* pointer);
 void* debug_malloc(size_t size);
@@ -120,7 +121,7 @@ static void LogTagError(const Header* header, const void* pointer, const char* n
   if (header->tag == DEBUG_FREE_TAG) {
     error_log("+++ ALLOCATION %p USED AFTER FREE (%s)", pointer, name);
     if (g_debug->config().options & FREE_TRACK) {
-      g_debug->free_track->LogBacktrace(header);
+      g_debug->free_track->LogBacktrace(*g_debug, header);
     }
   } else {
     error_log("+++ ALLOCATION %p HAS INVALID TAG %" PRIx32 " (%s)", pointer, header->tag, name);
@@ -164,13 +165,18 @@ static void* InitHeader(Header* header, void* orig_pointer, size_t size) {
   bool backtrace_found = false;
   if (g_debug->config().options & BACKTRACE) {
     BacktraceHeader* back_header = g_debug->GetAllocBacktrace(header);
-    if (g_debug->backtrace->enabled()) {
+    if (g_debug->backtrace->enabled() &&
+        (!(g_debug->config().options & SAMPLE) || g_debug->sample->ShouldSample(size))) {
       ScopedDisableDebugCalls disable;
-      back_header->num_frames = backtrace_get(
-          &back_header->frames[0], g_debug->config().backtrace_frames);
-      backtrace_found = back_header->num_frames > 0;
+      uintptr_t frames[MAX_BACKTRACE_FRAMES];
+      size_t num_frames = backtrace_get(frames, g_debug->config().backtrace_frames);
+      back_header->id = g_debug->backtrace_table->Add(frames, num_frames);
+      backtrace_found = back_header->id != 0;
+      if (backtrace_found && (g_debug->config().options & SAMPLE)) {
+        g_debug->sample->Add(back_header->id, header->real_size());
+      }
     } else {
-      back_header->num_frames = 0;
+      back_header->id = 0;
     }
   }
 
@@ -351,10 +357,16 @@ void debug_free(void* pointer) {
       bool backtrace_found = false;
       if (g_debug->config().options & BACKTRACE) {
         BacktraceHeader* back_header = g_debug->GetAllocBacktrace(header);
-        backtrace_found = back_header->num_frames > 0;
+        backtrace_found = back_header->id != 0;
       }
       g_debug->track->Remove(header, backtrace_found);
     }
+    if (g_debug->config().options & SAMPLE) {
+      BacktraceHeader* back_header = g_debug->GetAllocBacktrace(header);
+      if (back_header->id != 0) {
+        g_debug->sample->Remove(back_header->id, header->real_size());
+      }
+    }
     header->tag = DEBUG_FREE_TAG;
 
     bytes = header->usable_size;
@@ -491,6 +503,12 @@ void* debug_realloc(void* pointer, size_t bytes) {
 
     // Allocation is shrinking.
     if (real_size < header->usable_size) {
+      if (g_debug->config().options & SAMPLE) {
+        BacktraceHeader* back_header = g_debug->GetAllocBacktrace(header);
+        if (back_header->id != 0) {
+          g_debug->sample->Resize(back_header->id, header->real_size(), real_size);
+        }
+      }
       header->size = real_size;
       if (*g_malloc_zygote_child) {
         header->set_zygote();
@@ -661,11 +679,13 @@ ssize_t debug_malloc_backtrace(void* pointer, uintptr_t* frames, size_t frame_co
     }
     if (g_debug->config().options & BACKTRACE) {
       BacktraceHeader* back_header = g_debug->GetAllocBacktrace(header);
-      if (back_header->num_frames > 0) {
-        if (frame_count > back_header->num_frames) {
-          frame_count = back_header->num_frames;
+      size_t num_frames;
+      const uintptr_t* back_frames = g_debug->backtrace_table->Get(back_header->id, &num_frames);
+      if (num_frames > 0) {
+        if (frame_count > num_frames) {
+          frame_count = num_frames;
         }
-        memcpy(frames, &back_header->frames[0], frame_count * sizeof(uintptr_t));
+        memcpy(frames, back_frames, frame_count * sizeof(uintptr_t));
         return frame_count;
       }
     }
@@ -674,6 +694,16 @@ ssize_t debug_malloc_backtrace(void* pointer, uintptr_t* frames, size_t frame_co
   return 0;
 }
 
+bool debug_dump_heap_profile(int fd) {
+  if (!(g_debug->config().options & SAMPLE)) {
+    error_log("dump_heap_profile: Allocations not being sampled, to enable "
+              "set the option 'sample_rate'.");
+    return false;
+  }
+
+  return g_debug->sample->Dump(*g_debug, fd);
+}
+
 #if defined(HAVE_DEPRECATED_MALLOC_FUNCS)
 void* debug_pvalloc(size_t bytes) {
   if (DebugCallsDisabled()) {
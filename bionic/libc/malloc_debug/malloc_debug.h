@@ -38,7 +38,7 @@
 // part of the header does not exist, the other parts of the header
 // will still be in this order.
 //   Header          (Required)
-//   BacktraceHeader (Optional: For the allocation backtrace)
+//   BacktraceHeader (Optional: The id of the allocation backtrace)
 //   uint8_t data    (Optional: Front guard, will be a multiple of MINIMUM_ALIGNMENT_BYTES)
 //   allocation data
 //   uint8_t data    (Optional: End guard)
@@ -59,8 +59,8 @@ struct Header {
 } __attribute__((packed));
 
 struct BacktraceHeader {
-  size_t num_frames;
-  uintptr_t frames[0];
+  // The backtrace's id in DebugData::backtrace_table, or 0 if there isn't one.
+  uint32_t id;
 } __attribute__((packed));
 
 constexpr uint32_t DEBUG_TAG = 0x1ee7d00d;
@@ -74,6 +74,12 @@ std::string usage_string(
   "6 malloc_debug     receives a signal. If XX is set it sets the number of backtrace\n"
   "6 malloc_debug     frames. The default is 16 frames, the max number of frames is 256.\n"
   "6 malloc_debug \n"
+  "6 malloc_debug   sample_rate[=XX]\n"
+  "6 malloc_debug     Capture the backtrace of a random sample of allocations, on\n"
+  "6 malloc_debug     average one for every XX bytes allocated. The live sampled\n"
+  "6 malloc_debug     allocations can be dumped as a heap profile. The default is\n"
+  "6 malloc_debug     524288 bytes, the max is 1073741824.\n"
+  "6 malloc_debug \n"
   "6 malloc_debug   fill_on_alloc[=XX]\n"
   "6 malloc_debug     On first allocation, fill with the value 0xeb.\n"
   "6 malloc_debug     If XX is set it will only fill up to XX bytes of the\n"
@@ -305,6 +311,32 @@ TEST_F(MallocDebugConfigTest, backtrace_enable_on_signal) {
   ASSERT_STREQ("", getFakeLogPrint().c_str());
 }
 
+TEST_F(MallocDebugConfigTest, sample_rate) {
+  ASSERT_TRUE(InitConfig("sample_rate=4096"));
+  ASSERT_EQ(BACKTRACE | SAMPLE, config->options);
+  ASSERT_EQ(4096U, config->sample_rate);
+  ASSERT_EQ(16U, config->backtrace_frames);
+  ASSERT_TRUE(config->backtrace_enabled);
+
+  ASSERT_TRUE(InitConfig("sample_rate"));
+  ASSERT_EQ(BACKTRACE | SAMPLE, config->options);
+  ASSERT_EQ(524288U, config->sample_rate);
+  ASSERT_EQ(16U, config->backtrace_frames);
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ("", getFakeLogPrint().c_str());
+}
+
+TEST_F(MallocDebugConfigTest, sample_rate_and_backtrace) {
+  ASSERT_TRUE(InitConfig("sample_rate=4096 backtrace=32"));
+  ASSERT_EQ(BACKTRACE | SAMPLE | TRACK_ALLOCS, config->options);
+  ASSERT_EQ(4096U, config->sample_rate);
+  ASSERT_EQ(32U, config->backtrace_frames);
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ("", getFakeLogPrint().c_str());
+}
+
 TEST_F(MallocDebugConfigTest, fill_on_alloc) {
   ASSERT_TRUE(InitConfig("fill_on_alloc=64"));
   ASSERT_EQ(FILL_ON_ALLOC, config->options);
@@ -626,3 +658,23 @@ TEST_F(MallocDebugConfigTest, free_track_backtrace_num_frames_max_error) {
       "value must be <= 256: 400\n");
   ASSERT_STREQ((log_msg + usage_string).c_str(), getFakeLogPrint().c_str());
 }
+
+TEST_F(MallocDebugConfigTest, sample_rate_min_error) {
+  ASSERT_FALSE(InitConfig("sample_rate=0"));
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  std::string log_msg(
+      "6 malloc_debug malloc_testing: bad value for option 'sample_rate', "
+      "value must be >= 1: 0\n");
+  ASSERT_STREQ((log_msg + usage_string).c_str(), getFakeLogPrint().c_str());
+}
+
+TEST_F(MallocDebugConfigTest, sample_rate_max_error) {
+  ASSERT_FALSE(InitConfig("sample_rate=2000000000"));
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  std::string log_msg(
+      "6 malloc_debug malloc_testing: bad value for option 'sample_rate', "
+      "value must be <= 1073741824: 2000000000\n");
+  ASSERT_STREQ((log_msg + usage_string).c_str(), getFakeLogPrint().c_str());
+}
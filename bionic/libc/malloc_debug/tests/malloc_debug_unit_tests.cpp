@@ -16,6 +16,7 @@
 
 #include <malloc.h>
 #include <signal.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/cdefs.h>
@@ -24,6 +25,7 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <string>
 #include <thread>
 #include <vector>
 #include <utility>
@@ -35,6 +37,7 @@
 #include <private/bionic_macros.h>
 #include <private/bionic_malloc_dispatch.h>
 
+#include "BacktraceTable.h"
 #include "Config.h"
 #include "malloc_debug.h"
 
@@ -56,6 +59,8 @@ void* debug_memalign(size_t, size_t);
 size_t debug_malloc_usable_size(void*);
 void debug_get_malloc_leak_info(uint8_t**, size_t*, size_t*, size_t*, size_t*);
 void debug_free_malloc_leak_info(uint8_t*);
+ssize_t debug_malloc_backtrace(void*, uintptr_t*, size_t);
+bool debug_dump_heap_profile(int);
 
 struct mallinfo debug_mallinfo();
 
@@ -71,10 +76,10 @@ constexpr char DIVIDER[] =
 
 constexpr uint32_t BACKTRACE_HEADER = 0x1;
 
-static size_t get_tag_offset(uint32_t flags = 0, size_t backtrace_frames = 0) {
+static size_t get_tag_offset(uint32_t flags = 0) {
   size_t offset = BIONIC_ALIGN(sizeof(Header), MINIMUM_ALIGNMENT_BYTES);
   if (flags & BACKTRACE_HEADER) {
-    offset += BIONIC_ALIGN(sizeof(BacktraceHeader) + sizeof(uintptr_t) * backtrace_frames, MINIMUM_ALIGNMENT_BYTES);
+    offset += BIONIC_ALIGN(sizeof(BacktraceHeader), MINIMUM_ALIGNMENT_BYTES);
   }
   return offset;
 }
@@ -946,6 +951,35 @@ TEST_F(MallocDebugTest, free_track_multiple_thread) {
   ASSERT_STREQ("", getFakeLogPrint().c_str());
 }
 
+TEST_F(MallocDebugTest, leak_track_multiple_thread) {
+  Init("leak_track backtrace");
+
+  std::vector<std::thread*> threads(16);
+  for (size_t i = 0; i < threads.size(); i++) {
+    threads[i] = new std::thread([](){
+      std::vector<void*> pointers(50);
+      for (size_t j = 0; j < 200; j++) {
+        for (auto& pointer : pointers) {
+          pointer = debug_malloc(100);
+        }
+        for (auto& pointer : pointers) {
+          debug_free(pointer);
+        }
+      }
+    });
+  }
+  for (size_t i = 0; i < threads.size(); i++) {
+    threads[i]->join();
+    delete threads[i];
+  }
+
+  debug_finalize();
+  initialized = false;
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ("", getFakeLogPrint().c_str());
+}
+
 TEST_F(MallocDebugTest, get_malloc_leak_info_invalid) {
   Init("fill");
 
@@ -1213,6 +1247,181 @@ TEST_F(MallocDebugTest, get_malloc_leak_info_multi_skip_empty_backtrace) {
   ASSERT_STREQ("", getFakeLogPrint().c_str());
 }
 
+TEST_F(MallocDebugTest, backtrace_shared_between_allocations) {
+  Init("backtrace=256");
+
+  backtrace_fake_add(std::vector<uintptr_t> {0xa, 0xb, 0xc});
+  backtrace_fake_add(std::vector<uintptr_t> {0xa, 0xb, 0xc});
+  backtrace_fake_add(std::vector<uintptr_t> {0xa, 0xb});
+
+  uint8_t* pointer1 = reinterpret_cast<uint8_t*>(debug_malloc(10));
+  ASSERT_TRUE(pointer1 != nullptr);
+  uint8_t* pointer2 = reinterpret_cast<uint8_t*>(debug_malloc(20));
+  ASSERT_TRUE(pointer2 != nullptr);
+  uint8_t* pointer3 = reinterpret_cast<uint8_t*>(debug_malloc(30));
+  ASSERT_TRUE(pointer3 != nullptr);
+
+  // The header only holds an id, however many frames are being captured.
+  const Header* header1 = reinterpret_cast<const Header*>(
+      pointer1 - get_tag_offset(BACKTRACE_HEADER));
+  ASSERT_EQ(DEBUG_TAG, header1->tag);
+  const Header* header2 = reinterpret_cast<const Header*>(
+      pointer2 - get_tag_offset(BACKTRACE_HEADER));
+  ASSERT_EQ(DEBUG_TAG, header2->tag);
+  const Header* header3 = reinterpret_cast<const Header*>(
+      pointer3 - get_tag_offset(BACKTRACE_HEADER));
+  ASSERT_EQ(DEBUG_TAG, header3->tag);
+
+  size_t back_offset = BIONIC_ALIGN(sizeof(Header), MINIMUM_ALIGNMENT_BYTES);
+  uint32_t id1 = reinterpret_cast<const BacktraceHeader*>(
+      reinterpret_cast<uintptr_t>(header1) + back_offset)->id;
+  uint32_t id2 = reinterpret_cast<const BacktraceHeader*>(
+      reinterpret_cast<uintptr_t>(header2) + back_offset)->id;
+  uint32_t id3 = reinterpret_cast<const BacktraceHeader*>(
+      reinterpret_cast<uintptr_t>(header3) + back_offset)->id;
+  ASSERT_NE(0U, id1);
+  ASSERT_EQ(id1, id2);
+  ASSERT_NE(id1, id3);
+
+  uintptr_t frames[4];
+  ASSERT_EQ(3, debug_malloc_backtrace(pointer2, frames, 4));
+  ASSERT_EQ(0xaU, frames[0]);
+  ASSERT_EQ(0xbU, frames[1]);
+  ASSERT_EQ(0xcU, frames[2]);
+  ASSERT_EQ(2, debug_malloc_backtrace(pointer3, frames, 4));
+  ASSERT_EQ(0xaU, frames[0]);
+  ASSERT_EQ(0xbU, frames[1]);
+
+  debug_free(pointer1);
+  debug_free(pointer2);
+  debug_free(pointer3);
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ("", getFakeLogPrint().c_str());
+}
+
+// Returns the part of the heap profile before the list of maps.
+static std::string DumpHeapProfile() {
+  FILE* fp = tmpfile();
+  if (fp == nullptr) {
+    return "tmpfile failed";
+  }
+  if (!debug_dump_heap_profile(fileno(fp))) {
+    fclose(fp);
+    return "debug_dump_heap_profile failed";
+  }
+  std::string profile;
+  char buffer[4096];
+  lseek(fileno(fp), 0, SEEK_SET);
+  ssize_t bytes;
+  while ((bytes = read(fileno(fp), buffer, sizeof(buffer))) > 0) {
+    profile.append(buffer, bytes);
+  }
+  fclose(fp);
+  return profile.substr(0, profile.find("\nMAPPED_LIBRARIES:\n"));
+}
+
+TEST_F(MallocDebugTest, sample_rate_dump_heap_profile) {
+  // With a sample rate of one byte, every allocation this large is sampled.
+  Init("sample_rate=1");
+
+  backtrace_fake_add(std::vector<uintptr_t> {0xa, 0xb, 0xc});
+  backtrace_fake_add(std::vector<uintptr_t> {0xa, 0xb, 0xc});
+  backtrace_fake_add(std::vector<uintptr_t> {0x1000, 0x2000});
+
+  void* pointer1 = debug_malloc(100);
+  ASSERT_TRUE(pointer1 != nullptr);
+  void* pointer2 = debug_malloc(200);
+  ASSERT_TRUE(pointer2 != nullptr);
+  void* pointer3 = debug_calloc(1, 1000);
+  ASSERT_TRUE(pointer3 != nullptr);
+
+  ASSERT_STREQ(
+      "heap profile:      3:     1300 [     3:     1300] @ heap_v2/1\n"
+      "     1:     1000 [     1:     1000] @ 0x1000 0x2000\n"
+      "     2:      300 [     2:      300] @ 0xa 0xb 0xc\n",
+      DumpHeapProfile().c_str());
+
+  // Shrinking and freeing sampled allocations only changes the live totals.
+  ASSERT_EQ(pointer3, debug_realloc(pointer3, 500));
+  debug_free(pointer1);
+  ASSERT_STREQ(
+      "heap profile:      2:      700 [     3:     1300] @ heap_v2/1\n"
+      "     1:      500 [     1:     1000] @ 0x1000 0x2000\n"
+      "     1:      200 [     2:      300] @ 0xa 0xb 0xc\n",
+      DumpHeapProfile().c_str());
+
+  debug_free(pointer2);
+  debug_free(pointer3);
+  ASSERT_STREQ(
+      "heap profile:      0:        0 [     3:     1300] @ heap_v2/1\n"
+      "     0:        0 [     1:     1000] @ 0x1000 0x2000\n"
+      "     0:        0 [     2:      300] @ 0xa 0xb 0xc\n",
+      DumpHeapProfile().c_str());
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ("", getFakeLogPrint().c_str());
+}
+
+TEST_F(MallocDebugTest, sample_rate_samples_by_bytes) {
+  Init("sample_rate=4096");
+
+  const size_t kAllocs = 20000;
+  const size_t kSize = 64;
+  for (size_t i = 0; i < kAllocs; i++) {
+    backtrace_fake_add(std::vector<uintptr_t> {0x100});
+  }
+
+  std::vector<void*> pointers;
+  for (size_t i = 0; i < kAllocs; i++) {
+    void* pointer = debug_malloc(kSize);
+    ASSERT_TRUE(pointer != nullptr);
+    pointers.push_back(pointer);
+  }
+
+  // Only the sampled allocations capture a backtrace.
+  size_t with_backtrace = 0;
+  for (void* pointer : pointers) {
+    const BacktraceHeader* back_header = reinterpret_cast<const BacktraceHeader*>(
+        reinterpret_cast<uintptr_t>(pointer) - get_tag_offset(BACKTRACE_HEADER) +
+        BIONIC_ALIGN(sizeof(Header), MINIMUM_ALIGNMENT_BYTES));
+    if (back_header->id != 0) {
+      with_backtrace++;
+    }
+  }
+
+  // On average one allocation every 4096 bytes is sampled, which is 312.5
+  // allocations here, and the standard deviation is about 18.
+  ASSERT_LT(200U, with_backtrace);
+  ASSERT_GT(425U, with_backtrace);
+
+  std::string expected(android::base::StringPrintf(
+      "heap profile: %6zu: %8zu [%6zu: %8zu] @ heap_v2/4096\n"
+      "%6zu: %8zu [%6zu: %8zu] @ 0x100\n",
+      with_backtrace, with_backtrace * kSize, with_backtrace, with_backtrace * kSize,
+      with_backtrace, with_backtrace * kSize, with_backtrace, with_backtrace * kSize));
+  ASSERT_STREQ(expected.c_str(), DumpHeapProfile().c_str());
+
+  for (void* pointer : pointers) {
+    debug_free(pointer);
+  }
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ("", getFakeLogPrint().c_str());
+}
+
+TEST_F(MallocDebugTest, dump_heap_profile_not_enabled) {
+  Init("backtrace");
+
+  ASSERT_FALSE(debug_dump_heap_profile(STDOUT_FILENO));
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  std::string expected_log = android::base::StringPrintf(
+      "6 malloc_debug dump_heap_profile: Allocations not being sampled, to enable "
+      "set the option 'sample_rate'.\n");
+  ASSERT_STREQ(expected_log.c_str(), getFakeLogPrint().c_str());
+}
+
 TEST_F(MallocDebugTest, realloc_usable_size) {
   Init("front_guard");
 
@@ -1512,3 +1721,96 @@ TEST_F(MallocDebugTest, debug_valloc) {
   debug_free(pointer);
 }
 #endif
+
+class MallocDebugBacktraceTableTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    resetLogs();
+    ASSERT_TRUE(table.Initialize());
+  }
+
+  BacktraceTable table;
+};
+
+TEST_F(MallocDebugBacktraceTableTest, add_and_get) {
+  ASSERT_EQ(0U, table.Add(nullptr, 0));
+
+  uintptr_t frames1[] = { 0x100, 0x200, 0x300 };
+  uintptr_t frames2[] = { 0x100, 0x200 };
+  uint32_t id1 = table.Add(frames1, 3);
+  uint32_t id2 = table.Add(frames2, 2);
+  ASSERT_NE(0U, id1);
+  ASSERT_NE(0U, id2);
+  ASSERT_NE(id1, id2);
+  ASSERT_EQ(id1, table.Add(frames1, 3));
+  ASSERT_EQ(2U, table.size());
+
+  size_t num_frames;
+  const uintptr_t* frames = table.Get(id1, &num_frames);
+  ASSERT_EQ(3U, num_frames);
+  ASSERT_EQ(0, memcmp(frames1, frames, sizeof(frames1)));
+  frames = table.Get(id2, &num_frames);
+  ASSERT_EQ(2U, num_frames);
+  ASSERT_EQ(0, memcmp(frames2, frames, sizeof(frames2)));
+
+  ASSERT_TRUE(table.Get(0, &num_frames) == nullptr);
+  ASSERT_EQ(0U, num_frames);
+}
+
+TEST_F(MallocDebugBacktraceTableTest, full) {
+  for (size_t i = 0; i < BacktraceTable::kMaxEntries; i++) {
+    uintptr_t frame = i;
+    ASSERT_NE(0U, table.Add(&frame, 1)) << i;
+  }
+  ASSERT_EQ(BacktraceTable::kMaxEntries, table.size());
+
+  // New backtraces are dropped, existing ones can still be found.
+  uintptr_t frame = BacktraceTable::kMaxEntries;
+  ASSERT_EQ(0U, table.Add(&frame, 1));
+  frame = 0;
+  ASSERT_NE(0U, table.Add(&frame, 1));
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ(
+      "6 malloc_debug The backtrace table is full, new backtraces will not be recorded.\n",
+      getFakeLogPrint().c_str());
+}
+
+TEST_F(MallocDebugBacktraceTableTest, multiple_thread) {
+  // Every thread adds the same backtraces in a different order, so they race
+  // to add each one.
+  static constexpr size_t kNumBacktraces = 5000;
+  static constexpr size_t kNumThreads = 8;
+  // None of these divide kNumBacktraces, so each thread visits every backtrace.
+  static constexpr size_t kStrides[kNumThreads] = { 1, 3, 7, 11, 13, 17, 19, 23 };
+  std::vector<std::vector<uint32_t>> ids(kNumThreads);
+  std::vector<std::thread*> threads(kNumThreads);
+  for (size_t i = 0; i < kNumThreads; i++) {
+    ids[i].resize(kNumBacktraces);
+    threads[i] = new std::thread([this, i, &ids](){
+      for (size_t j = 0; j < kNumBacktraces; j++) {
+        size_t n = (j * kStrides[i]) % kNumBacktraces;
+        uintptr_t frames[] = { n, 0x1000, n * 3 };
+        ids[i][n] = table.Add(frames, 1 + n % 3);
+      }
+    });
+  }
+  for (size_t i = 0; i < kNumThreads; i++) {
+    threads[i]->join();
+    delete threads[i];
+  }
+
+  ASSERT_EQ(kNumBacktraces, table.size());
+  for (size_t n = 0; n < kNumBacktraces; n++) {
+    ASSERT_NE(0U, ids[0][n]);
+    for (size_t i = 1; i < kNumThreads; i++) {
+      ASSERT_EQ(ids[0][n], ids[i][n]) << n;
+    }
+    size_t num_frames;
+    const uintptr_t* frames = table.Get(ids[0][n], &num_frames);
+    ASSERT_EQ(1 + n % 3, num_frames);
+    ASSERT_EQ(n, frames[0]);
+    if (num_frames > 1) ASSERT_EQ(0x1000U, frames[1]);
+    if (num_frames > 2) ASSERT_EQ(n * 3, frames[2]);
+  }
+}
@@ -0,0 +1,356 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef _BIONIC_PROPERTY_CONTEXTS_H
+#define _BIONIC_PROPERTY_CONTEXTS_H
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/xattr.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/xattr.h>
+
+/*
+ * The prefix to context mapping from /property_contexts is kept in a single
+ * position-independent table. init writes it into the property directory, so
+ * that other processes can map it in rather than parse /property_contexts.
+ *
+ * The prefixes are sorted, and each one records its parent: the longest other
+ * prefix in the table that is a prefix of it. The longest prefix matching a
+ * name is always on the parent chain of the last prefix that sorts <= the
+ * name, so a lookup is a binary search and a short walk up that chain.
+ * Prefixes starting with '*' match any name and are kept as the default
+ * context instead.
+ */
+#define CONTEXTS_TABLE_MAGIC 0x43505250 // "PRPC"
+#define CONTEXTS_TABLE_VERSION 1
+#define CONTEXTS_TABLE_NONE 0xffffffffu
+
+struct contexts_table {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    uint32_t num_contexts;
+    uint32_t num_prefixes;
+    uint32_t default_context;
+    // Followed by the offsets of num_contexts context names, then
+    // num_prefixes prefix_entry structures, then the strings themselves.
+    // All offsets are from the start of the table.
+};
+
+struct prefix_entry {
+    uint32_t prefix;
+    uint32_t prefix_len;
+    uint32_t context;
+    uint32_t parent;
+};
+
+static inline const uint32_t* table_context_names(const contexts_table* table) {
+    return reinterpret_cast<const uint32_t*>(table + 1);
+}
+
+static inline const prefix_entry* table_prefixes(const contexts_table* table) {
+    return reinterpret_cast<const prefix_entry*>(table_context_names(table) + table->num_contexts);
+}
+
+static inline const char* table_string(const contexts_table* table, uint32_t offset) {
+    return reinterpret_cast<const char*>(table) + offset;
+}
+
+static uint32_t find_context(const contexts_table* table, const char* name) {
+    const prefix_entry* prefixes = table_prefixes(table);
+
+    // Find the last prefix that sorts <= name.
+    uint32_t lo = 0;
+    uint32_t hi = table->num_prefixes;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (strcmp(table_string(table, prefixes[mid].prefix), name) <= 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    // If there's no such prefix, lo - 1 wraps around to CONTEXTS_TABLE_NONE.
+    for (uint32_t i = lo - 1; i != CONTEXTS_TABLE_NONE; i = prefixes[i].parent) {
+        if (!strncmp(table_string(table, prefixes[i].prefix), name, prefixes[i].prefix_len)) {
+            return prefixes[i].context;
+        }
+    }
+    return table->default_context;
+}
+
+
+struct context_spec {
+    char* prefix;
+    char* context;
+    size_t line;
+};
+
+static int compare_context_specs(const void* lhs, const void* rhs) {
+    const context_spec* l = static_cast<const context_spec*>(lhs);
+    const context_spec* r = static_cast<const context_spec*>(rhs);
+    int result = strcmp(l->prefix, r->prefix);
+    if (result != 0) {
+        return result;
+    }
+    return (l->line > r->line) - (l->line < r->line);
+}
+
+// Only the first line for each prefix goes in the table, and '*' lines don't.
+// Expects the specs to be sorted.
+static bool is_table_prefix(const context_spec* specs, size_t i) {
+    return specs[i].prefix[0] != '*' && (i == 0 || strcmp(specs[i - 1].prefix, specs[i].prefix));
+}
+
+/*
+ * Builds a contexts_table from the given specs, sorting them in place. If a
+ * prefix is listed more than once its first line wins, and of the '*' lines
+ * the last one wins.
+ */
+static contexts_table* build_contexts_table(context_spec* specs, size_t num_specs) {
+    qsort(specs, num_specs, sizeof(context_spec), compare_context_specs);
+
+    // Scratch space for the context of each spec, the stack of prefixes
+    // enclosing the current one, and the distinct context names.
+    void* scratch = calloc(num_specs, 2 * sizeof(uint32_t) + sizeof(const char*));
+    if (scratch == nullptr && num_specs != 0) {
+        return nullptr;
+    }
+    const char** names = static_cast<const char**>(scratch);
+    uint32_t* spec_contexts = reinterpret_cast<uint32_t*>(names + num_specs);
+    uint32_t* enclosing = spec_contexts + num_specs;
+
+    // Every context gets a property area, even if no prefix ends up using it.
+    uint32_t num_contexts = 0;
+    uint32_t num_prefixes = 0;
+    uint32_t default_context = CONTEXTS_TABLE_NONE;
+    size_t default_line = 0;
+    size_t strings_size = 0;
+    for (size_t i = 0; i < num_specs; ++i) {
+        uint32_t context = 0;
+        while (context < num_contexts && strcmp(names[context], specs[i].context)) {
+            ++context;
+        }
+        if (context == num_contexts) {
+            names[num_contexts++] = specs[i].context;
+            strings_size += strlen(specs[i].context) + 1;
+        }
+        spec_contexts[i] = context;
+
+        if (specs[i].prefix[0] == '*') {
+            if (default_context == CONTEXTS_TABLE_NONE || specs[i].line > default_line) {
+                default_context = context;
+                default_line = specs[i].line;
+            }
+        } else if (is_table_prefix(specs, i)) {
+            ++num_prefixes;
+            strings_size += strlen(specs[i].prefix) + 1;
+        }
+    }
+
+    size_t size = sizeof(contexts_table) + num_contexts * sizeof(uint32_t) +
+                  num_prefixes * sizeof(prefix_entry) + strings_size;
+    contexts_table* table = static_cast<contexts_table*>(calloc(1, size));
+    if (table == nullptr) {
+        free(scratch);
+        return nullptr;
+    }
+    table->magic = CONTEXTS_TABLE_MAGIC;
+    table->version = CONTEXTS_TABLE_VERSION;
+    table->size = size;
+    table->num_contexts = num_contexts;
+    table->num_prefixes = num_prefixes;
+    table->default_context = default_context;
+
+    uint32_t* name_offsets = reinterpret_cast<uint32_t*>(table + 1);
+    prefix_entry* prefixes = reinterpret_cast<prefix_entry*>(name_offsets + num_contexts);
+    char* strings = reinterpret_cast<char*>(prefixes + num_prefixes);
+    auto add_string = [table, &strings](const char* s) -> uint32_t {
+        size_t len = strlen(s) + 1;
+        memcpy(strings, s, len);
+        uint32_t offset = strings - reinterpret_cast<char*>(table);
+        strings += len;
+        return offset;
+    };
+
+    for (uint32_t i = 0; i < num_contexts; ++i) {
+        name_offsets[i] = add_string(names[i]);
+    }
+
+    // In sorted order, the prefixes of each entry are all on the stack of
+    // entries enclosing the one before it.
+    uint32_t depth = 0;
+    uint32_t n = 0;
+    for (size_t i = 0; i < num_specs; ++i) {
+        if (!is_table_prefix(specs, i)) {
+            continue;
+        }
+        prefix_entry* entry = &prefixes[n];
+        entry->prefix = add_string(specs[i].prefix);
+        entry->prefix_len = strlen(specs[i].prefix);
+        entry->context = spec_contexts[i];
+        while (depth > 0) {
+            const prefix_entry* parent = &prefixes[enclosing[depth - 1]];
+            if (!strncmp(table_string(table, parent->prefix), specs[i].prefix, parent->prefix_len)) {
+                break;
+            }
+            --depth;
+        }
+        entry->parent = (depth > 0) ? enclosing[depth - 1] : CONTEXTS_TABLE_NONE;
+        enclosing[depth++] = n++;
+    }
+
+    free(scratch);
+    return table;
+}
+
+// Checks a table of the given size, mapped in from a file, before any lookups
+// trust it.
+static bool check_contexts_table(const contexts_table* table, size_t size) {
+    if (size <= sizeof(contexts_table)) {
+        return false;
+    }
+    if (table->magic != CONTEXTS_TABLE_MAGIC || table->version != CONTEXTS_TABLE_VERSION ||
+        table->size != size) {
+        return false;
+    }
+    uint64_t strings = sizeof(contexts_table) +
+                       static_cast<uint64_t>(table->num_contexts) * sizeof(uint32_t) +
+                       static_cast<uint64_t>(table->num_prefixes) * sizeof(prefix_entry);
+    // The last string ends at the end of the table, so none can run off it.
+    if (strings >= size || *table_string(table, size - 1) != '\0') {
+        return false;
+    }
+    if (table->default_context != CONTEXTS_TABLE_NONE &&
+        table->default_context >= table->num_contexts) {
+        return false;
+    }
+
+    const uint32_t* names = table_context_names(table);
+    for (uint32_t i = 0; i < table->num_contexts; ++i) {
+        if (names[i] < strings || names[i] >= size) {
+            return false;
+        }
+    }
+    // Parents must come first, so that walking up from any entry terminates.
+    const prefix_entry* prefixes = table_prefixes(table);
+    for (uint32_t i = 0; i < table->num_prefixes; ++i) {
+        const prefix_entry& entry = prefixes[i];
+        if (entry.prefix < strings || entry.prefix >= size ||
+            entry.prefix_len != strlen(table_string(table, entry.prefix)) ||
+            entry.context >= table->num_contexts ||
+            (entry.parent != CONTEXTS_TABLE_NONE && entry.parent >= i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Writes a table out to filename. It goes to tmp_filename first and is then
+ * renamed into place, so that nobody maps a partially written table. If
+ * selinux_context isn't null the file gets that label, and *fsetxattr_failed
+ * is set if it can't.
+ */
+static bool write_contexts_table_file(const contexts_table* table, const char* filename,
+                                      const char* tmp_filename, const char* selinux_context,
+                                      bool* fsetxattr_failed) {
+    const int fd = open(tmp_filename, O_WRONLY | O_CREAT | O_NOFOLLOW | O_CLOEXEC | O_EXCL, 0444);
+    if (fd < 0) {
+        return false;
+    }
+
+    if (selinux_context != nullptr &&
+        fsetxattr(fd, XATTR_NAME_SELINUX, selinux_context, strlen(selinux_context) + 1, 0) != 0) {
+        *fsetxattr_failed = true;
+    }
+
+    const char* p = reinterpret_cast<const char*>(table);
+    size_t remaining = table->size;
+    while (remaining > 0) {
+        ssize_t written = TEMP_FAILURE_RETRY(write(fd, p, remaining));
+        if (written <= 0) {
+            close(fd);
+            unlink(tmp_filename);
+            return false;
+        }
+        p += written;
+        remaining -= written;
+    }
+    close(fd);
+
+    if (rename(tmp_filename, filename) != 0) {
+        unlink(tmp_filename);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Maps in a table written by write_contexts_table_file(). The file must be
+ * owned by uid and gid and not writable by anyone else, and the table must
+ * pass check_contexts_table(). Unmap it with munmap(table, table->size).
+ */
+static contexts_table* map_contexts_table_file(const char* filename, uid_t uid, gid_t gid) {
+    int fd = open(filename, O_CLOEXEC | O_NOFOLLOW | O_RDONLY);
+    if (fd == -1) {
+        return nullptr;
+    }
+
+    struct stat fd_stat;
+    void* map_result = MAP_FAILED;
+    if ((fstat(fd, &fd_stat) == 0)
+            && (fd_stat.st_uid == uid)
+            && (fd_stat.st_gid == gid)
+            && ((fd_stat.st_mode & (S_IWGRP | S_IWOTH)) == 0)
+            && (fd_stat.st_size > static_cast<off_t>(sizeof(contexts_table)))
+            && (fd_stat.st_size <= static_cast<off_t>(UINT32_MAX))) {
+        map_result = mmap(NULL, fd_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (map_result == MAP_FAILED) {
+        return nullptr;
+    }
+
+    contexts_table* table = static_cast<contexts_table*>(map_result);
+    if (!check_contexts_table(table, fd_stat.st_size)) {
+        munmap(map_result, fd_stat.st_size);
+        return nullptr;
+    }
+    return table;
+}
+
+#endif  // _BIONIC_PROPERTY_CONTEXTS_H
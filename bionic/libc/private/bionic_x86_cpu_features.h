@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef _BIONIC_X86_CPU_FEATURES_H
+#define _BIONIC_X86_CPU_FEATURES_H
+
+#include <cpuid.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * The CPU features that libc and libm pick their x86 routines by. This is
+ * called from IRELATIVE resolvers, which run before libc is relocated or
+ * initialized, so it must not call into libc or touch any globals.
+ */
+struct x86_cpu_features {
+  bool avx2;
+  bool fma;
+  bool erms;
+};
+
+static inline struct x86_cpu_features get_x86_cpu_features(void) {
+  const uint32_t xsave_ymm_state = 0x6; /* XCR0 SSE and AVX state. */
+  const uint32_t leaf7_ebx_avx2 = 1 << 5;
+  const uint32_t leaf7_ebx_erms = 1 << 9;
+
+  struct x86_cpu_features features = { false, false, false };
+  if (__get_cpuid_max(0, NULL) < 7) {
+    return features;
+  }
+  unsigned int eax, ebx, ecx, edx;
+  __cpuid(1, eax, ebx, ecx, edx);
+  /* AVX2 and FMA are only usable if the kernel saves the YMM registers. */
+  bool ymm_enabled = false;
+  if ((ecx & bit_OSXSAVE) != 0 && (ecx & bit_AVX) != 0) {
+    uint32_t xcr0_lo, xcr0_hi;
+    __asm__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    ymm_enabled = (xcr0_lo & xsave_ymm_state) == xsave_ymm_state;
+  }
+  features.fma = ymm_enabled && (ecx & bit_FMA) != 0;
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+  features.avx2 = ymm_enabled && (ebx & leaf7_ebx_avx2) != 0;
+  features.erms = (ebx & leaf7_ebx_erms) != 0;
+  return features;
+}
+
+#endif /* _BIONIC_X86_CPU_FEATURES_H */
@@ -122,6 +122,12 @@ struct __sfileext {
   // Equivalent to `_seek` but for _FILE_OFFSET_BITS=64.
   // Callers should use this but fall back to `__sFILE::_seek`.
   off64_t (*_seek64)(void*, off64_t, int);
+
+  // Read buffer sizing (see __srefill). `_buf_can_grow` is set when
+  // __smakebuf chose the buffer for a regular file, and `_buf_was_filled`
+  // when the last refill read a whole buffer's worth.
+  bool _buf_can_grow;
+  bool _buf_was_filled;
 };
 
 // Values for `__sFILE::_flags`.
@@ -167,6 +173,8 @@ do { \
 	pthread_mutex_init(&_FLOCK(fp), &attr); \
 	pthread_mutexattr_destroy(&attr); \
 	_EXT(fp)->_caller_handles_locking = false; \
+	_EXT(fp)->_buf_can_grow = false; \
+	_EXT(fp)->_buf_was_filled = false; \
 } while (0)
 
 #define _FILEEXT_SETUP(f, fext) \
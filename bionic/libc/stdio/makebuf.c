@@ -71,6 +71,8 @@ __smakebuf(FILE *fp)
 	if (couldbetty && isatty(fp->_file))
 		flags |= __SLBF;
 	fp->_flags |= flags;
+	/* __swhatbuf only sets _blksize for regular files. */
+	_EXT(fp)->_buf_can_grow = (fp->_blksize != 0);
 }
 
 /*
@@ -81,6 +83,11 @@ __swhatbuf(FILE *fp, size_t *bufsize, int *couldbetty)
 {
 	struct stat st;
 
+	/* Our caller is replacing the buffer, so forget how the old one was sized. */
+	_EXT(fp)->_buf_can_grow = false;
+	_EXT(fp)->_buf_was_filled = false;
+	fp->_blksize = 0;
+
 	if (fp->_file < 0 || fstat(fp->_file, &st) < 0) {
 		*couldbetty = 0;
 		*bufsize = BUFSIZ;
@@ -95,12 +102,14 @@ __swhatbuf(FILE *fp, size_t *bufsize, int *couldbetty)
 	}
 
 	/*
-	 * Optimise fseek() only if it is a regular file.  (The test for
-	 * __sseek is mainly paranoia.)  It is safe to set _blksize
-	 * unconditionally; it will only be used if __SOPT is also set.
+	 * Start with the file system's preferred I/O size.  For a regular
+	 * file, remember it; __srefill may grow the buffer in multiples of
+	 * it if the file turns out to be read sequentially.
 	 */
 	*bufsize = st.st_blksize;
-	fp->_blksize = st.st_blksize;
+	if (S_ISREG(st.st_mode)) {
+		fp->_blksize = st.st_blksize;
+	}
 	return ((st.st_mode & S_IFMT) == S_IFREG && fp->_seek == __sseek ?
 	    __SOPT : __SNPT);
 }
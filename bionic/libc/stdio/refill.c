@@ -36,6 +36,11 @@
 #include <stdlib.h>
 #include "local.h"
 
+/*
+ * The largest buffer __srefill will grow a regular file's buffer to.
+ */
+#define	MAX_GROWN_BUFSIZE	(64 * 1024)
+
 static int
 lflush(FILE *fp)
 {
@@ -44,6 +49,33 @@ lflush(FILE *fp)
 	return (0);
 }
 
+/*
+ * A regular file that keeps filling the whole buffer is being read
+ * sequentially, so double the buffer (up to MAX_GROWN_BUFSIZE) to halve
+ * the number of read(2) calls.  The buffer has been consumed when we get
+ * here, so there's nothing to copy.  Small files and random access never
+ * grow past st_blksize, and a buffer from setvbuf is never touched.
+ */
+static void
+growbuf(FILE *fp)
+{
+	struct __sfileext *ext = _EXT(fp);
+	unsigned char *p;
+	size_t size;
+
+	if (!ext->_buf_can_grow || !ext->_buf_was_filled ||
+	    (fp->_flags & __SMBF) == 0 || fp->_bf._size >= MAX_GROWN_BUFSIZE)
+		return;
+	size = fp->_bf._size * 2;
+	if (size > MAX_GROWN_BUFSIZE)
+		size = MAX_GROWN_BUFSIZE;
+	if ((p = malloc(size)) == NULL)
+		return;
+	free(fp->_bf._base);
+	fp->_bf._base = p;
+	fp->_bf._size = size;
+}
+
 /*
  * Refill a stdio buffer.
  * Return EOF on eof or error, 0 otherwise.
@@ -93,6 +125,8 @@ __srefill(FILE *fp)
 
 	if (fp->_bf._base == NULL)
 		__smakebuf(fp);
+	else
+		growbuf(fp);
 
 	/*
 	 * Before reading from a line buffered or unbuffered file,
@@ -112,6 +146,7 @@ __srefill(FILE *fp)
 	fp->_p = fp->_bf._base;
 	fp->_r = (*fp->_read)(fp->_cookie, (char *)fp->_p, fp->_bf._size);
 	fp->_flags &= ~__SMOD;	/* buffer contents are again pristine */
+	_EXT(fp)->_buf_was_filled = (fp->_r == fp->_bf._size);
 	if (fp->_r <= 0) {
 		if (fp->_r == 0)
 			fp->_flags |= __SEOF;
@@ -68,9 +68,9 @@ _THREAD_PRIVATE_MUTEX(__sfp_mutex);
 #define WCHAR_IO_DATA_INIT {MBSTATE_T_INIT,MBSTATE_T_INIT,{0},0,0}
 
 static struct __sfileext __sFext[3] = {
-  { SBUF_INIT, WCHAR_IO_DATA_INIT, PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP, false, __sseek64 },
-  { SBUF_INIT, WCHAR_IO_DATA_INIT, PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP, false, __sseek64 },
-  { SBUF_INIT, WCHAR_IO_DATA_INIT, PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP, false, __sseek64 },
+  { SBUF_INIT, WCHAR_IO_DATA_INIT, PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP, false, __sseek64, false, false },
+  { SBUF_INIT, WCHAR_IO_DATA_INIT, PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP, false, __sseek64, false, false },
+  { SBUF_INIT, WCHAR_IO_DATA_INIT, PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP, false, __sseek64, false, false },
 };
 
 // __sF is exported for backwards compatibility. Until M, we didn't have symbols
@@ -499,6 +499,8 @@ int __fseeko64(FILE* fp, off64_t offset, int whence, int off_t_bits) {
   fp->_r = 0;
   /* fp->_w = 0; */	/* unnecessary (I think...) */
   fp->_flags &= ~__SEOF;
+  // A reader that seeks isn't reading sequentially, so don't grow its buffer yet.
+  _EXT(fp)->_buf_was_filled = false;
   return 0;
 }
 
@@ -254,6 +254,7 @@ LOCAL_SRC_FILES += \
 LOCAL_SRC_FILES += \
     significandl.c \
     sincos.c \
+    vmath.c \
 
 # Modified versions of BSD code.
 LOCAL_SRC_FILES += \
@@ -436,6 +437,7 @@ LOCAL_SRC_FILES_x86_64 += \
     x86_64/s_sin.S \
     x86_64/s_tanh.S \
     x86_64/s_tan.S \
+    x86_64/vmath_avx2.c \
 
 LOCAL_SRC_FILES_EXCLUDE_x86_64 += \
     upstream-freebsd/lib/msun/src/e_acos.c \
@@ -489,6 +491,7 @@ endif
 LOCAL_C_INCLUDES_x86 += $(LOCAL_PATH)/i387
 
 LOCAL_C_INCLUDES += $(LOCAL_PATH)/upstream-freebsd/lib/msun/src/
+LOCAL_C_INCLUDES += bionic/libc
 LOCAL_C_INCLUDES_64 += $(LOCAL_PATH)/upstream-freebsd/lib/msun/ld128/
 
 LOCAL_CLANG := $(libm_clang)
@@ -505,6 +508,12 @@ LOCAL_CFLAGS := \
     -Wno-unknown-pragmas \
     -fvisibility=hidden \
 
+# GCC contracts across statements by default, which would turn the exact
+# products that vmath_avx2.c relies on into FMAs. Nothing else can be
+# contracted, because FMA isn't in the x86-64 baseline.
+LOCAL_CFLAGS_x86_64 += \
+    -ffp-contract=off \
+
 LOCAL_ASFLAGS := \
     -Ibionic/libc \
 
@@ -0,0 +1,110 @@
+/*-
+ * Copyright (C) 2016 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Batch versions of exp, log, sin, cos and pow. The kernels are in
+ * vmath_kernels.h, built here for the baseline vector unit: two doubles at
+ * a time with SSE2 on x86 and NEON on arm64. 32-bit ARM and MIPS have no
+ * double-precision vectors, so they get the same branch-free code one
+ * lane at a time. On x86-64, CPUs with AVX2 and FMA use the four-lane
+ * build in x86_64/vmath_avx2.c instead.
+ */
+
+#include <android/vmath.h>
+#include <math.h>
+
+#if defined(__aarch64__) || defined(__i386__) || defined(__x86_64__)
+#define VMATH_WIDTH 2
+#else
+#define VMATH_WIDTH 1
+#endif
+#define VMATH_TARGET
+
+#include "vmath_kernels.h"
+
+#if defined(__x86_64__)
+
+#include "private/bionic_x86_cpu_features.h"
+
+void __vexp_avx2(double*, const double*, size_t);
+void __vlog_avx2(double*, const double*, size_t);
+void __vsin_avx2(double*, const double*, size_t);
+void __vcos_avx2(double*, const double*, size_t);
+void __vpow_avx2(double*, const double*, const double*, size_t);
+
+/*
+ * The x86-64 baseline is SSE4.2, so AVX2 has to be checked for at run time.
+ * This doesn't use an IFUNC because static executables don't apply IRELATIVE
+ * relocations.
+ */
+static int vmath_use_avx2(void) {
+  /* 0 means not checked yet, 1 means no, 2 means yes. Racing callers get the same answer. */
+  static int use_avx2;
+  int result = __atomic_load_n(&use_avx2, __ATOMIC_RELAXED);
+  if (__predict_false(result == 0)) {
+    struct x86_cpu_features features = get_x86_cpu_features();
+    result = (features.avx2 && features.fma) ? 2 : 1;
+    __atomic_store_n(&use_avx2, result, __ATOMIC_RELAXED);
+  }
+  return result == 2;
+}
+
+#define VMATH_DISPATCH(name, ...) \
+  if (vmath_use_avx2()) { \
+    __##name##_avx2(__VA_ARGS__); \
+    return; \
+  }
+
+#else
+
+#define VMATH_DISPATCH(name, ...)
+
+#endif
+
+void vexp(double* out, const double* in, size_t n) {
+  VMATH_DISPATCH(vexp, out, in, n);
+  vmath_batch(VMATH_EXP, out, in, NULL, n);
+}
+
+void vlog(double* out, const double* in, size_t n) {
+  VMATH_DISPATCH(vlog, out, in, n);
+  vmath_batch(VMATH_LOG, out, in, NULL, n);
+}
+
+void vsin(double* out, const double* in, size_t n) {
+  VMATH_DISPATCH(vsin, out, in, n);
+  vmath_batch(VMATH_SIN, out, in, NULL, n);
+}
+
+void vcos(double* out, const double* in, size_t n) {
+  VMATH_DISPATCH(vcos, out, in, n);
+  vmath_batch(VMATH_COS, out, in, NULL, n);
+}
+
+void vpow(double* out, const double* x, const double* y, size_t n) {
+  VMATH_DISPATCH(vpow, out, x, y, n);
+  vmath_batch(VMATH_POW, out, x, y, n);
+}
@@ -0,0 +1,426 @@
+/*-
+ * Copyright (C) 2016 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * The algorithms and constants below come from FreeBSD's e_exp.c, e_log.c,
+ * e_rem_pio2.c, k_sin.c and k_cos.c, which carry this notice:
+ *
+ * ====================================================
+ * Copyright (C) 1993 by Sun Microsystems, Inc. All rights reserved.
+ *
+ * Developed at SunPro, a Sun Microsystems, Inc. business.
+ * Permission to use, copy, modify, and distribute this
+ * software is freely granted, provided that this notice
+ * is preserved.
+ * ====================================================
+ */
+
+/*
+ * Kernels for the batch math functions, written with the compiler's vector
+ * extensions so that the same source builds for SSE2, AVX2 and NEON. The
+ * file that includes this defines VMATH_WIDTH, the number of doubles in a
+ * vector, and VMATH_TARGET, the target attribute to build the kernels with.
+ *
+ * The upstream code's branches are turned into selects. Lanes that the
+ * upstream code would send down a slow path (infinities, NaNs, subnormals,
+ * huge arguments, results near overflow or underflow) are recomputed with
+ * the scalar function instead, so those cases give exactly the scalar
+ * function's result.
+ *
+ * The double-double arithmetic in pow relies on every product being rounded
+ * on its own, so the kernels must not be built with FMA contraction.
+ */
+
+#pragma STDC FP_CONTRACT OFF
+
+#include <float.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef double vdouble __attribute__((vector_size(VMATH_WIDTH * sizeof(double))));
+typedef int64_t vint __attribute__((vector_size(VMATH_WIDTH * sizeof(int64_t))));
+
+#define VMATH_INLINE static inline __attribute__((always_inline)) VMATH_TARGET
+
+#define AS_INT(x) ((vint)(x))
+#define AS_DOUBLE(x) ((vdouble)(x))
+
+/* 1.5 * 2^52: adding it to a smaller double rounds it to an integer. */
+static const double shift = 0x1.8p52;
+
+static const double
+ln2HI   =  6.93147180369123816490e-01, /* 0x3fe62e42, 0xfee00000 */
+ln2LO   =  1.90821492927058770002e-10, /* 0x3dea39ef, 0x35793c76 */
+invln2  =  1.44269504088896338700e+00, /* 0x3ff71547, 0x652b82fe */
+two_thirds_hi = 0x1.5555555555555p-1,
+two_thirds_lo = 0x1.5555555555555p-55,
+P1      =  1.66666666666666019037e-01, /* 0x3FC55555, 0x5555553E */
+P2      = -2.77777777770155933842e-03, /* 0xBF66C16C, 0x16BEBD93 */
+P3      =  6.61375632143793436117e-05, /* 0x3F11566A, 0xAF25DE2C */
+P4      = -1.65339022054652515390e-06, /* 0xBEBBBD41, 0xC5D26BF1 */
+P5      =  4.13813679705723846039e-08, /* 0x3E663769, 0x72BEA4D0 */
+
+Lg1     =  6.666666666666735130e-01,   /* 3FE55555 55555593 */
+Lg2     =  3.999999999940941908e-01,   /* 3FD99999 9997FA04 */
+Lg3     =  2.857142874366239149e-01,   /* 3FD24924 94229359 */
+Lg4     =  2.222219843214978396e-01,   /* 3FCC71C5 1D8E78AF */
+Lg5     =  1.818357216161805012e-01,   /* 3FC74664 96CB03DE */
+Lg6     =  1.531383769920937332e-01,   /* 3FC39A09 D078C69F */
+Lg7     =  1.479819860511658591e-01,   /* 3FC2F112 DF3E5244 */
+
+invpio2 =  6.36619772367581382433e-01, /* 0x3FE45F30, 0x6DC9C883 */
+pio2_1  =  1.57079632673412561417e+00, /* 0x3FF921FB, 0x54400000 */
+pio2_1t =  6.07710050650619224932e-11, /* 0x3DD0B461, 0x1A626331 */
+pio2_2  =  6.07710050630396597660e-11, /* 0x3DD0B461, 0x1A600000 */
+pio2_2t =  2.02226624879595063154e-21, /* 0x3BA3198A, 0x2E037073 */
+pio2_3  =  2.02226624871116645580e-21, /* 0x3BA3198A, 0x2E000000 */
+pio2_3t =  8.47842766036889956997e-32, /* 0x397B839A, 0x252049C1 */
+
+S1      = -1.66666666666666324348e-01, /* 0xBFC55555, 0x55555549 */
+S2      =  8.33333333332248946124e-03, /* 0x3F811111, 0x1110F8A6 */
+S3      = -1.98412698298579493134e-04, /* 0xBF2A01A0, 0x19C161D5 */
+S4      =  2.75573137070700676789e-06, /* 0x3EC71DE3, 0x57B1FE7D */
+S5      = -2.50507602534068634195e-08, /* 0xBE5AE5E6, 0x8A2B9CEB */
+S6      =  1.58969099521155010221e-10, /* 0x3DE5D93A, 0x5ACFD57C */
+
+C1      =  4.16666666666666019037e-02, /* 0x3FA55555, 0x5555554C */
+C2      = -1.38888888888741095749e-03, /* 0xBF56C16C, 0x16C15177 */
+C3      =  2.48015872894767294178e-05, /* 0x3EFA01A0, 0x19CB1590 */
+C4      = -2.75573143513906633035e-07, /* 0xBE927E4F, 0x809C52AD */
+C5      =  2.08757232129817482790e-09, /* 0x3E21EE9E, 0xBDB4B1C4 */
+C6      = -1.13596475577881948265e-11; /* 0xBDA8FAE9, 0xBE8838D4 */
+
+VMATH_INLINE vdouble vsplat(double value) {
+  vdouble v = {};
+  return v + value;
+}
+
+VMATH_INLINE vdouble vfabs(vdouble x) {
+  return AS_DOUBLE(AS_INT(x) & INT64_MAX);
+}
+
+/* Returns a where mask is set, and b elsewhere. */
+VMATH_INLINE vdouble vselect(vint mask, vdouble a, vdouble b) {
+  return AS_DOUBLE((mask & AS_INT(a)) | (~mask & AS_INT(b)));
+}
+
+VMATH_INLINE int vany(vint mask) {
+  int64_t any = 0;
+  for (int i = 0; i < VMATH_WIDTH; i++) {
+    any |= mask[i];
+  }
+  return any != 0;
+}
+
+/* Rounds x, which must be smaller than 2^51, to an integer. */
+VMATH_INLINE vdouble vrint(vdouble x, vint* n) {
+  vdouble shifted = x + shift;
+  *n = AS_INT(shifted) - AS_INT(vsplat(shift));
+  return shifted - shift;
+}
+
+VMATH_INLINE vdouble vint_to_double(vint n) {
+  return AS_DOUBLE(n + AS_INT(vsplat(shift))) - shift;
+}
+
+/*
+ * Returns the top 26 significant bits of x. The products of two of these,
+ * or of one of these and the rest of a double, are exact.
+ */
+VMATH_INLINE vdouble vhigh_part(vdouble x) {
+  return AS_DOUBLE(AS_INT(x) & -(INT64_C(1) << 27));
+}
+
+/*
+ * Returns a * b, and sets *lo to the rounding error. Only the product of the
+ * low parts is rounded, so *lo is good to about 2^-104 of the product.
+ */
+VMATH_INLINE vdouble vtwo_prod(vdouble a, vdouble b, vdouble* lo) {
+  vdouble p = a * b;
+  vdouble a_hi = vhigh_part(a);
+  vdouble a_lo = a - a_hi;
+  vdouble b_hi = vhigh_part(b);
+  vdouble b_lo = b - b_hi;
+  *lo = (((a_hi * b_hi - p) + a_hi * b_lo) + a_lo * b_hi) + a_lo * b_lo;
+  return p;
+}
+
+/* Returns a + b, and sets *lo to the rounding error. */
+VMATH_INLINE vdouble vtwo_sum(vdouble a, vdouble b, vdouble* lo) {
+  vdouble s = a + b;
+  vdouble bb = s - a;
+  *lo = (a - (s - bb)) + (b - bb);
+  return s;
+}
+
+/* exp(x + xlo) for |x| <= 708. See e_exp.c. */
+VMATH_INLINE vdouble vexp_kernel(vdouble x, vdouble xlo) {
+  vint k;
+  vdouble dk = vrint(x * invln2, &k);
+  vdouble hi = x - dk * ln2HI; /* dk*ln2HI is exact here */
+  vdouble lo = dk * ln2LO - xlo;
+  vdouble r = hi - lo;
+  vdouble t = r * r;
+  vdouble c = r - t * (P1 + t * (P2 + t * (P3 + t * (P4 + t * P5))));
+  vdouble y = 1.0 - ((lo - (r * c) / (2.0 - c)) - hi);
+  /* k is in [-1021, 1021], so this can't overflow into a subnormal or infinity. */
+  return AS_DOUBLE(AS_INT(y) + (k << 52));
+}
+
+/*
+ * Splits x, a positive normal double, into 2^k * (1 + f) with 1 + f in
+ * [sqrt(2)/2, sqrt(2)). Sets *hx to the upper 20 bits of x's mantissa,
+ * which e_log.c uses to pick a formula.
+ */
+VMATH_INLINE vdouble vlog_reduce(vdouble x, vdouble* dk, vint* hx) {
+  vint ix = AS_INT(x);
+  vint high = ix >> 32;
+  vint k = (high >> 20) - 1023;
+  high &= 0x000fffff;
+  vint i = (high + 0x95f64) & 0x100000;
+  /* normalize x or x/2 */
+  x = AS_DOUBLE(((high | (i ^ 0x3ff00000)) << 32) | (ix & 0xffffffff));
+  k += i >> 20;
+  *dk = vint_to_double(k);
+  *hx = high;
+  return x - 1.0;
+}
+
+/* log(x) for positive normal x. See e_log.c. */
+VMATH_INLINE vdouble vlog_kernel(vdouble x) {
+  vdouble dk;
+  vint hx;
+  vdouble f = vlog_reduce(x, &dk, &hx);
+  vdouble s = f / (2.0 + f);
+  vdouble z = s * s;
+  vdouble w = z * z;
+  vdouble t1 = w * (Lg2 + w * (Lg4 + w * Lg6));
+  vdouble t2 = z * (Lg1 + w * (Lg3 + w * (Lg5 + w * Lg7)));
+  vdouble R = t2 + t1;
+  vdouble hfsq = 0.5 * f * f;
+  vint large_f = ((hx - 0x6147a) | (0x6b851 - hx)) > 0;
+  return vselect(large_f,
+                 dk * ln2HI - ((hfsq - (s * (hfsq + R) + dk * ln2LO)) - f),
+                 dk * ln2HI - ((s * (f - R) - dk * ln2LO) - f));
+}
+
+/*
+ * log(x) for positive normal x, as hi + *lo. This is more precise than
+ * vlog_kernel, because pow multiplies any error in the log by y.
+ */
+VMATH_INLINE vdouble vlog_kernel_extended(vdouble x, vdouble* lo) {
+  vdouble dk;
+  vint hx;
+  vdouble f = vlog_reduce(x, &dk, &hx);
+
+  /* s = f / (2 + f) as s + s_lo. 2 + f isn't exact, so it's d + d_lo. */
+  vdouble d = 2.0 + f;
+  vdouble d_lo = (2.0 - d) + f;
+  vdouble s = f / d;
+  vdouble p_lo;
+  vdouble p = vtwo_prod(s, d, &p_lo);
+  vdouble s_lo = (((f - p) - p_lo) - s * d_lo) / d;
+
+  /*
+   * log(1 + f) = 2 * atanh(s) = 2s + 2s^3/3 + 2s^5/5 + ... With |s| < 0.1716
+   * the terms after 2s^25/25 are below 2^-68. The s^3 term is still more
+   * than 2^-9 of the total, so it's done in double-double too. The higher
+   * terms only use s, so s_lo is scaled by the series' derivative,
+   * 2 / (1 - s^2) ~= 2 + 2s^2.
+   */
+  vdouble z_lo;
+  vdouble z = vtwo_prod(s, s, &z_lo);
+  vdouble s3_lo;
+  vdouble s3 = vtwo_prod(z, s, &s3_lo);
+  s3_lo += z_lo * s;
+  vdouble t3_lo;
+  vdouble t3 = vtwo_prod(s3, vsplat(two_thirds_hi), &t3_lo);
+  t3_lo += s3_lo * two_thirds_hi + s3 * two_thirds_lo;
+  vdouble R = z * (2.0/5 + z * (2.0/7 + z * (2.0/9 + z * (2.0/11 + z * (2.0/13 +
+              z * (2.0/15 + z * (2.0/17 + z * (2.0/19 + z * (2.0/21 + z * (2.0/23 +
+              z * (2.0/25)))))))))));
+
+  vdouble lo1, lo2;
+  vdouble hi = vtwo_sum(dk * ln2HI, 2.0 * s, &lo1);
+  hi = vtwo_sum(hi, t3, &lo2);
+  vdouble sum_lo = lo1 + lo2 + dk * ln2LO + 2.0 * s_lo * (1.0 + z) + t3_lo + s3 * R;
+  return vtwo_sum(hi, sum_lo, lo);
+}
+
+/* sin(x + y) for |x + y| <= pi/4, |y| much smaller than |x|. See k_sin.c. */
+VMATH_INLINE vdouble vsin_kernel(vdouble x, vdouble y) {
+  vdouble z = x * x;
+  vdouble w = z * z;
+  vdouble r = S2 + z * (S3 + z * S4) + z * w * (S5 + z * S6);
+  vdouble v = z * x;
+  return x - ((z * (0.5 * y - v * r) - y) - v * S1);
+}
+
+/* cos(x + y) for |x + y| <= pi/4, |y| much smaller than |x|. See k_cos.c. */
+VMATH_INLINE vdouble vcos_kernel(vdouble x, vdouble y) {
+  vdouble z = x * x;
+  vdouble w = z * z;
+  vdouble r = z * (C1 + z * (C2 + z * C3)) + w * w * (C4 + z * (C5 + z * C6));
+  vdouble hz = 0.5 * z;
+  w = 1.0 - hz;
+  return w + (((1.0 - w) - hz) + (z * r - x * y));
+}
+
+/*
+ * sin(x), or cos(x) if is_cos is set, for |x| <= 2^20. The reduction is the
+ * medium case of e_rem_pio2.c, which only does the second and third rounds
+ * when the first one loses too many bits; here they're always done.
+ */
+VMATH_INLINE vdouble vsin_cos_kernel(vdouble x, int is_cos) {
+  vint n;
+  vdouble fn = vrint(x * invpio2, &n);
+  vdouble r = x - fn * pio2_1;
+  vdouble t = r;
+  vdouble w = fn * pio2_2;
+  r = t - w;
+  w = fn * pio2_2t - ((t - r) - w);
+  t = r;
+  w = fn * pio2_3;
+  r = t - w;
+  w = fn * pio2_3t - ((t - r) - w);
+  vdouble y0 = r - w;
+  vdouble y1 = (r - y0) - w;
+
+  /* cos(x) = sin(x + pi/2). */
+  if (is_cos) {
+    n += 1;
+  }
+  vdouble result = vselect((n & 1) != 0, vcos_kernel(y0, y1), vsin_kernel(y0, y1));
+  return AS_DOUBLE(AS_INT(result) ^ ((n & 2) << 62));
+}
+
+enum vmath_function {
+  VMATH_EXP,
+  VMATH_LOG,
+  VMATH_SIN,
+  VMATH_COS,
+  VMATH_POW,
+};
+
+/*
+ * Evaluates the function for a vector of arguments, and sets *slow for the
+ * lanes that need the scalar function instead.
+ */
+VMATH_INLINE vdouble vmath_eval(enum vmath_function function, vdouble x, vdouble y, vint* slow) {
+  switch (function) {
+    case VMATH_EXP:
+      *slow = ~(vfabs(x) <= vsplat(708.0));
+      return vexp_kernel(x, vsplat(0.0));
+
+    case VMATH_LOG:
+      *slow = ~((x >= vsplat(DBL_MIN)) & (x <= vsplat(DBL_MAX)));
+      return vlog_kernel(x);
+
+    case VMATH_SIN:
+    case VMATH_COS:
+      *slow = ~(vfabs(x) <= vsplat(0x1p20));
+      return vsin_cos_kernel(x, function == VMATH_COS);
+
+    case VMATH_POW: {
+      vdouble log_lo;
+      vdouble log_hi = vlog_kernel_extended(x, &log_lo);
+      vdouble z_lo;
+      vdouble z = vtwo_prod(y, log_hi, &z_lo);
+      z_lo += y * log_lo;
+      z = vtwo_sum(z, z_lo, &z_lo);
+      *slow = ~((x >= vsplat(DBL_MIN)) & (x <= vsplat(DBL_MAX)) &
+                (vfabs(y) <= vsplat(0x1p900)) & (vfabs(z) <= vsplat(708.0)));
+      return vexp_kernel(z, z_lo);
+    }
+  }
+  return x;
+}
+
+static double vmath_scalar(enum vmath_function function, double x, double y) {
+  switch (function) {
+    case VMATH_EXP: return exp(x);
+    case VMATH_LOG: return log(x);
+    case VMATH_SIN: return sin(x);
+    case VMATH_COS: return cos(x);
+    case VMATH_POW: return pow(x, y);
+  }
+  return x;
+}
+
+/*
+ * Evaluates count <= VMATH_WIDTH lanes, recomputing the ones the vector
+ * code can't handle with the scalar function.
+ */
+VMATH_INLINE vdouble vmath_step(enum vmath_function function, vdouble x, vdouble y, size_t count) {
+  vint slow;
+  vdouble result = vmath_eval(function, x, y, &slow);
+  if (__predict_false(vany(slow))) {
+    for (size_t i = 0; i < count; i++) {
+      if (slow[i]) {
+        result[i] = vmath_scalar(function, x[i], y[i]);
+      }
+    }
+  }
+  return result;
+}
+
+/*
+ * Sets out[i] to the function of in[i] (and in2[i], for pow) for every
+ * i < n. out may be the same array as one of the inputs.
+ */
+VMATH_INLINE void vmath_batch(enum vmath_function function, double* out,
+                              const double* in, const double* in2, size_t n) {
+  vdouble x, y = vsplat(1.0);
+  for (; n >= VMATH_WIDTH; n -= VMATH_WIDTH) {
+    /* Fixed-size copies compile to unaligned vector loads and stores. */
+    memcpy(&x, in, sizeof(x));
+    if (function == VMATH_POW) {
+      memcpy(&y, in2, sizeof(y));
+      in2 += VMATH_WIDTH;
+    }
+    vdouble result = vmath_step(function, x, y, VMATH_WIDTH);
+    memcpy(out, &result, sizeof(result));
+    in += VMATH_WIDTH;
+    out += VMATH_WIDTH;
+  }
+
+  if (n > 0) {
+    /* Pad the last partial vector with ones, which every function handles quickly. */
+    x = y = vsplat(1.0);
+    for (size_t i = 0; i < n; i++) {
+      x[i] = in[i];
+      if (function == VMATH_POW) {
+        y[i] = in2[i];
+      }
+    }
+    vdouble result = vmath_step(function, x, y, n);
+    for (size_t i = 0; i < n; i++) {
+      out[i] = result[i];
+    }
+  }
+}
@@ -0,0 +1,55 @@
+/*-
+ * Copyright (C) 2016 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Four-lane AVX2 build of the batch math kernels. vmath.c only calls these
+ * after checking that the CPU supports AVX2 and FMA.
+ */
+
+#define VMATH_WIDTH 4
+#define VMATH_TARGET __attribute__((target("avx2,fma")))
+
+#include "../vmath_kernels.h"
+
+VMATH_TARGET void __vexp_avx2(double* out, const double* in, size_t n) {
+  vmath_batch(VMATH_EXP, out, in, NULL, n);
+}
+
+VMATH_TARGET void __vlog_avx2(double* out, const double* in, size_t n) {
+  vmath_batch(VMATH_LOG, out, in, NULL, n);
+}
+
+VMATH_TARGET void __vsin_avx2(double* out, const double* in, size_t n) {
+  vmath_batch(VMATH_SIN, out, in, NULL, n);
+}
+
+VMATH_TARGET void __vcos_avx2(double* out, const double* in, size_t n) {
+  vmath_batch(VMATH_COS, out, in, NULL, n);
+}
+
+VMATH_TARGET void __vpow_avx2(double* out, const double* x, const double* y, size_t n) {
+  vmath_batch(VMATH_POW, out, x, y, n);
+}
@@ -40,6 +40,11 @@ test_cflags = \
 
 test_cflags += -D__STDC_LIMIT_MACROS  # For glibc.
 
+# Test the per-thread malloc cache when libc is built with it.
+ifeq ($(strip $(MALLOC_THREAD_CACHE)),true)
+  test_cflags += -DUSE_MALLOC_THREAD_CACHE
+endif
+
 test_cppflags := \
 
 libBionicStandardTests_src_files := \
@@ -72,6 +77,7 @@ libBionicStandardTests_src_files := \
     pthread_test.cpp \
     pty_test.cpp \
     regex_test.cpp \
+    resolv_cache_test.cpp \
     sched_test.cpp \
     search_test.cpp \
     semaphore_test.cpp \
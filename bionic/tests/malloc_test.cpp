@@ -17,9 +17,11 @@
 #include <gtest/gtest.h>
 
 #include <limits.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <malloc.h>
+#include <string.h>
 #include <unistd.h>
 
 #include <tinyxml2.h>
@@ -500,3 +502,136 @@ TEST(malloc, verify_alignment) {
   delete[] values_64;
   delete[] values_ldouble;
 }
+
+TEST(malloc, calloc_reuses_dirty_small_blocks) {
+  // Freed small blocks may be handed straight back by a thread cache.
+  for (size_t size = 1; size <= 512; size++) {
+    void* dirty = malloc(size);
+    ASSERT_TRUE(dirty != nullptr);
+    memset(dirty, 0xa5, size);
+    free(dirty);
+    char* ptr = reinterpret_cast<char*>(calloc(1, size));
+    ASSERT_TRUE(ptr != nullptr);
+    ASSERT_LE(size, malloc_usable_size(ptr));
+    for (size_t i = 0; i < size; i++) {
+      ASSERT_EQ(0, ptr[i]);
+    }
+    free(ptr);
+  }
+}
+
+static void* FreeBlocks(void* arg) {
+  void** blocks = reinterpret_cast<void**>(arg);
+  for (size_t i = 0; blocks[i] != nullptr; i++) {
+    free(blocks[i]);
+  }
+  // Allocate some blocks this thread will still be caching when it exits.
+  for (size_t i = 0; blocks[i] != nullptr; i++) {
+    blocks[i] = malloc(1 + i % 300);
+  }
+  for (size_t i = 0; blocks[i] != nullptr; i++) {
+    free(blocks[i]);
+  }
+  return nullptr;
+}
+
+TEST(malloc, free_from_other_thread) {
+  static constexpr size_t kBlocks = 1000;
+  void* blocks[kBlocks + 1];
+  for (size_t i = 0; i < kBlocks; i++) {
+    blocks[i] = malloc(1 + i % 300);
+    ASSERT_TRUE(blocks[i] != nullptr);
+    memset(blocks[i], 0x5a, 1 + i % 300);
+  }
+  blocks[kBlocks] = nullptr;
+
+  pthread_t t;
+  ASSERT_EQ(0, pthread_create(&t, nullptr, FreeBlocks, blocks));
+  ASSERT_EQ(0, pthread_join(t, nullptr));
+
+  // The blocks are back with the allocator and can be reused from here.
+  for (size_t i = 0; i < kBlocks; i++) {
+    blocks[i] = malloc(1 + i % 300);
+    ASSERT_TRUE(blocks[i] != nullptr);
+  }
+  for (size_t i = 0; i < kBlocks; i++) {
+    free(blocks[i]);
+  }
+}
+
+#if defined(__BIONIC__) && defined(USE_MALLOC_THREAD_CACHE)
+// Blocks up to this size are cached, in size classes kCacheQuantum apart.
+static constexpr size_t kCacheMaxSize = 256;
+static constexpr size_t kCacheQuantum = 16;
+
+static void* FreeAndReallocate(void* arg) {
+  // A block freed by another thread than the one that allocated it goes to
+  // this thread's cache, and comes straight back.
+  void* block = arg;
+  size_t usable_size = malloc_usable_size(block);
+  free(block);
+  return malloc(usable_size);
+}
+
+static void* CacheBlocksAndExit(void*) {
+  for (size_t size = kCacheQuantum; size <= kCacheMaxSize; size += kCacheQuantum) {
+    void* blocks[4];
+    for (size_t i = 0; i < 4; i++) {
+      blocks[i] = malloc(size);
+    }
+    for (size_t i = 0; i < 4; i++) {
+      free(blocks[i]);
+    }
+  }
+  return nullptr;
+}
+#endif
+
+TEST(malloc, thread_cache_reuses_freed_block) {
+#if defined(__BIONIC__) && defined(USE_MALLOC_THREAD_CACHE)
+  for (size_t size = 1; size <= kCacheMaxSize; size++) {
+    void* block = malloc(size);
+    ASSERT_TRUE(block != nullptr);
+    size_t usable_size = malloc_usable_size(block);
+    free(block);
+    // The freed block is filed under the class of its usable size.
+    void* reused = malloc(usable_size);
+    ASSERT_EQ(block, reused) << size;
+    free(reused);
+  }
+#else
+  GTEST_LOG_(INFO) << "This test requires a libc built with MALLOC_THREAD_CACHE := true.\n";
+#endif
+}
+
+TEST(malloc, thread_cache_free_from_other_thread) {
+#if defined(__BIONIC__) && defined(USE_MALLOC_THREAD_CACHE)
+  for (size_t size = 1; size <= kCacheMaxSize; size += 7) {
+    void* block = malloc(size);
+    ASSERT_TRUE(block != nullptr);
+    pthread_t t;
+    ASSERT_EQ(0, pthread_create(&t, nullptr, FreeAndReallocate, block));
+    void* reused;
+    ASSERT_EQ(0, pthread_join(t, &reused));
+    ASSERT_EQ(block, reused) << size;
+    free(reused);
+  }
+#else
+  GTEST_LOG_(INFO) << "This test requires a libc built with MALLOC_THREAD_CACHE := true.\n";
+#endif
+}
+
+TEST(malloc, thread_cache_flushed_on_thread_exit) {
+#if defined(__BIONIC__) && defined(USE_MALLOC_THREAD_CACHE)
+  // The exiting thread caches 4 blocks of each class, 8704 bytes in all, which
+  // count as allocated until they are returned to the allocator.
+  size_t allocated_before = mallinfo().uordblks;
+  pthread_t t;
+  ASSERT_EQ(0, pthread_create(&t, nullptr, CacheBlocksAndExit, nullptr));
+  ASSERT_EQ(0, pthread_join(t, nullptr));
+  size_t allocated_after = mallinfo().uordblks;
+  ASSERT_LT(allocated_after, allocated_before + 4096);
+#else
+  GTEST_LOG_(INFO) << "This test requires a libc built with MALLOC_THREAD_CACHE := true.\n";
+#endif
+}
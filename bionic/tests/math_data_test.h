@@ -283,3 +283,40 @@ void DoMathDataTest(data_1_3_t<RT, T1, T2, T3> (&data)[N], RT f(T1, T2, T3)) {
   }
 }
 
+// Runs all of the input values in 'data' through the batch function 'f' in one
+// call, and asserts that each result is within ULP ulps of the expected value.
+// For testing a (double*, const double*, size_t) -> void function like vexp(3).
+template <size_t ULP, typename T, size_t N>
+void DoBatchMathDataTest(data_1_1_t<T, T> (&data)[N], void f(T*, const T*, size_t)) {
+  fesetenv(FE_DFL_ENV);
+  FpUlpEq<ULP, T> predicate;
+  T in[N];
+  T out[N];
+  for (size_t i = 0; i < N; ++i) {
+    in[i] = data[i].input;
+  }
+  f(out, in, N);
+  for (size_t i = 0; i < N; ++i) {
+    EXPECT_PRED_FORMAT2(predicate, data[i].expected, out[i]) << "Failed on element " << i;
+  }
+}
+
+// Runs all of the pairs of input values in 'data' through the batch function 'f'
+// in one call, and asserts that each result is within ULP ulps of the expected value.
+// For testing a (double*, const double*, const double*, size_t) -> void function like vpow(3).
+template <size_t ULP, typename T, size_t N>
+void DoBatchMathDataTest(data_1_2_t<T, T, T> (&data)[N], void f(T*, const T*, const T*, size_t)) {
+  fesetenv(FE_DFL_ENV);
+  FpUlpEq<ULP, T> predicate;
+  T in1[N];
+  T in2[N];
+  T out[N];
+  for (size_t i = 0; i < N; ++i) {
+    in1[i] = data[i].input1;
+    in2[i] = data[i].input2;
+  }
+  f(out, in1, in2, N);
+  for (size_t i = 0; i < N; ++i) {
+    EXPECT_PRED_FORMAT2(predicate, data[i].expected, out[i]) << "Failed on element " << i;
+  }
+}
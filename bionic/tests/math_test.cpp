@@ -56,9 +56,17 @@ template<typename T> inline int test_capture_isinf(const T in) {
 #include <float.h>
 #include <limits.h>
 #include <stdint.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <vector>
 
 #include <private/ScopeGuard.h>
 
+#if defined(__BIONIC__)
+#include <android/vmath.h>
+#endif
+
 float float_subnormal() {
   union {
     float f;
@@ -1379,6 +1387,109 @@ TEST(math, nextafterl_OpenBSD_bug) {
   ASSERT_TRUE(nextafterl(1.0L, 0.0L) - 1.0L < 0.0L);
 }
 
+#if defined(__BIONIC__)
+// Inputs that the batch functions hand to the scalar ones, and some that they don't.
+static std::vector<double> BatchTestInputs(double lo, double hi) {
+  std::vector<double> in = { 0.0, -0.0, 1.0, -1.0, HUGE_VAL, -HUGE_VAL, nan(""), DBL_MIN,
+                             DBL_MAX, double_subnormal(), 709.0, -746.0, 0x1p20, 0x1p21 };
+  srand48(1234);
+  while (in.size() < 512) {
+    in.push_back(lo + (hi - lo) * drand48());
+  }
+  return in;
+}
+
+static void ExpectMatchesScalar(double expected, double actual, double x, double y) {
+  FpUlpEq<1, double> predicate;
+  if (isnan(expected)) {
+    EXPECT_TRUE(isnan(actual)) << "Failed on " << x << ", " << y;
+  } else {
+    EXPECT_PRED_FORMAT2(predicate, expected, actual) << "Failed on " << x << ", " << y;
+  }
+}
+
+// The batch function must agree with the scalar one for every length and
+// starting offset, so that partial vectors are covered too, and in place.
+static void ExpectBatchMatchesScalar(void batch(double*, const double*, const double*, size_t),
+                                     double scalar(double, double),
+                                     const std::vector<double>& x, const std::vector<double>& y) {
+  std::vector<double> out(x.size());
+  for (size_t start = 0; start < 4; ++start) {
+    for (size_t n = 0; start + n <= x.size(); n += 13) {
+      batch(&out[start], &x[start], &y[start], n);
+      for (size_t i = start; i < start + n; ++i) {
+        ExpectMatchesScalar(scalar(x[i], y[i]), out[i], x[i], y[i]);
+      }
+    }
+  }
+
+  out = x;
+  batch(&out[0], &out[0], &y[0], out.size());
+  for (size_t i = 0; i < x.size(); ++i) {
+    ExpectMatchesScalar(scalar(x[i], y[i]), out[i], x[i], y[i]);
+  }
+}
+
+// Adapters so that the one-argument functions can share the checks above.
+#define BATCH_ADAPTERS(name) \
+  static void v##name##_2(double* out, const double* x, const double*, size_t n) { \
+    v##name(out, x, n); \
+  } \
+  static double name##_2(double x, double) { return name(x); }
+BATCH_ADAPTERS(exp)
+BATCH_ADAPTERS(log)
+BATCH_ADAPTERS(sin)
+BATCH_ADAPTERS(cos)
+#undef BATCH_ADAPTERS
+#endif // __BIONIC__
+
+TEST(math, vexp) {
+#if defined(__BIONIC__)
+  std::vector<double> x = BatchTestInputs(-745.0, 710.0);
+  ExpectBatchMatchesScalar(vexp_2, exp_2, x, x);
+#else // __BIONIC__
+  GTEST_LOG_(INFO) << "glibc doesn't have vexp.\n";
+#endif // __BIONIC__
+}
+
+TEST(math, vlog) {
+#if defined(__BIONIC__)
+  std::vector<double> x = BatchTestInputs(-1.0, 1e6);
+  ExpectBatchMatchesScalar(vlog_2, log_2, x, x);
+#else // __BIONIC__
+  GTEST_LOG_(INFO) << "glibc doesn't have vlog.\n";
+#endif // __BIONIC__
+}
+
+TEST(math, vsin) {
+#if defined(__BIONIC__)
+  std::vector<double> x = BatchTestInputs(-1e3, 1e3);
+  ExpectBatchMatchesScalar(vsin_2, sin_2, x, x);
+#else // __BIONIC__
+  GTEST_LOG_(INFO) << "glibc doesn't have vsin.\n";
+#endif // __BIONIC__
+}
+
+TEST(math, vcos) {
+#if defined(__BIONIC__)
+  std::vector<double> x = BatchTestInputs(-1e3, 1e3);
+  ExpectBatchMatchesScalar(vcos_2, cos_2, x, x);
+#else // __BIONIC__
+  GTEST_LOG_(INFO) << "glibc doesn't have vcos.\n";
+#endif // __BIONIC__
+}
+
+TEST(math, vpow) {
+#if defined(__BIONIC__)
+  std::vector<double> x = BatchTestInputs(-1.0, 100.0);
+  std::vector<double> y = BatchTestInputs(-150.0, 150.0);
+  std::reverse(y.begin(), y.end());
+  ExpectBatchMatchesScalar(vpow, pow, x, y);
+#else // __BIONIC__
+  GTEST_LOG_(INFO) << "glibc doesn't have vpow.\n";
+#endif // __BIONIC__
+}
+
 #include "math_data/acos_intel_data.h"
 TEST(math, acos_intel) {
   DoMathDataTest<1>(g_acos_intel_data, acos);
@@ -1484,6 +1595,14 @@ TEST(math, cos_intel) {
   DoMathDataTest<1>(g_cos_intel_data, cos);
 }
 
+TEST(math, vcos_intel) {
+#if defined(__BIONIC__)
+  DoBatchMathDataTest<1>(g_cos_intel_data, vcos);
+#else // __BIONIC__
+  GTEST_LOG_(INFO) << "glibc doesn't have vcos.\n";
+#endif // __BIONIC__
+}
+
 #include "math_data/cosf_intel_data.h"
 TEST(math, cosf_intel) {
   DoMathDataTest<1>(g_cosf_intel_data, cosf);
@@ -1504,6 +1623,14 @@ TEST(math, exp_intel) {
   DoMathDataTest<1>(g_exp_intel_data, exp);
 }
 
+TEST(math, vexp_intel) {
+#if defined(__BIONIC__)
+  DoBatchMathDataTest<1>(g_exp_intel_data, vexp);
+#else // __BIONIC__
+  GTEST_LOG_(INFO) << "glibc doesn't have vexp.\n";
+#endif // __BIONIC__
+}
+
 #include "math_data/expf_intel_data.h"
 TEST(math, expf_intel) {
   DoMathDataTest<1>(g_expf_intel_data, expf);
@@ -1654,6 +1781,14 @@ TEST(math, log_intel) {
   DoMathDataTest<1>(g_log_intel_data, log);
 }
 
+TEST(math, vlog_intel) {
+#if defined(__BIONIC__)
+  DoBatchMathDataTest<1>(g_log_intel_data, vlog);
+#else // __BIONIC__
+  GTEST_LOG_(INFO) << "glibc doesn't have vlog.\n";
+#endif // __BIONIC__
+}
+
 #include "math_data/logf_intel_data.h"
 TEST(math, logf_intel) {
   DoMathDataTest<1>(g_logf_intel_data, logf);
@@ -1744,6 +1879,14 @@ TEST(math, pow_intel) {
   DoMathDataTest<1>(g_pow_intel_data, pow);
 }
 
+TEST(math, vpow_intel) {
+#if defined(__BIONIC__)
+  DoBatchMathDataTest<1>(g_pow_intel_data, vpow);
+#else // __BIONIC__
+  GTEST_LOG_(INFO) << "glibc doesn't have vpow.\n";
+#endif // __BIONIC__
+}
+
 #include "math_data/powf_intel_data.h"
 TEST(math, powf_intel) {
   DoMathDataTest<1>(g_powf_intel_data, powf);
@@ -1824,6 +1967,14 @@ TEST(math, sin_intel) {
   DoMathDataTest<1>(g_sin_intel_data, sin);
 }
 
+TEST(math, vsin_intel) {
+#if defined(__BIONIC__)
+  DoBatchMathDataTest<1>(g_sin_intel_data, vsin);
+#else // __BIONIC__
+  GTEST_LOG_(INFO) << "glibc doesn't have vsin.\n";
+#endif // __BIONIC__
+}
+
 #include "math_data/sinf_intel_data.h"
 TEST(math, sinf_intel) {
   DoMathDataTest<1>(g_sinf_intel_data, sinf);
@@ -0,0 +1,288 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <vector>
+
+#if defined(__BIONIC__)
+
+// The per-network resolver API that netd uses.
+extern "C" int _resolv_set_nameservers_for_net(unsigned netid, const char** servers,
+                                               unsigned numservers, const char* domains,
+                                               const void* params);
+extern "C" void _resolv_delete_cache_for_net(unsigned netid);
+extern "C" void _resolv_cache_set_clock_for_test(time_t (*clock)(void));
+extern "C" int android_getaddrinfofornet(const char* hostname, const char* servname,
+                                         const struct addrinfo* hints, unsigned netid,
+                                         unsigned mark, struct addrinfo** result);
+
+// A network that nothing else on the device should be using.
+static const unsigned kTestNetId = 4242;
+
+// A stub DNS server on 127.0.0.1:53 that answers every A query with
+// 192.0.2.1 and a fixed TTL, and counts the queries it gets.
+class StubDnsServer {
+ public:
+  StubDnsServer(uint32_t ttl) : ttl_(ttl), fd_(-1), stop_(false), queries_(0) {
+  }
+
+  ~StubDnsServer() {
+    if (fd_ != -1) {
+      stop_ = true;
+      pthread_join(thread_, nullptr);
+      close(fd_);
+    }
+  }
+
+  // Binding to port 53 needs root.
+  bool Start() {
+    fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd_ == -1) return false;
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(53);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) {
+      close(fd_);
+      fd_ = -1;
+      return false;
+    }
+    if (pthread_create(&thread_, nullptr, ServeThread, this) != 0) {
+      close(fd_);
+      fd_ = -1;
+      return false;
+    }
+    return true;
+  }
+
+  size_t queries() { return queries_; }
+
+ private:
+  static void* ServeThread(void* arg) {
+    reinterpret_cast<StubDnsServer*>(arg)->Serve();
+    return nullptr;
+  }
+
+  void Serve() {
+    while (!stop_) {
+      pollfd pfd = { fd_, POLLIN, 0 };
+      if (poll(&pfd, 1, 100) <= 0) continue;
+
+      uint8_t packet[512];
+      sockaddr_storage from;
+      socklen_t from_len = sizeof(from);
+      ssize_t n = recvfrom(fd_, packet, sizeof(packet) - 16, 0,
+                           reinterpret_cast<sockaddr*>(&from), &from_len);
+      if (n < 12) continue;
+      ++queries_;
+
+      // Turn the query into a response and append one answer record that
+      // points back at the question's name.
+      packet[2] |= 0x80;  // QR
+      packet[3] = 0x80;   // RA, NOERROR
+      packet[7] = 1;      // ANCOUNT
+      const uint8_t answer[] = {
+        0xc0, 12, 0, 1, 0, 1,
+        static_cast<uint8_t>(ttl_ >> 24), static_cast<uint8_t>(ttl_ >> 16),
+        static_cast<uint8_t>(ttl_ >> 8), static_cast<uint8_t>(ttl_),
+        0, 4, 192, 0, 2, 1,
+      };
+      memcpy(packet + n, answer, sizeof(answer));
+      sendto(fd_, packet, n + sizeof(answer), 0, reinterpret_cast<sockaddr*>(&from), from_len);
+    }
+  }
+
+  const uint32_t ttl_;
+  int fd_;
+  pthread_t thread_;
+  std::atomic<bool> stop_;
+  std::atomic<size_t> queries_;
+};
+
+static bool Resolve(const char* name) {
+  addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_DGRAM;
+  addrinfo* result = nullptr;
+  if (android_getaddrinfofornet(name, nullptr, &hints, kTestNetId, 0, &result) != 0) {
+    return false;
+  }
+  freeaddrinfo(result);
+  return true;
+}
+
+class resolv_cache : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    // The cache is only used in netd's mode, and it is sized when a network is set up.
+    setenv("ANDROID_DNS_MODE", "local", 1);
+    const char* servers[] = { "127.0.0.1" };
+    network_ready_ = (_resolv_set_nameservers_for_net(kTestNetId, servers, 1, "", nullptr) == 0);
+  }
+
+  virtual void TearDown() {
+    _resolv_cache_set_clock_for_test(nullptr);
+    if (network_ready_) {
+      _resolv_delete_cache_for_net(kTestNetId);
+    }
+    unsetenv("ANDROID_DNS_MODE");
+  }
+
+  // Returns false, after logging that the test is skipped, if the test
+  // network or the stub server can't be set up. Both need root.
+  bool StartServerOrSkip(StubDnsServer* server) {
+    if (!network_ready_) {
+      GTEST_LOG_(INFO) << "Skipping test, could not set up the test network.\n";
+      return false;
+    }
+    if (!server->Start()) {
+      GTEST_LOG_(INFO) << "Skipping test, binding port 53 needs root.\n";
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  bool network_ready_;
+};
+
+static double NowUs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+struct LookupThreadArgs {
+  size_t lookups;
+  double total_us;
+  bool ok;
+};
+
+static const char* kNames[] = {
+  "a.cache.test", "b.cache.test", "c.cache.test", "d.cache.test",
+};
+static const size_t kNameCount = sizeof(kNames) / sizeof(kNames[0]);
+
+static void* LookupThread(void* arg) {
+  LookupThreadArgs* args = reinterpret_cast<LookupThreadArgs*>(arg);
+  double start = NowUs();
+  for (size_t i = 0; i < args->lookups; ++i) {
+    if (!Resolve(kNames[i % kNameCount])) {
+      args->ok = false;
+      break;
+    }
+  }
+  args->total_us = NowUs() - start;
+  return nullptr;
+}
+
+TEST_F(resolv_cache, concurrent_lookups) {
+  StubDnsServer server(300);
+  if (!StartServerOrSkip(&server)) {
+    return;
+  }
+
+  const size_t kThreads = 8;
+  const size_t kLookupsPerThread = 500;
+  std::vector<pthread_t> threads(kThreads);
+  std::vector<LookupThreadArgs> args(kThreads, LookupThreadArgs{ kLookupsPerThread, 0, true });
+  for (size_t i = 0; i < kThreads; ++i) {
+    ASSERT_EQ(0, pthread_create(&threads[i], nullptr, LookupThread, &args[i]));
+  }
+  double total_us = 0;
+  for (size_t i = 0; i < kThreads; ++i) {
+    ASSERT_EQ(0, pthread_join(threads[i], nullptr));
+    ASSERT_TRUE(args[i].ok);
+    total_us += args[i].total_us;
+  }
+
+  size_t lookups = kThreads * kLookupsPerThread;
+  size_t queries = server.queries();
+  GTEST_LOG_(INFO) << lookups << " lookups, " << queries << " queries sent, hit rate "
+                   << 100.0 * (lookups - queries) / lookups << "%, "
+                   << total_us / lookups << " us per lookup\n";
+  // Concurrent misses for the same name wait for the first one's answer.
+  ASSERT_LE(queries, 2 * kNameCount);
+}
+
+// The clock the cache sees in refreshes_popular_entries_before_expiry.
+static std::atomic<time_t> g_fake_now;
+
+static time_t FakeNow() {
+  return g_fake_now;
+}
+
+TEST_F(resolv_cache, refreshes_popular_entries_before_expiry) {
+  // Entries are refreshed from 90s and expire at 100s.
+  StubDnsServer server(100);
+  if (!StartServerOrSkip(&server)) {
+    return;
+  }
+  const time_t t0 = 1000000;
+  g_fake_now = t0;
+  _resolv_cache_set_clock_for_test(FakeNow);
+
+  // Add the entry, and make it popular.
+  ASSERT_TRUE(Resolve("popular.cache.test"));
+  ASSERT_TRUE(Resolve("popular.cache.test"));
+  ASSERT_TRUE(Resolve("popular.cache.test"));
+  ASSERT_EQ(1U, server.queries());
+
+  // Nothing happens before the last tenth of the TTL...
+  g_fake_now = t0 + 89;
+  ASSERT_TRUE(Resolve("popular.cache.test"));
+  ASSERT_EQ(1U, server.queries());
+
+  // ...then one lookup refreshes the entry...
+  g_fake_now = t0 + 90;
+  ASSERT_TRUE(Resolve("popular.cache.test"));
+  ASSERT_EQ(2U, server.queries());
+  ASSERT_TRUE(Resolve("popular.cache.test"));
+  ASSERT_EQ(2U, server.queries());
+
+  // ...so it's still there once the original answer has expired.
+  g_fake_now = t0 + 100;
+  ASSERT_TRUE(Resolve("popular.cache.test"));
+  ASSERT_EQ(2U, server.queries());
+
+  // An entry found only once isn't refreshed, and expires with its TTL.
+  ASSERT_TRUE(Resolve("unpopular.cache.test"));
+  ASSERT_EQ(3U, server.queries());
+  g_fake_now = t0 + 195;
+  ASSERT_TRUE(Resolve("unpopular.cache.test"));
+  ASSERT_EQ(3U, server.queries());
+  g_fake_now = t0 + 200;
+  ASSERT_TRUE(Resolve("unpopular.cache.test"));
+  ASSERT_EQ(4U, server.queries());
+}
+
+#endif  // __BIONIC__
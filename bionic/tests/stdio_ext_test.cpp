@@ -29,6 +29,11 @@
 #include <wchar.h>
 #include <locale.h>
 
+#include <algorithm>
+#include <string>
+
+#include <android-base/file.h>
+
 #include "TemporaryFile.h"
 #include "utils.h"
 
@@ -52,6 +57,41 @@ TEST(stdio_ext, __fbufsize) {
   fclose(fp);
 }
 
+TEST(stdio_ext, __fbufsize_grows_for_sequential_reads) {
+#if defined(__BIONIC__)
+  TemporaryFile tf;
+  const size_t kFileSize = 1024 * 1024;
+  std::string contents;
+  for (size_t i = 0; i < kFileSize; ++i) {
+    contents += "0123456789abcdef"[i % 16];
+  }
+  ASSERT_TRUE(android::base::WriteStringToFd(contents, tf.fd));
+
+  // Reading the file straight through grows the buffer, up to a limit.
+  FILE* fp = fopen(tf.filename, "r");
+  ASSERT_EQ('0', fgetc(fp));
+  size_t initial_size = __fbufsize(fp);
+  size_t max_size = initial_size;
+  for (size_t i = 1; i < kFileSize; ++i) {
+    ASSERT_EQ("0123456789abcdef"[i % 16], fgetc(fp)) << i;
+    max_size = std::max(max_size, __fbufsize(fp));
+  }
+  ASSERT_EQ(EOF, fgetc(fp));
+  ASSERT_GT(max_size, initial_size);
+  ASSERT_LE(max_size, 64U * 1024U);
+
+  // A buffer size chosen with setvbuf is left alone.
+  rewind(fp);
+  ASSERT_EQ(0, setvbuf(fp, nullptr, _IOFBF, 512));
+  while (fgetc(fp) != EOF) {
+  }
+  ASSERT_EQ(512U, __fbufsize(fp));
+  fclose(fp);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
 TEST(stdio_ext, __flbf) {
   FILE* fp = fopen("/proc/version", "r");
 
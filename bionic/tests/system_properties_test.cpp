@@ -18,9 +18,16 @@
 #include "BionicDeathTest.h"
 
 #include <errno.h>
+#include <stdlib.h>
+#include <sys/mman.h>
 #include <sys/wait.h>
 #include <unistd.h>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include "private/bionic_property_contexts.h"
+#include "TemporaryFile.h"
 
 #if defined(__BIONIC__)
 
@@ -136,6 +143,30 @@ TEST(properties, add) {
 #endif // __BIONIC__
 }
 
+TEST(properties, find_after_add) {
+#if defined(__BIONIC__)
+    LocalPropertyTestState pa;
+    ASSERT_TRUE(pa.valid);
+
+    char propvalue[PROP_VALUE_MAX];
+
+    // Look the property up (twice, so that the miss is cached) before it exists.
+    ASSERT_EQ((const prop_info *)NULL, __system_property_find("property"));
+    ASSERT_EQ((const prop_info *)NULL, __system_property_find("property"));
+
+    ASSERT_EQ(0, __system_property_add("property", 8, "value1", 6));
+    const prop_info *pi = __system_property_find("property");
+    ASSERT_NE((const prop_info *)NULL, pi);
+    ASSERT_EQ(pi, __system_property_find("property"));
+
+    ASSERT_EQ(0, __system_property_update((prop_info *)pi, "value2", 6));
+    ASSERT_EQ(6, __system_property_get("property", propvalue));
+    ASSERT_STREQ(propvalue, "value2");
+#else // __BIONIC__
+    GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif // __BIONIC__
+}
+
 TEST(properties, update) {
 #if defined(__BIONIC__)
     LocalPropertyTestState pa;
@@ -411,3 +442,197 @@ TEST_F(properties_DeathTest, read_only) {
   GTEST_LOG_(INFO) << "This test does nothing.\n";
 #endif // __BIONIC__
 }
+
+// Builds a contexts table from (prefix, context) lines, in property_contexts order.
+static contexts_table* build_table(const std::vector<std::pair<const char*, const char*>>& lines) {
+    std::vector<context_spec> specs;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        specs.push_back({ const_cast<char*>(lines[i].first), const_cast<char*>(lines[i].second), i });
+    }
+    return build_contexts_table(specs.data(), specs.size());
+}
+
+static std::string context_for(const contexts_table* table, const char* name) {
+    uint32_t context = find_context(table, name);
+    if (context == CONTEXTS_TABLE_NONE) {
+        return "";
+    }
+    return table_string(table, table_context_names(table)[context]);
+}
+
+TEST(properties, contexts_table_longest_prefix) {
+    contexts_table* table = build_table({
+        { "ro.", "ro" },
+        { "ro.build.", "build" },
+        { "ro.build.version.", "version" },
+        { "ro.b", "b" },
+        { "sys.", "sys" },
+    });
+    ASSERT_TRUE(table != nullptr);
+    ASSERT_TRUE(check_contexts_table(table, table->size));
+
+    ASSERT_EQ("version", context_for(table, "ro.build.version.sdk"));
+    ASSERT_EQ("build", context_for(table, "ro.build.id"));
+    // Sorts after "ro.build.version.", which doesn't match but whose parent does.
+    ASSERT_EQ("build", context_for(table, "ro.build.zzz"));
+    ASSERT_EQ("b", context_for(table, "ro.build"));
+    ASSERT_EQ("b", context_for(table, "ro.boot.serialno"));
+    ASSERT_EQ("ro", context_for(table, "ro.a"));
+    ASSERT_EQ("ro", context_for(table, "ro.z"));
+    ASSERT_EQ("sys", context_for(table, "sys.usb.config"));
+    // No prefix matches and there's no '*' line.
+    ASSERT_EQ("", context_for(table, "net.dns1"));
+    ASSERT_EQ("", context_for(table, "a"));
+    ASSERT_EQ("", context_for(table, "ro"));
+    free(table);
+}
+
+TEST(properties, contexts_table_duplicate_prefix) {
+    contexts_table* table = build_table({
+        { "ro.", "first" },
+        { "sys.", "sys" },
+        { "ro.", "second" },
+    });
+    ASSERT_TRUE(table != nullptr);
+    ASSERT_TRUE(check_contexts_table(table, table->size));
+
+    ASSERT_EQ(2U, table->num_prefixes);
+    // The context of the losing line still gets a property area.
+    ASSERT_EQ(3U, table->num_contexts);
+    ASSERT_EQ("first", context_for(table, "ro.build.id"));
+    ASSERT_EQ("sys", context_for(table, "sys.usb.config"));
+    free(table);
+}
+
+TEST(properties, contexts_table_default) {
+    contexts_table* table = build_table({
+        { "*", "first" },
+        { "ro.", "ro" },
+        { "*", "second" },
+        { "*", "last" },
+    });
+    ASSERT_TRUE(table != nullptr);
+    ASSERT_TRUE(check_contexts_table(table, table->size));
+
+    ASSERT_EQ(1U, table->num_prefixes);
+    ASSERT_EQ("last", context_for(table, "net.dns1"));
+    ASSERT_EQ("last", context_for(table, ""));
+    ASSERT_EQ("ro", context_for(table, "ro.build.id"));
+    free(table);
+}
+
+TEST(properties, contexts_table_check) {
+    contexts_table* table = build_table({
+        { "ro.", "ro" },
+        { "ro.build.", "build" },
+        { "*", "default" },
+    });
+    ASSERT_TRUE(table != nullptr);
+    const size_t size = table->size;
+    ASSERT_TRUE(check_contexts_table(table, size));
+
+    std::vector<char> buffer;
+    auto copy = [&]() {
+        buffer.assign(reinterpret_cast<char*>(table), reinterpret_cast<char*>(table) + size);
+        return reinterpret_cast<contexts_table*>(buffer.data());
+    };
+
+    // Truncated, whether or not the size in the header agrees.
+    ASSERT_FALSE(check_contexts_table(copy(), size - 1));
+    ASSERT_FALSE(check_contexts_table(copy(), sizeof(contexts_table)));
+    contexts_table* bad = copy();
+    bad->size = size - 1;
+    ASSERT_FALSE(check_contexts_table(bad, size - 1));
+
+    bad = copy();
+    bad->magic ^= 1;
+    ASSERT_FALSE(check_contexts_table(bad, size));
+    bad = copy();
+    bad->version = CONTEXTS_TABLE_VERSION + 1;
+    ASSERT_FALSE(check_contexts_table(bad, size));
+    bad = copy();
+    bad->num_prefixes = 1000;
+    ASSERT_FALSE(check_contexts_table(bad, size));
+    bad = copy();
+    bad->default_context = bad->num_contexts;
+    ASSERT_FALSE(check_contexts_table(bad, size));
+
+    // Context names out of range.
+    bad = copy();
+    const_cast<uint32_t*>(table_context_names(bad))[0] = size;
+    ASSERT_FALSE(check_contexts_table(bad, size));
+    bad = copy();
+    const_cast<uint32_t*>(table_context_names(bad))[0] = 0;
+    ASSERT_FALSE(check_contexts_table(bad, size));
+
+    // Prefix entries out of range.
+    bad = copy();
+    const_cast<prefix_entry*>(table_prefixes(bad))[1].prefix = size;
+    ASSERT_FALSE(check_contexts_table(bad, size));
+    bad = copy();
+    const_cast<prefix_entry*>(table_prefixes(bad))[1].prefix_len += 1;
+    ASSERT_FALSE(check_contexts_table(bad, size));
+    bad = copy();
+    const_cast<prefix_entry*>(table_prefixes(bad))[1].context = bad->num_contexts;
+    ASSERT_FALSE(check_contexts_table(bad, size));
+    // A parent must come before its child, or a lookup could loop.
+    bad = copy();
+    const_cast<prefix_entry*>(table_prefixes(bad))[1].parent = 1;
+    ASSERT_FALSE(check_contexts_table(bad, size));
+
+    // The last string must be terminated.
+    bad = copy();
+    reinterpret_cast<char*>(bad)[size - 1] = 'x';
+    ASSERT_FALSE(check_contexts_table(bad, size));
+
+    ASSERT_TRUE(check_contexts_table(copy(), size));
+    free(table);
+}
+
+TEST(properties, contexts_table_file) {
+    contexts_table* table = build_table({
+        { "ro.", "ro" },
+        { "ro.build.", "build" },
+        { "sys.", "sys" },
+        { "*", "default" },
+    });
+    ASSERT_TRUE(table != nullptr);
+
+    TemporaryDir dir;
+    std::string filename = std::string(dir.dirname) + "/property_contexts";
+    std::string tmp_filename = filename + ".tmp";
+    bool fsetxattr_failed = false;
+    ASSERT_TRUE(write_contexts_table_file(table, filename.c_str(), tmp_filename.c_str(), nullptr,
+                                          &fsetxattr_failed));
+    ASSERT_FALSE(fsetxattr_failed);
+    ASSERT_EQ(-1, access(tmp_filename.c_str(), F_OK));
+
+    contexts_table* mapped = map_contexts_table_file(filename.c_str(), getuid(), getgid());
+    ASSERT_TRUE(mapped != nullptr);
+    ASSERT_EQ(table->size, mapped->size);
+    ASSERT_EQ(0, memcmp(table, mapped, table->size));
+    for (const char* name : { "ro.build.id", "ro.boot.serialno", "sys.usb.config", "net.dns1" }) {
+        ASSERT_EQ(context_for(table, name), context_for(mapped, name));
+    }
+    ASSERT_EQ("build", context_for(mapped, "ro.build.id"));
+    ASSERT_EQ("default", context_for(mapped, "net.dns1"));
+    munmap(mapped, mapped->size);
+
+    // Only a file from the expected owner is trusted.
+    ASSERT_TRUE(map_contexts_table_file(filename.c_str(), getuid() + 1, getgid()) == nullptr);
+
+    // Nor is a truncated one.
+    ASSERT_EQ(0, chmod(filename.c_str(), 0644));
+    ASSERT_EQ(0, truncate(filename.c_str(), table->size - 1));
+    ASSERT_TRUE(map_contexts_table_file(filename.c_str(), getuid(), getgid()) == nullptr);
+
+    // The table can't be written over an existing temporary file.
+    ASSERT_EQ(0, unlink(filename.c_str()));
+    int fd = open(tmp_filename.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    ASSERT_NE(-1, fd);
+    close(fd);
+    ASSERT_FALSE(write_contexts_table_file(table, filename.c_str(), tmp_filename.c_str(), nullptr,
+                                           &fsetxattr_failed));
+    ASSERT_EQ(0, unlink(tmp_filename.c_str()));
+    free(table);
+}
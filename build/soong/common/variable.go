@@ -46,6 +46,11 @@ type variableProperties struct {
 		Malloc_not_svelte struct {
 			Cflags []string
 		}
+
+		Malloc_thread_cache struct {
+			Cflags []string
+			Srcs   []string
+		}
 	} `android:"arch_variant"`
 }
 
@@ -77,6 +82,7 @@ type productVariables struct {
 	Unbundled_build            *bool `json:",omitempty"`
 	Brillo                     *bool `json:",omitempty"`
 	Malloc_not_svelte          *bool `json:",omitempty"`
+	Malloc_thread_cache        *bool `json:",omitempty"`
 }
 
 func boolPtr(v bool) *bool {
@@ -106,6 +112,7 @@ func (v *productVariables) SetDefaultConfig() {
 		DeviceSecondaryCpuVariant:  stringPtr("denver"),
 		DeviceSecondaryAbi:         &[]string{"armeabi-v7a"},
 		Malloc_not_svelte:          boolPtr(false),
+		Malloc_thread_cache:        boolPtr(false),
 	}
 
 	if runtime.GOOS == "linux" {